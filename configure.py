@@ -24,12 +24,14 @@ writer = generator.writer
 toolchain = generator.toolchain
 
 render_lib = generator.lib(module='render', sources=[
-    'backend.c', 'buffer.c', 'compile.c', 'event.c', 'import.c', 'pipeline.c', 'projection.c', 'render.c',
-    'shader.c', 'target.c', 'version.c',
+    'backend.c', 'buffer.c', 'command.c', 'compile.c', 'event.c', 'import.c', 'indirect.c', 'layout.c',
+    'pipeline.c', 'pool.c', 'projection.c', 'render.c', 'residency.c', 'ring.c', 'shader.c', 'slab.c', 'table.c',
+    'target.c', 'trace.c', 'upload.c', 'version.c',
     os.path.join('directx12', 'backend.c'),
     os.path.join('metal', 'backend.m'), os.path.join('metal', 'backend.c'),
     os.path.join('vulkan', 'backend.c'),
-    os.path.join('null', 'backend.c')
+    os.path.join('null', 'backend.c'),
+    os.path.join('software', 'backend.c')
 ])
 
 extralibs = []
@@ -56,6 +58,8 @@ if not target.is_ios() and not target.is_android() and not target.is_tizen():
                       render_lib], dependlibs=dependlibs, libs=linklibs, frameworks=gfxframeworks, configs=configs)
         generator.bin('rendercompile', ['main.c'], 'rendercompile', basepath='tools', implicit_deps=[
                       render_lib], dependlibs=dependlibs, libs=linklibs, frameworks=gfxframeworks, configs=configs)
+        generator.bin('renderbench', ['main.c'], 'renderbench', basepath='tools', implicit_deps=[
+                      render_lib], dependlibs=dependlibs, libs=linklibs, frameworks=gfxframeworks, configs=configs)
 
 includepaths = generator.test_includepaths()
 
@@ -22,6 +22,7 @@
 #include <render/internal.h>
 
 #include <render/null/backend.h>
+#include <render/software/backend.h>
 #include <render/metal/backend.h>
 #include <render/directx12/backend.h>
 #include <render/vulkan/backend.h>
@@ -52,16 +53,19 @@ render_api_fallback(render_api_t api) {
 #if FOUNDATION_PLATFORM_WINDOWS
 			return RENDERAPI_DIRECTX;
 #else
-			return RENDERAPI_NULL;
+			return RENDERAPI_SOFTWARE;
 #endif
 
 		case RENDERAPI_DIRECTX:
 			return RENDERAPI_DIRECTX12;
 
 		case RENDERAPI_DIRECTX12:
-			return RENDERAPI_NULL;
+			return RENDERAPI_SOFTWARE;
 
 		case RENDERAPI_METAL:
+			return RENDERAPI_SOFTWARE;
+
+		case RENDERAPI_SOFTWARE:
 		case RENDERAPI_COUNT:
 			return RENDERAPI_NULL;
 
@@ -76,11 +80,28 @@ render_backends(void) {
 	return render_backends_current;
 }
 
+// Backend independent state is initialized before the backend construct, which may already allocate
+// resources, and finalized after the backend destruct in render_backend_deallocate
+static bool
+render_backend_construct(render_backend_t* backend) {
+	backend->framecount = 1;
+	backend->statistics_lock = mutex_allocate(STRING_CONST("Resource statistics"));
+	render_buffer_residency_initialize(backend);
+	render_buffer_upload_initialize(backend);
+	render_slab_initialize(&backend->buffer_slab, sizeof(render_buffer_t));
+
+	uuidmap_initialize((uuidmap_t*)&backend->shader_table,
+	                   sizeof(backend->shader_table.bucket) / sizeof(backend->shader_table.bucket[0]), 0);
+
+	return backend->vtable.construct(backend);
+}
+
 render_backend_t*
 render_backend_allocate(render_api_t api, bool allow_fallback) {
 	// First find best matching supported backend
 	render_backend_t* backend = 0;
 
+	render_trace_begin("render_backend_allocate");
 	memory_context_push(HASH_RENDER);
 
 	if (api == RENDERAPI_DEFAULT)
@@ -92,7 +113,7 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 		switch (api) {
 			case RENDERAPI_DIRECTX12:
 				backend = render_backend_directx12_allocate();
-				if (!backend || !backend->vtable.construct(backend)) {
+				if (!backend || !render_backend_construct(backend)) {
 					log_info(HASH_RENDER, STRING_CONST("Failed to initialize DirectX 12 render backend"));
 					render_backend_deallocate(backend);
 					backend = nullptr;
@@ -101,7 +122,7 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 
 			case RENDERAPI_METAL:
 				backend = render_backend_metal_allocate();
-				if (!backend || !backend->vtable.construct(backend)) {
+				if (!backend || !render_backend_construct(backend)) {
 					log_info(HASH_RENDER, STRING_CONST("Failed to initialize Metal render backend"));
 					render_backend_deallocate(backend);
 					backend = nullptr;
@@ -110,16 +131,25 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 
 			case RENDERAPI_VULKAN:
 				backend = render_backend_vulkan_allocate();
-				if (!backend || !backend->vtable.construct(backend)) {
+				if (!backend || !render_backend_construct(backend)) {
 					log_info(HASH_RENDER, STRING_CONST("Failed to initialize Vulkan render backend"));
 					render_backend_deallocate(backend);
 					backend = nullptr;
 				}
 				break;
 
+			case RENDERAPI_SOFTWARE:
+				backend = render_backend_software_allocate();
+				if (!backend || !render_backend_construct(backend)) {
+					log_info(HASH_RENDER, STRING_CONST("Failed to initialize software render backend"));
+					render_backend_deallocate(backend);
+					backend = nullptr;
+				}
+				break;
+
 			case RENDERAPI_NULL:
 				backend = render_backend_null_allocate();
-				if (!backend || !backend->vtable.construct(backend)) {
+				if (!backend || !render_backend_construct(backend)) {
 					log_info(HASH_RENDER, STRING_CONST("Failed to initialize null render backend"));
 					render_backend_deallocate(backend);
 					backend = nullptr;
@@ -129,6 +159,8 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 			case RENDERAPI_UNKNOWN:
 				log_warn(HASH_RENDER, WARNING_SUSPICIOUS,
 				         STRING_CONST("No supported and enabled render api found, giving up"));
+				memory_context_pop();
+				render_trace_end("render_backend_allocate");
 				return 0;
 
 			case RENDERAPI_COUNT:
@@ -144,6 +176,8 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 		if (!backend) {
 			if (!allow_fallback) {
 				log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Requested render api not supported"));
+				memory_context_pop();
+				render_trace_end("render_backend_allocate");
 				return 0;
 			}
 
@@ -151,11 +185,6 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 		}
 	}
 
-	backend->framecount = 1;
-
-	uuidmap_initialize((uuidmap_t*)&backend->shader_table,
-	                   sizeof(backend->shader_table.bucket) / sizeof(backend->shader_table.bucket[0]), 0);
-
 	render_backend_set_resource_platform(backend, 0);
 
 	array_push(render_backends_current, backend);
@@ -163,6 +192,7 @@ render_backend_allocate(render_api_t api, bool allow_fallback) {
 	memory_context_pop();
 
 	set_thread_backend(backend);
+	render_trace_end("render_backend_allocate");
 
 	return backend;
 }
@@ -175,6 +205,10 @@ render_backend_deallocate(render_backend_t* backend) {
 	backend->vtable.destruct(backend);
 
 	uuidmap_finalize((uuidmap_t*)&backend->shader_table);
+	mutex_deallocate(backend->statistics_lock);
+	render_buffer_residency_finalize(backend);
+	render_buffer_upload_finalize(backend);
+	render_slab_finalize(&backend->buffer_slab);
 
 	for (size_t ib = 0, bsize = array_size(render_backends_current); ib < bsize; ++ib) {
 		if (render_backends_current[ib] == backend) {
@@ -227,10 +261,103 @@ render_backend_set_resource_platform(render_backend_t* backend, uint64_t platfor
 
 bool
 render_backend_shader_upload(render_backend_t* backend, render_shader_t* shader, const void* buffer, size_t size) {
-	return backend->vtable.shader_upload(backend, shader, buffer, size);
+	if (shader->size) {
+		render_backend_statistics_deallocate(backend, RENDERRESOURCE_SHADER, RENDERUSAGE_GPUONLY, shader->size);
+		shader->size = 0;
+	}
+	if (!backend->vtable.shader_upload(backend, shader, buffer, size))
+		return false;
+	shader->size = (uint32_t)size;
+	render_backend_statistics_allocate(backend, RENDERRESOURCE_SHADER, RENDERUSAGE_GPUONLY, size);
+	return true;
 }
 
 void
 render_backend_shader_finalize(render_backend_t* backend, render_shader_t* shader) {
+	if (shader->size) {
+		render_backend_statistics_deallocate(backend, RENDERRESOURCE_SHADER, RENDERUSAGE_GPUONLY, shader->size);
+		shader->size = 0;
+	}
 	backend->vtable.shader_finalize(backend, shader);
 }
+
+void
+render_backend_statistics(render_backend_t* backend, render_backend_statistics_t* statistics) {
+	mutex_lock(backend->statistics_lock);
+	*statistics = backend->statistics;
+	mutex_unlock(backend->statistics_lock);
+}
+
+static void
+render_backend_statistics_add(render_resource_statistics_t* statistics, size_t bytes) {
+	++statistics->count;
+	statistics->bytes += bytes;
+	if (statistics->count > statistics->count_high_water)
+		statistics->count_high_water = statistics->count;
+	if (statistics->bytes > statistics->bytes_high_water)
+		statistics->bytes_high_water = statistics->bytes;
+}
+
+static void
+render_backend_statistics_remove(render_resource_statistics_t* statistics, size_t bytes) {
+	if (statistics->count)
+		--statistics->count;
+	statistics->bytes = (statistics->bytes > bytes) ? (statistics->bytes - bytes) : 0;
+}
+
+void
+render_backend_statistics_allocate(render_backend_t* backend, render_resource_type_t type, uint usage, size_t bytes) {
+	render_backend_statistics_t* statistics = &backend->statistics;
+	mutex_lock(backend->statistics_lock);
+	render_backend_statistics_add(&statistics->total, bytes);
+	render_backend_statistics_add(&statistics->type[type], bytes);
+	if (!usage)
+		render_backend_statistics_add(&statistics->usage[RENDERUSAGEINDEX_DEFAULT], bytes);
+	for (uint iflag = 0; iflag < RENDERUSAGEINDEX_COUNT - 1; ++iflag) {
+		if (usage & (1U << iflag))
+			render_backend_statistics_add(&statistics->usage[iflag + 1], bytes);
+	}
+	++backend->statistics_allocations;
+	backend->statistics_bytes += bytes;
+	mutex_unlock(backend->statistics_lock);
+}
+
+void
+render_backend_statistics_deallocate(render_backend_t* backend, render_resource_type_t type, uint usage,
+                                     size_t bytes) {
+	render_backend_statistics_t* statistics = &backend->statistics;
+	mutex_lock(backend->statistics_lock);
+	render_backend_statistics_remove(&statistics->total, bytes);
+	render_backend_statistics_remove(&statistics->type[type], bytes);
+	if (!usage)
+		render_backend_statistics_remove(&statistics->usage[RENDERUSAGEINDEX_DEFAULT], bytes);
+	for (uint iflag = 0; iflag < RENDERUSAGEINDEX_COUNT - 1; ++iflag) {
+		if (usage & (1U << iflag))
+			render_backend_statistics_remove(&statistics->usage[iflag + 1], bytes);
+	}
+	mutex_unlock(backend->statistics_lock);
+}
+
+bool
+render_backend_statistics_frame(render_backend_t* backend, uint64_t* last_frame) {
+	render_backend_statistics_t* statistics = &backend->statistics;
+	mutex_lock(backend->statistics_lock);
+	// Other pipelines flushing in the same backend frame only catch up to it
+	if (*last_frame != backend->framecount) {
+		*last_frame = backend->framecount;
+		mutex_unlock(backend->statistics_lock);
+		return false;
+	}
+	*last_frame = ++backend->framecount;
+	++statistics->frame_count;
+	statistics->frame_allocations = backend->statistics_allocations;
+	statistics->frame_bytes = backend->statistics_bytes;
+	backend->statistics_allocations_total += backend->statistics_allocations;
+	backend->statistics_bytes_total += backend->statistics_bytes;
+	statistics->average_allocations = (real)backend->statistics_allocations_total / (real)statistics->frame_count;
+	statistics->average_bytes = (real)backend->statistics_bytes_total / (real)statistics->frame_count;
+	backend->statistics_allocations = 0;
+	backend->statistics_bytes = 0;
+	mutex_unlock(backend->statistics_lock);
+	return true;
+}
@@ -62,4 +62,15 @@ render_backend_shader_upload(render_backend_t* backend, render_shader_t* shader,
 RENDER_API void
 render_backend_shader_finalize(render_backend_t* backend, render_shader_t* shader);
 
+/*! Get resource accounting of a backend, live counts and sizes of buffers, targets, shaders and
+    pipeline states by usage flag and type with high-water marks, and allocation rate per frame.
+    A frame is advanced by a pipeline flush if that pipeline was already flushed in the current
+    frame, so pipelines each flushed once per frame advance it once. Sizes are the requested sizes
+    of buffers and shader binaries and the pixel storage size of targets, not including backend
+    driver overhead
+    \param backend Backend
+    \param statistics Statistics result */
+RENDER_API void
+render_backend_statistics(render_backend_t* backend, render_backend_statistics_t* statistics);
+
 #define render_backend_shader_table(backend) ((uuidmap_t*)&((backend)->shader_table))
@@ -20,66 +20,381 @@
 #include <render/render.h>
 #include <render/internal.h>
 
+#if FOUNDATION_ARCH_SSE2
+#include <emmintrin.h>
+#elif FOUNDATION_ARCH_NEON
+#include <arm_neon.h>
+#endif
+
 render_buffer_t*
 render_buffer_allocate(render_backend_t* backend, render_usage_t usage, size_t buffer_size, const void* data,
                        size_t data_size) {
-	render_buffer_t* buffer =
-	    memory_allocate(HASH_RENDER, sizeof(render_buffer_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	render_handle_t handle;
+	render_buffer_t* buffer = render_slab_allocate(&backend->buffer_slab, &handle);
+	if (!buffer)
+		return nullptr;
 	buffer->backend = backend;
+	buffer->handle = handle;
 	buffer->usage = (uint8_t)usage;
 	semaphore_initialize(&buffer->lock, 1);
+	semaphore_initialize(&buffer->lock_wake, 0);
 	memset(buffer->backend_data, 0, sizeof(buffer->backend_data));
 	if (buffer_size)
 		backend->vtable.buffer_allocate(backend, buffer, buffer_size, data, data_size);
+	render_backend_statistics_allocate(backend, RENDERRESOURCE_BUFFER, usage, buffer->allocated);
 	return buffer;
 }
 
 void
 render_buffer_deallocate(render_buffer_t* buffer) {
-	if (buffer) {
+	if (buffer)
+		render_buffer_upload_discard(buffer);
+	if (buffer && buffer->pool) {
+		render_buffer_pool_buffer_deallocate(buffer);
+	} else if (buffer) {
+		if (buffer->residency_index || buffer->snapshot)
+			render_buffer_residency_discard(buffer);
+		render_backend_statistics_deallocate(buffer->backend, RENDERRESOURCE_BUFFER, buffer->usage, buffer->allocated);
 		buffer->backend->vtable.buffer_deallocate(buffer->backend, buffer, true, true);
+		render_buffer_layout_deallocate(buffer->layout);
 		semaphore_finalize(&buffer->lock);
-		memory_deallocate(buffer);
+		semaphore_finalize(&buffer->lock_wake);
+		render_slab_free(&buffer->backend->buffer_slab, buffer->handle);
+	}
+}
+
+render_buffer_t*
+render_buffer_lookup_handle(render_backend_t* backend, render_handle_t handle) {
+	return render_slab_lookup(&backend->buffer_slab, handle);
+}
+
+// Merge the closest neighbouring ranges until the set fits in the buffer
+static uint
+render_buffer_dirty_merge(render_buffer_range_t* range, uint count) {
+	while (count > RENDER_BUFFER_DIRTY_RANGE_COUNT) {
+		uint closest = 0;
+		for (uint irange = 1; irange < count - 1; ++irange) {
+			if ((range[irange + 1].begin - range[irange].end) < (range[closest + 1].begin - range[closest].end))
+				closest = irange;
+		}
+		range[closest].end = range[closest + 1].end;
+		memmove(range + closest + 1, range + closest + 2, sizeof(render_buffer_range_t) * (count - (closest + 2)));
+		--count;
+	}
+	return count;
+}
+
+static void
+render_buffer_dirty_insert(render_buffer_t* buffer, size_t begin, size_t end) {
+	render_buffer_range_t range[RENDER_BUFFER_DIRTY_RANGE_COUNT + 1];
+	uint count = buffer->dirty_count;
+	memcpy(range, buffer->dirty, sizeof(render_buffer_range_t) * count);
+
+	// Coalesce with all overlapping or adjacent ranges
+	uint first = 0;
+	while ((first < count) && (range[first].end < begin))
+		++first;
+	uint last = first;
+	while ((last < count) && (range[last].begin <= end)) {
+		if (range[last].begin < begin)
+			begin = range[last].begin;
+		if (range[last].end > end)
+			end = range[last].end;
+		++last;
+	}
+	memmove(range + first + 1, range + last, sizeof(render_buffer_range_t) * (count - last));
+	count = (count - (last - first)) + 1;
+	range[first].begin = begin;
+	range[first].end = end;
+
+	count = render_buffer_dirty_merge(range, count);
+	memcpy(buffer->dirty, range, sizeof(render_buffer_range_t) * count);
+	buffer->dirty_count = count;
+}
+
+static void
+render_buffer_dirty_remove(render_buffer_t* buffer, size_t begin, size_t end) {
+	// At most one range can be split in two since ranges are disjoint
+	render_buffer_range_t range[RENDER_BUFFER_DIRTY_RANGE_COUNT + 1];
+	uint count = 0;
+	for (uint irange = 0; irange < buffer->dirty_count; ++irange) {
+		const render_buffer_range_t* dirty = buffer->dirty + irange;
+		if ((dirty->end <= begin) || (dirty->begin >= end)) {
+			range[count++] = *dirty;
+			continue;
+		}
+		if (dirty->begin < begin) {
+			range[count].begin = dirty->begin;
+			range[count++].end = begin;
+		}
+		if (dirty->end > end) {
+			range[count].begin = end;
+			range[count++].end = dirty->end;
+		}
 	}
+	count = render_buffer_dirty_merge(range, count);
+	memcpy(buffer->dirty, range, sizeof(render_buffer_range_t) * count);
+	buffer->dirty_count = count;
+}
+
+static void
+render_buffer_upload_range(render_buffer_t* buffer, size_t offset, size_t size) {
+	if (buffer->pool)
+		render_buffer_pool_buffer_upload(buffer, offset, size);
+	else
+		buffer->backend->vtable.buffer_upload(buffer->backend, buffer, offset, size);
 }
 
 void
 render_buffer_upload(render_buffer_t* buffer, size_t offset, size_t size) {
-	if (buffer->flags & RENDERBUFFER_DIRTY) {
-		buffer->backend->vtable.buffer_upload(buffer->backend, buffer, offset, size);
+	if (!(buffer->flags & RENDERBUFFER_DIRTY))
+		return;
+	render_trace_begin("render_buffer_upload");
+	if (!(buffer->flags & RENDERBUFFER_DIRTY_RANGE)) {
+		render_buffer_upload_range(buffer, offset, size);
 		buffer->flags &= ~(uint)RENDERBUFFER_DIRTY;
+	} else {
+		size_t begin = (offset < buffer->allocated) ? offset : buffer->allocated;
+		size_t end = (size && (size < (buffer->allocated - begin))) ? begin + size : buffer->allocated;
+
+		// Push the dirty spans inside the requested range, or the full range in one upload
+		// if the spans cover most of it anyway
+		size_t covered = 0;
+		uint count = 0;
+		for (uint irange = 0; irange < buffer->dirty_count; ++irange) {
+			size_t span_begin = (buffer->dirty[irange].begin > begin) ? buffer->dirty[irange].begin : begin;
+			size_t span_end = (buffer->dirty[irange].end < end) ? buffer->dirty[irange].end : end;
+			if (span_begin < span_end) {
+				covered += span_end - span_begin;
+				++count;
+			}
+		}
+		if ((count > 1) && ((covered * 100) >= ((end - begin) * RENDER_BUFFER_DIRTY_UPLOAD_THRESHOLD))) {
+			render_buffer_upload_range(buffer, begin, end - begin);
+		} else if (count) {
+			for (uint irange = 0; irange < buffer->dirty_count; ++irange) {
+				size_t span_begin = (buffer->dirty[irange].begin > begin) ? buffer->dirty[irange].begin : begin;
+				size_t span_end = (buffer->dirty[irange].end < end) ? buffer->dirty[irange].end : end;
+				if (span_begin < span_end)
+					render_buffer_upload_range(buffer, span_begin, span_end - span_begin);
+			}
+		}
+
+		render_buffer_dirty_remove(buffer, begin, end);
+		if (!buffer->dirty_count)
+			buffer->flags &= ~(uint)(RENDERBUFFER_DIRTY | RENDERBUFFER_DIRTY_RANGE);
+	}
+	render_trace_end("render_buffer_upload");
+}
+
+#if BUILD_ENABLE_ASSERT
+// Buffers read locked by the thread, to catch read lock re-entry behind a pending writer
+#define RENDERBUFFER_THREAD_READ_LOCKS 16
+
+FOUNDATION_DECLARE_THREAD_LOCAL_ARRAY(render_buffer_t*, buffer_read_lock, RENDERBUFFER_THREAD_READ_LOCKS)
+
+static bool
+render_buffer_lock_read_held(render_buffer_t* buffer) {
+	render_buffer_t** read_lock = get_thread_buffer_read_lock();
+	for (uint ilock = 0; ilock < RENDERBUFFER_THREAD_READ_LOCKS; ++ilock) {
+		if (read_lock[ilock] == buffer)
+			return true;
+	}
+	return false;
+}
+
+// Replace one tracked entry, a full table only loses tracking of further read locks
+static void
+render_buffer_lock_read_track(render_buffer_t* previous, render_buffer_t* buffer) {
+	render_buffer_t** read_lock = get_thread_buffer_read_lock();
+	for (uint ilock = 0; ilock < RENDERBUFFER_THREAD_READ_LOCKS; ++ilock) {
+		if (read_lock[ilock] == previous) {
+			read_lock[ilock] = buffer;
+			return;
+		}
+	}
+}
+#endif
+
+static bool
+render_buffer_lock_read_try(render_buffer_t* buffer) {
+	int32_t state = atomic_load32(&buffer->lock_state, memory_order_relaxed);
+	while (!(state & (RENDERBUFFER_STATE_WRITER | RENDERBUFFER_STATE_PENDING))) {
+		if (atomic_cas32(&buffer->lock_state, state + 1, state, memory_order_acquire, memory_order_relaxed))
+			return true;
+		state = atomic_load32(&buffer->lock_state, memory_order_relaxed);
+	}
+	return false;
+}
+
+// Block the contender until the lock state changes, with the waiting flag raised before the final
+// check so a release in between either sees the flag and posts, or is seen by the check
+static void
+render_buffer_lock_wait(render_buffer_t* buffer, bool (*acquire)(render_buffer_t*)) {
+	while (true) {
+		atomic_store32(&buffer->lock_waiting, 1, memory_order_relaxed);
+		atomic_thread_fence_sequentially_consistent();
+		if (acquire(buffer))
+			break;
+		semaphore_wait(&buffer->lock_wake);
 	}
+	// A releaser that claimed the flag has posted or is about to, consume it to keep the count balanced
+	if (!atomic_cas32(&buffer->lock_waiting, 0, 1, memory_order_relaxed, memory_order_relaxed))
+		semaphore_wait(&buffer->lock_wake);
+}
+
+void
+render_buffer_lock_wake(render_buffer_t* buffer) {
+	atomic_thread_fence_sequentially_consistent();
+	if (atomic_load32(&buffer->lock_waiting, memory_order_relaxed) &&
+	    atomic_cas32(&buffer->lock_waiting, 0, 1, memory_order_relaxed, memory_order_relaxed))
+		semaphore_post(&buffer->lock_wake);
+}
+
+static bool
+render_buffer_lock_write_try(render_buffer_t* buffer) {
+	return atomic_cas32(&buffer->lock_state, RENDERBUFFER_STATE_WRITER, RENDERBUFFER_STATE_PENDING,
+	                    memory_order_acquire, memory_order_relaxed);
+}
+
+static void
+render_buffer_lock_read(render_buffer_t* buffer) {
+	if (render_buffer_lock_read_try(buffer))
+		return;
+	// Writer holds or waits for the lock, queue up behind it. A pending writer waits for all
+	// current readers, so a thread already holding a read lock would wait for itself
+#if BUILD_ENABLE_ASSERT
+	FOUNDATION_ASSERT_MSG(!render_buffer_lock_read_held(buffer),
+	                      "Buffer read lock re-entered while a writer is pending");
+#endif
+	semaphore_wait(&buffer->lock);
+	render_buffer_lock_wait(buffer, render_buffer_lock_read_try);
+	semaphore_post(&buffer->lock);
+}
+
+static void
+render_buffer_lock_write(render_buffer_t* buffer) {
+	if (atomic_cas32(&buffer->lock_state, RENDERBUFFER_STATE_WRITER, 0, memory_order_acquire, memory_order_relaxed))
+		return;
+	// Only one contending writer at a time flags itself as pending, which stops new readers
+	// from entering, and waits for current lock holders to drain
+	semaphore_wait(&buffer->lock);
+	atomic_add32(&buffer->lock_state, RENDERBUFFER_STATE_PENDING, memory_order_relaxed);
+	render_buffer_lock_wait(buffer, render_buffer_lock_write_try);
+	semaphore_post(&buffer->lock);
+}
+
+static bool
+render_buffer_lock_is_owner(render_buffer_t* buffer) {
+	return (atomic_load32(&buffer->lock_state, memory_order_relaxed) & RENDERBUFFER_STATE_WRITER) &&
+	       ((uint64_t)atomic_load64(&buffer->lock_owner, memory_order_relaxed) == thread_id());
 }
 
 void
 render_buffer_lock(render_buffer_t* buffer, unsigned int lock) {
 	if (buffer->usage == RENDERUSAGE_GPUONLY)
 		return;
-	semaphore_wait(&buffer->lock);
-	{
-		buffer->locks++;
+	render_trace_begin("render_buffer_lock");
+	if (render_buffer_lock_is_owner(buffer)) {
+		// Nested lock in the thread holding the write lock
+		++buffer->locks;
+		buffer->flags |= (lock & RENDERBUFFER_LOCK_BITS);
+	} else if (lock & (RENDERBUFFER_LOCK_WRITE | RENDERBUFFER_LOCK_DISCARD)) {
+		render_buffer_lock_write(buffer);
+		atomic_store64(&buffer->lock_owner, (int64_t)thread_id(), memory_order_relaxed);
+		buffer->locks = 1;
+		if (buffer->flags & RENDERBUFFER_LOST)
+			render_buffer_restore(buffer);
 		buffer->access = buffer->store;
 		buffer->flags |= (lock & RENDERBUFFER_LOCK_BITS);
+	} else {
+		render_buffer_lock_read(buffer);
+#if BUILD_ENABLE_ASSERT
+		render_buffer_lock_read_track(nullptr, buffer);
+#endif
+		if (buffer->flags & RENDERBUFFER_LOST)
+			render_buffer_restore(buffer);
+		buffer->access = buffer->store;
 	}
-	semaphore_post(&buffer->lock);
+	if (buffer->last_frame != buffer->backend->framecount)
+		buffer->last_frame = buffer->backend->framecount;
+	render_trace_end("render_buffer_lock");
+}
+
+void
+render_buffer_dirty(render_buffer_t* buffer, size_t offset, size_t size) {
+	size_t begin = (offset < buffer->allocated) ? offset : buffer->allocated;
+	size_t end = (size && (size < (buffer->allocated - begin))) ? begin + size : buffer->allocated;
+	if (begin >= end)
+		return;
+	if (render_buffer_lock_is_owner(buffer))
+		buffer->flags |= RENDERBUFFER_LOCK_RANGE;
+	if (!(buffer->flags & RENDERBUFFER_DIRTY)) {
+		buffer->dirty_count = 0;
+		buffer->flags |= RENDERBUFFER_DIRTY | RENDERBUFFER_DIRTY_RANGE;
+	} else if (!(buffer->flags & RENDERBUFFER_DIRTY_RANGE)) {
+		// Whole buffer already dirty
+		return;
+	}
+	render_buffer_dirty_insert(buffer, begin, end);
 }
 
 void
 render_buffer_unlock(render_buffer_t* buffer) {
-	semaphore_wait(&buffer->lock);
-	if (buffer->locks) {
-		--buffer->locks;
-		if (!buffer->locks) {
+	if (buffer->usage == RENDERUSAGE_GPUONLY)
+		return;
+	render_trace_begin("render_buffer_unlock");
+	if (render_buffer_lock_is_owner(buffer)) {
+		if (!--buffer->locks) {
 			buffer->access = nullptr;
 			if (buffer->flags & RENDERBUFFER_LOCK_WRITE) {
+				// Without any ranges marked the whole buffer is considered written
+				if (!(buffer->flags & RENDERBUFFER_LOCK_RANGE))
+					buffer->flags &= ~(uint)RENDERBUFFER_DIRTY_RANGE;
 				buffer->flags |= RENDERBUFFER_DIRTY;
 				if ((buffer->flags & RENDERBUFFER_LOCK_WRITE_ALL) == RENDERBUFFER_LOCK_WRITE_ALL)
-					render_buffer_upload(buffer, 0, 0);
+					render_buffer_upload_enqueue(buffer);
 			}
 			buffer->flags &= ~(uint32_t)RENDERBUFFER_LOCK_BITS;
+			atomic_store64(&buffer->lock_owner, 0, memory_order_relaxed);
+			atomic_add32(&buffer->lock_state, -RENDERBUFFER_STATE_WRITER, memory_order_release);
+			render_buffer_lock_wake(buffer);
+		}
+	} else {
+		int32_t state = atomic_load32(&buffer->lock_state, memory_order_relaxed);
+		// Readers are excluded while the write lock is held, so the write lock is not ours to release
+		FOUNDATION_ASSERT_MSG(!(state & RENDERBUFFER_STATE_WRITER), "Buffer write lock released by non-owner thread");
+		if (state & RENDERBUFFER_STATE_READERS) {
+#if BUILD_ENABLE_ASSERT
+			render_buffer_lock_read_track(buffer, nullptr);
+#endif
+			// Only the last reader out can let a pending writer in
+			if (!(atomic_add32(&buffer->lock_state, -1, memory_order_release) & RENDERBUFFER_STATE_READERS))
+				render_buffer_lock_wake(buffer);
 		}
 	}
-	semaphore_post(&buffer->lock);
+	render_trace_end("render_buffer_unlock");
+}
+
+void
+render_buffer_free(render_buffer_t* buffer, bool sys, bool aux) {
+	// Releasing GPU storage discards the CPU storage as well since the content is kept in one place
+	if (!sys && !aux)
+		return;
+	mutex_lock(buffer->backend->residency.lock);
+	render_buffer_residency_evict(buffer, aux);
+	mutex_unlock(buffer->backend->residency.lock);
+}
+
+void
+render_buffer_restore(render_buffer_t* buffer) {
+	if (!(buffer->flags & RENDERBUFFER_LOST))
+		return;
+	render_trace_begin("render_buffer_restore");
+	mutex_lock(buffer->backend->residency.lock);
+	render_buffer_residency_restore(buffer);
+	mutex_unlock(buffer->backend->residency.lock);
+	render_trace_end("render_buffer_restore");
 }
 
 void
@@ -104,10 +419,113 @@ render_buffer_data_encode_constant(render_buffer_t* buffer, uint instance, uint
 	buffer->backend->vtable.buffer_data_encode_constant(buffer->backend, buffer, instance, index, data, size);
 }
 
+void
+render_buffer_data_encode_matrix_array(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                       const matrix_t* matrices) {
+	render_backend_t* backend = buffer->backend;
+	if (backend->vtable.buffer_data_encode_matrix_array) {
+		backend->vtable.buffer_data_encode_matrix_array(backend, buffer, first_instance, count, index, matrices);
+		return;
+	}
+	for (uint iinst = 0; iinst < count; ++iinst)
+		backend->vtable.buffer_data_encode_matrix(backend, buffer, first_instance + iinst, index, matrices + iinst);
+}
+
+void
+render_buffer_data_encode_constant_array(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                         const void* data, uint size) {
+	render_backend_t* backend = buffer->backend;
+	if (backend->vtable.buffer_data_encode_constant_array) {
+		backend->vtable.buffer_data_encode_constant_array(backend, buffer, first_instance, count, index, data, size);
+		return;
+	}
+	const char* source = data;
+	for (uint iinst = 0; iinst < count; ++iinst, source += size)
+		backend->vtable.buffer_data_encode_constant(backend, buffer, first_instance + iinst, index, source, size);
+}
+
+void
+render_buffer_data_store_matrix(void* destination, size_t stride, const matrix_t* matrix, size_t count) {
+	const float* source = (const float*)matrix;
+	char* dest = destination;
+#if FOUNDATION_ARCH_SSE2
+	// Streaming stores bypass the cache for large batches that are consumed by the GPU and not read back
+	if ((count >= RENDER_BUFFER_DATA_STREAM_THRESHOLD) && !((uintptr_t)dest & 15) && !(stride & 15)) {
+		for (size_t imat = 0; imat < count; ++imat, source += 16, dest += stride) {
+			__m128 row0 = _mm_loadu_ps(source);
+			__m128 row1 = _mm_loadu_ps(source + 4);
+			__m128 row2 = _mm_loadu_ps(source + 8);
+			__m128 row3 = _mm_loadu_ps(source + 12);
+			_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+			_mm_stream_ps((float*)dest, row0);
+			_mm_stream_ps((float*)dest + 4, row1);
+			_mm_stream_ps((float*)dest + 8, row2);
+			_mm_stream_ps((float*)dest + 12, row3);
+		}
+		_mm_sfence();
+		return;
+	}
+	for (size_t imat = 0; imat < count; ++imat, source += 16, dest += stride) {
+		__m128 row0 = _mm_loadu_ps(source);
+		__m128 row1 = _mm_loadu_ps(source + 4);
+		__m128 row2 = _mm_loadu_ps(source + 8);
+		__m128 row3 = _mm_loadu_ps(source + 12);
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		_mm_storeu_ps((float*)dest, row0);
+		_mm_storeu_ps((float*)dest + 4, row1);
+		_mm_storeu_ps((float*)dest + 8, row2);
+		_mm_storeu_ps((float*)dest + 12, row3);
+	}
+#elif FOUNDATION_ARCH_NEON
+	// De-interleaving load yields the columns of the matrix directly
+	for (size_t imat = 0; imat < count; ++imat, source += 16, dest += stride) {
+		float32x4x4_t column = vld4q_f32(source);
+		vst1q_f32((float*)dest, column.val[0]);
+		vst1q_f32((float*)dest + 4, column.val[1]);
+		vst1q_f32((float*)dest + 8, column.val[2]);
+		vst1q_f32((float*)dest + 12, column.val[3]);
+	}
+#else
+	for (size_t imat = 0; imat < count; ++imat, source += 16, dest += stride) {
+		float transposed[16];
+		for (uint icol = 0; icol < 4; ++icol) {
+			for (uint irow = 0; irow < 4; ++irow)
+				transposed[(icol * 4) + irow] = source[(irow * 4) + icol];
+		}
+		memcpy(dest, transposed, sizeof(transposed));
+	}
+#endif
+}
+
+void
+render_buffer_data_store_constant(void* destination, size_t stride, const void* data, size_t source_stride,
+                                  size_t size, size_t count) {
+	const char* source = data;
+	char* dest = destination;
+	if ((stride == size) && (source_stride == size)) {
+		memcpy(dest, source, size * count);
+		return;
+	}
+#if FOUNDATION_ARCH_SSE2
+	if ((count >= RENDER_BUFFER_DATA_STREAM_THRESHOLD) && !(size & 15) && !((uintptr_t)dest & 15) && !(stride & 15)) {
+		for (size_t iconst = 0; iconst < count; ++iconst, source += source_stride, dest += stride) {
+			for (size_t offset = 0; offset < size; offset += 16)
+				_mm_stream_si128((__m128i*)(dest + offset), _mm_loadu_si128((const __m128i*)(source + offset)));
+		}
+		_mm_sfence();
+		return;
+	}
+#endif
+	for (size_t iconst = 0; iconst < count; ++iconst, source += source_stride, dest += stride)
+		memcpy(dest, source, size);
+}
+
 void
 render_buffer_set_label(render_buffer_t* buffer, const char* name, size_t length) {
 #if BUILD_DEBUG || BUILD_RELEASE
-	buffer->backend->vtable.buffer_set_label(buffer->backend, buffer, name, length);
+	// Logical pool buffers have no backend object of their own
+	if (!buffer->pool)
+		buffer->backend->vtable.buffer_set_label(buffer->backend, buffer, name, length);
 #endif
 	FOUNDATION_UNUSED(buffer, name, length);
 }
@@ -30,21 +30,59 @@ render_buffer_allocate(render_backend_t* backend, uint usage, size_t buffer_size
 RENDER_API void
 render_buffer_deallocate(render_buffer_t* buffer);
 
+/*! Resolve a buffer handle. Thread safe and lock-free
+    \param backend Backend
+    \param handle Buffer handle
+    \return Buffer, null if the handle is stale or invalid */
+RENDER_API render_buffer_t*
+render_buffer_lookup_handle(render_backend_t* backend, render_handle_t handle);
+
+/*! Lock buffer for CPU access. Read locks are shared between threads, a write or discard lock
+    is exclusive. Nested locks are allowed in the thread holding the write lock, but a thread
+    holding a read lock must unlock it before taking a write lock. A thread holding a read lock
+    may only take another read lock if no writer is waiting, since a waiting writer blocks new
+    readers until all read locks are released. Unlock in the locking thread, both misuses are
+    asserted in builds with asserts enabled
+    \param buffer Buffer
+    \param lock Lock flags, combination of RENDERBUFFER_LOCK_* */
 RENDER_API void
 render_buffer_lock(render_buffer_t* buffer, unsigned int lock);
 
+/*! Mark a byte range of the buffer as modified. Overlapping and adjacent ranges are coalesced
+    and only the dirty ranges are pushed by the next upload. If a write lock is released without
+    any range marked, the whole buffer is considered dirty
+    \param buffer Buffer
+    \param offset Offset of range in bytes
+    \param size Size of range in bytes, 0 for the remainder of the buffer */
 RENDER_API void
 render_buffer_dirty(render_buffer_t* buffer, size_t offset, size_t size);
 
+/*! Unlock buffer. Releasing a write all lock queues the buffer for upload at the next flush of a
+    pipeline of the backend, see upload.h
+    \param buffer Buffer */
 RENDER_API void
 render_buffer_unlock(render_buffer_t* buffer);
 
+/*! Upload dirty content in the given range of the buffer to the GPU. Dirty ranges are uploaded
+    individually unless they cover RENDER_BUFFER_DIRTY_UPLOAD_THRESHOLD percent or more of the
+    range, in which case the full range is uploaded at once
+    \param buffer Buffer
+    \param offset Offset of range in bytes
+    \param size Size of range in bytes, 0 for the remainder of the buffer */
 RENDER_API void
 render_buffer_upload(render_buffer_t* buffer, size_t offset, size_t size);
 
+/*! Release storage of a buffer and flag it as lost, keeping the content in a compressed snapshot
+    or the restore callback given when tracking the buffer for residency. Storage the backend uses
+    as device memory is kept. Buffer must not be locked
+    \param buffer Buffer
+    \param sys Release CPU storage
+    \param aux Release GPU storage, implies releasing CPU storage */
 RENDER_API void
 render_buffer_free(render_buffer_t* buffer, bool sys, bool aux);
 
+/*! Restore storage and content of a lost buffer. Done automatically when a lost buffer is locked
+    \param buffer Buffer */
 RENDER_API void
 render_buffer_restore(render_buffer_t* buffer);
 
@@ -62,5 +100,27 @@ render_buffer_data_encode_matrix(render_buffer_t* buffer, uint instance, uint in
 RENDER_API void
 render_buffer_data_encode_constant(render_buffer_t* buffer, uint instance, uint index, const void* data, uint size);
 
+/*! Encode a matrix argument for a consecutive range of instances in a single call. Matrices are
+    transposed to column major and stored directly in the encoded layout of each instance
+    \param buffer Buffer with a previously declared data layout
+    \param first_instance First instance to encode
+    \param count Number of instances to encode
+    \param index Argument index in the data layout
+    \param matrices Array of count matrices */
+RENDER_API void
+render_buffer_data_encode_matrix_array(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                       const matrix_t* matrices);
+
+/*! Encode a constant argument for a consecutive range of instances in a single call
+    \param buffer Buffer with a previously declared data layout
+    \param first_instance First instance to encode
+    \param count Number of instances to encode
+    \param index Argument index in the data layout
+    \param data Array of count constants, tightly packed
+    \param size Size in bytes of each constant */
+RENDER_API void
+render_buffer_data_encode_constant_array(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                         const void* data, uint size);
+
 RENDER_API void
 render_buffer_set_label(render_buffer_t* buffer, const char* name, size_t length);
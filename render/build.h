@@ -41,3 +41,70 @@
 #endif
 
 // Allocation sizes
+
+//! Number of primitive slots reserved at a time by a thread queueing primitives to a pipeline
+#ifndef RENDER_PIPELINE_CHUNK_SIZE
+#define RENDER_PIPELINE_CHUNK_SIZE 256
+#endif
+
+//! Number of pipelines a thread can keep an open primitive chunk in at the same time
+#ifndef RENDER_PIPELINE_THREAD_CHUNK_COUNT
+#define RENDER_PIPELINE_THREAD_CHUNK_COUNT 4
+#endif
+
+//! Number of chunks in each overflow block chained to a pipeline when the primitive buffer is full
+#ifndef RENDER_PIPELINE_BLOCK_CHUNK_COUNT
+#define RENDER_PIPELINE_BLOCK_CHUNK_COUNT 16
+#endif
+
+//! Maximum number of overflow blocks chained to a pipeline in a single frame
+#ifndef RENDER_PIPELINE_BLOCK_COUNT
+#define RENDER_PIPELINE_BLOCK_COUNT 256
+#endif
+
+//! Default number of frames in flight for a pipeline
+#ifndef RENDER_PIPELINE_FRAME_COUNT
+#define RENDER_PIPELINE_FRAME_COUNT 2
+#endif
+
+//! Maximum number of frames in flight for a pipeline
+#ifndef RENDER_PIPELINE_FRAME_MAX
+#define RENDER_PIPELINE_FRAME_MAX 4
+#endif
+
+//! Default size in bytes of the backend buffers a buffer pool carves logical buffers from
+#ifndef RENDER_BUFFER_POOL_BLOCK_SIZE
+#define RENDER_BUFFER_POOL_BLOCK_SIZE (4 * 1024 * 1024)
+#endif
+
+//! Number of entries in each segment of a render index table, must be a power of two
+#ifndef RENDER_INDEX_TABLE_SEGMENT_SIZE
+#define RENDER_INDEX_TABLE_SEGMENT_SIZE 4096
+#endif
+
+//! Number of objects in each slab of a slab pool, must be a power of two
+#ifndef RENDER_SLAB_OBJECT_COUNT
+#define RENDER_SLAB_OBJECT_COUNT 256
+#endif
+
+//! Percentage of the uploaded range covered by dirty ranges at which a buffer upload is done as a single
+//! full range upload instead of one upload per dirty range
+#ifndef RENDER_BUFFER_DIRTY_UPLOAD_THRESHOLD
+#define RENDER_BUFFER_DIRTY_UPLOAD_THRESHOLD 50
+#endif
+
+//! Number of instances at which bulk structured data encoding switches to non-temporal streaming stores,
+//! smaller batches use regular stores and stay in the data cache
+#ifndef RENDER_BUFFER_DATA_STREAM_THRESHOLD
+#define RENDER_BUFFER_DATA_STREAM_THRESHOLD 256
+#endif
+
+//! Number of trace events in the ring of each recording thread, must be a power of two
+#ifndef RENDER_TRACE_EVENT_COUNT
+#define RENDER_TRACE_EVENT_COUNT 8192
+#endif
+
+//! Number of recent frames averaged in pipeline statistics
+#ifndef RENDER_PIPELINE_STATISTICS_FRAMES
+#define RENDER_PIPELINE_STATISTICS_FRAMES 32
+#endif
@@ -0,0 +1,191 @@
+/* command.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <render/command.h>
+#include <render/hashstrings.h>
+
+#include <foundation/memory.h>
+
+void
+render_command_buffer_initialize(render_command_buffer_t* buffer) {
+	memset(buffer, 0, sizeof(render_command_buffer_t));
+}
+
+void
+render_command_buffer_finalize(render_command_buffer_t* buffer) {
+	memory_deallocate(buffer->command);
+	memset(buffer, 0, sizeof(render_command_buffer_t));
+}
+
+static bool
+render_command_same_binding(const render_primitive_t* primitive, const render_primitive_t* next) {
+	return (primitive->pipeline_state == next->pipeline_state) &&
+	       (primitive->argument_buffer == next->argument_buffer) && (primitive->index_buffer == next->index_buffer) &&
+	       (primitive->descriptor[0] == next->descriptor[0]) && (primitive->descriptor[1] == next->descriptor[1]) &&
+	       (primitive->descriptor[2] == next->descriptor[2]) && (primitive->descriptor[3] == next->descriptor[3]);
+}
+
+static const render_argument_t*
+render_command_argument(const render_buffer_t* buffer, render_offset_t offset) {
+	if (!buffer || !buffer->store || (offset + sizeof(render_argument_t) > buffer->allocated))
+		return nullptr;
+	return pointer_offset_const(buffer->store, offset);
+}
+
+//! Grow the command storage to hold at least the given number of commands, keeping content
+static void
+render_command_buffer_reserve(render_command_buffer_t* buffer, uint used, uint capacity) {
+	if (capacity <= buffer->capacity)
+		return;
+	if (capacity < buffer->capacity * 2)
+		capacity = buffer->capacity * 2;
+	render_command_t* command =
+	    memory_allocate(HASH_RENDER, sizeof(render_command_t) * capacity, 0, MEMORY_PERSISTENT);
+	if (used)
+		memcpy(command, buffer->command, sizeof(render_command_t) * used);
+	memory_deallocate(buffer->command);
+	buffer->command = command;
+	buffer->capacity = capacity;
+}
+
+//! Encode the primitive stream, either storing the commands in the buffer or only counting them
+static uint
+render_command_encode_stream(render_command_buffer_t* buffer, render_backend_t* backend,
+                             const render_primitive_t* primitive, uint count, uint flags, bool store) {
+	// Storage grows on demand, most primitives encode a draw and a few binding commands
+	render_command_t scratch[RENDER_COMMAND_PRIMITIVE_MAX];
+	if (store)
+		render_command_buffer_reserve(buffer, 0, count + RENDER_COMMAND_PRIMITIVE_MAX);
+	uint counted = 0;
+
+	const bool merge = (flags & RENDERPIPELINE_MERGE_INSTANCES) && backend;
+	render_command_t* command = store ? buffer->command : scratch;
+	render_pipeline_state_t state = 0;
+	render_buffer_index_t argument = 0;
+	render_buffer_index_t index = 0;
+	render_buffer_index_t descriptor[4] = {0, 0, 0, 0};
+	render_buffer_t* argument_buffer = nullptr;
+	uint binds = 0;
+	uint state_binds = 0;
+	uint argument_binds = 0;
+	uint descriptor_binds = 0;
+	uint draws = 0;
+	uint merged = 0;
+	const render_primitive_t* primitive_end = primitive + count;
+	for (; primitive < primitive_end; ++primitive) {
+		if (store) {
+			uint used = (uint)(command - buffer->command);
+			if (used + RENDER_COMMAND_PRIMITIVE_MAX > buffer->capacity) {
+				render_command_buffer_reserve(buffer, used, used + RENDER_COMMAND_PRIMITIVE_MAX);
+				command = buffer->command + used;
+			}
+		} else {
+			counted += (uint)(command - scratch);
+			command = scratch;
+		}
+		if (primitive->pipeline_state != state) {
+			state = primitive->pipeline_state;
+			command->type = RENDERCOMMAND_BIND_STATE;
+			command->slot = 0;
+			command->value = state;
+			++command;
+			++binds;
+			++state_binds;
+		}
+		if (primitive->argument_buffer != argument) {
+			argument = primitive->argument_buffer;
+			command->type = RENDERCOMMAND_BIND_ARGUMENT;
+			command->slot = 0;
+			command->value = argument;
+			++command;
+			++binds;
+			++argument_binds;
+			if (merge)
+				argument_buffer = backend->vtable.buffer_lookup(backend, argument);
+		}
+		for (uint islot = 0; islot < 4; ++islot) {
+			if (primitive->descriptor[islot] != descriptor[islot]) {
+				descriptor[islot] = primitive->descriptor[islot];
+				command->type = RENDERCOMMAND_BIND_DESCRIPTOR;
+				command->slot = (uint16_t)islot;
+				command->value = descriptor[islot];
+				++command;
+				++binds;
+				++descriptor_binds;
+			}
+		}
+		if (primitive->index_buffer != index) {
+			index = primitive->index_buffer;
+			command->type = RENDERCOMMAND_BIND_INDEX;
+			command->slot = 0;
+			command->value = index;
+			++command;
+			++binds;
+		}
+
+		render_offset_t argument_offset = primitive->argument_offset;
+		const render_argument_t* first = merge ? render_command_argument(argument_buffer, argument_offset) : nullptr;
+		if (first) {
+			uint instance_count = first->instance_count;
+			uint instance_next = first->instance_base + first->instance_count;
+			while ((primitive + 1 < primitive_end) && render_command_same_binding(primitive, primitive + 1)) {
+				const render_argument_t* next = render_command_argument(argument_buffer, primitive[1].argument_offset);
+				if (!next || (next->index_count != first->index_count) || (next->index_offset != first->index_offset) ||
+				    (next->vertex_base != first->vertex_base) || (next->instance_base != instance_next))
+					break;
+				instance_count += next->instance_count;
+				instance_next += next->instance_count;
+				++primitive;
+				++merged;
+			}
+			if (instance_count != first->instance_count) {
+				command->type = RENDERCOMMAND_INSTANCE_COUNT;
+				command->slot = 0;
+				command->value = instance_count;
+				++command;
+			}
+		}
+
+		command->type = RENDERCOMMAND_DRAW;
+		command->slot = 0;
+		command->value = argument_offset;
+		++command;
+		++draws;
+	}
+
+	buffer->count = store ? (uint)(command - buffer->command) : (counted + (uint)(command - scratch));
+	buffer->eliminated = ((draws + merged) * RENDER_COMMAND_BIND_MAX) - binds;
+	buffer->merged = merged;
+	buffer->state_binds = state_binds;
+	buffer->argument_binds = argument_binds;
+	buffer->descriptor_binds = descriptor_binds;
+	buffer->draws = draws;
+	return buffer->count;
+}
+
+uint
+render_command_encode(render_command_buffer_t* buffer, render_backend_t* backend, const render_primitive_t* primitive,
+                      uint count, uint flags) {
+	return render_command_encode_stream(buffer, backend, primitive, count, flags, true);
+}
+
+uint
+render_command_count(render_command_buffer_t* buffer, render_backend_t* backend, const render_primitive_t* primitive,
+                     uint count, uint flags) {
+	return render_command_encode_stream(buffer, backend, primitive, count, flags, false);
+}
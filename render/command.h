@@ -0,0 +1,71 @@
+/* command.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file command.h
+    Backend neutral delta command stream */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+//! Maximum number of binding commands encoded for a single primitive
+#define RENDER_COMMAND_BIND_MAX 7
+
+//! Maximum number of commands encoded for a single primitive
+#define RENDER_COMMAND_PRIMITIVE_MAX (RENDER_COMMAND_BIND_MAX + 2)
+
+/*! Initialize an empty command buffer
+    \param buffer Command buffer */
+RENDER_API void
+render_command_buffer_initialize(render_command_buffer_t* buffer);
+
+/*! Release memory used by a command buffer
+    \param buffer Command buffer */
+RENDER_API void
+render_command_buffer_finalize(render_command_buffer_t* buffer);
+
+/*! Encode a primitive stream into a delta command stream, replacing previous content of the
+    buffer. Binding commands are only emitted when the bound state differs from the previous
+    primitive, and all bindings are initially zero. If RENDERPIPELINE_MERGE_INSTANCES is set,
+    consecutive primitives with identical bindings whose arguments have equal index count, index
+    offset and vertex base and contiguous instance ranges are merged into one instanced draw,
+    reading the arguments from the CPU store of the argument buffers.
+    \param buffer Command buffer
+    \param backend Backend used to look up argument buffers by render index
+    \param primitive Primitive stream
+    \param count Number of primitives
+    \param flags Pipeline flags (render_pipeline_flag_t)
+    \return Number of commands encoded */
+RENDER_API uint
+render_command_encode(render_command_buffer_t* buffer, render_backend_t* backend, const render_primitive_t* primitive,
+                      uint count, uint flags);
+
+/*! Count the commands a primitive stream encodes to without storing them, for backends that do
+    not read the command stream. Count, merge and binding counters of the buffer are updated as
+    with render_command_encode, but no commands are stored and the storage must not be read
+    \param buffer Command buffer
+    \param backend Backend used to look up argument buffers by render index
+    \param primitive Primitive stream
+    \param count Number of primitives
+    \param flags Pipeline flags (render_pipeline_flag_t)
+    \return Number of commands the stream encodes to */
+RENDER_API uint
+render_command_count(render_command_buffer_t* buffer, render_backend_t* backend, const render_primitive_t* primitive,
+                     uint count, uint flags);
@@ -90,6 +90,14 @@ rb_dx12_target_deallocate(render_backend_t* backend, render_target_t* target) {
 	memory_deallocate(target);
 }
 
+static bool
+rb_dx12_target_read_pixels(render_backend_t* backend, render_target_t* target, const render_rect_t* rect, void* dst,
+                           render_target_read_fn callback, void* context) {
+	FOUNDATION_UNUSED(backend, target, rect, dst, callback, context);
+	log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("DirectX 12 backend does not support reading target pixels"));
+	return false;
+}
+
 static render_pipeline_t*
 rb_dx12_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
 	render_pipeline_t* pipeline =
@@ -142,7 +150,14 @@ rb_dx12_pipeline_build(render_backend_t* backend, render_pipeline_t* pipeline) {
 
 static void
 rb_dx12_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline) {
-	FOUNDATION_UNUSED(backend, pipeline);
+	FOUNDATION_UNUSED(backend);
+	render_pipeline_statistics_encoded(pipeline);
+	render_pipeline_frame_signal(pipeline, pipeline->frame_current);
+}
+
+static void
+rb_dx12_pipeline_wait(render_backend_t* backend, render_pipeline_t* pipeline, uint frame) {
+	FOUNDATION_UNUSED(backend, pipeline, frame);
 }
 
 static void
@@ -236,6 +251,12 @@ rb_dx12_buffer_set_label(render_backend_t* backend, render_buffer_t* buffer, con
 	FOUNDATION_UNUSED(backend, buffer, name, length);
 }
 
+static render_buffer_t*
+rb_dx12_buffer_lookup(render_backend_t* backend, render_buffer_index_t index) {
+	FOUNDATION_UNUSED(backend, index);
+	return nullptr;
+}
+
 static render_backend_vtable_t render_backend_vtable_null = {
     .construct = rb_dx12_construct,
     .destruct = rb_dx12_destruct,
@@ -244,6 +265,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .target_window_allocate = rb_dx12_target_window_allocate,
     .target_texture_allocate = rb_dx12_target_texture_allocate,
     .target_deallocate = rb_dx12_target_deallocate,
+    .target_read_pixels = rb_dx12_target_read_pixels,
     .pipeline_allocate = rb_dx12_pipeline_allocate,
     .pipeline_deallocate = rb_dx12_pipeline_deallocate,
     .pipeline_set_color_attachment = rb_dx12_pipeline_set_color_attachment,
@@ -252,6 +274,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .pipeline_set_depth_clear = rb_dx12_pipeline_set_depth_clear,
     .pipeline_build = rb_dx12_pipeline_build,
     .pipeline_flush = rb_dx12_pipeline_flush,
+    .pipeline_wait = rb_dx12_pipeline_wait,
     .pipeline_use_argument_buffer = rb_dx12_pipeline_use_argument_buffer,
     .pipeline_use_render_buffer = rb_dx12_pipeline_use_render_buffer,
     .pipeline_state_allocate = rb_dx12_pipeline_state_allocate,
@@ -262,6 +285,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .buffer_deallocate = rb_dx12_buffer_deallocate,
     .buffer_upload = rb_dx12_buffer_upload,
     .buffer_set_label = rb_dx12_buffer_set_label,
+    .buffer_lookup = rb_dx12_buffer_lookup,
     .buffer_data_declare = rb_dx12_buffer_data_declare,
     .buffer_data_encode_buffer = rb_dx12_buffer_data_encode_buffer,
     .buffer_data_encode_matrix = rb_dx12_buffer_data_encode_matrix,
@@ -0,0 +1,120 @@
+/* indirect.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <render/indirect.h>
+#include <render/hashstrings.h>
+
+#include <foundation/memory.h>
+
+#if FOUNDATION_ARCH_SSE2
+#include <emmintrin.h>
+#elif FOUNDATION_ARCH_NEON
+#include <arm_neon.h>
+#endif
+
+FOUNDATION_STATIC_ASSERT(sizeof(render_argument_t) == sizeof(render_indirect_command_t),
+                         "Argument and indirect record layout mismatch");
+
+void
+render_indirect_buffer_initialize(render_indirect_buffer_t* buffer) {
+	memset(buffer, 0, sizeof(render_indirect_buffer_t));
+}
+
+void
+render_indirect_buffer_finalize(render_indirect_buffer_t* buffer) {
+	memory_deallocate(buffer->command);
+	memory_deallocate(buffer->bucket);
+	memset(buffer, 0, sizeof(render_indirect_buffer_t));
+}
+
+//! Copy argument to indirect record, shifting the byte index offset to a first index
+static FOUNDATION_FORCEINLINE void
+render_indirect_gather(render_indirect_command_t* command, const render_argument_t* argument, uint shift) {
+#if FOUNDATION_ARCH_SSE2
+	// Index count, instance count, index offset and vertex base in one load, shift only the index offset lane
+	const __m128i mask = _mm_set_epi32(0, -1, 0, 0);
+	__m128i value = _mm_loadu_si128((const __m128i*)argument);
+	__m128i shifted = _mm_srl_epi32(value, _mm_cvtsi32_si128((int)shift));
+	value = _mm_or_si128(_mm_and_si128(mask, shifted), _mm_andnot_si128(mask, value));
+	_mm_storeu_si128((__m128i*)command, value);
+#elif FOUNDATION_ARCH_NEON
+	const int32_t lane_shift[4] = {0, 0, -(int32_t)shift, 0};
+	uint32x4_t value = vld1q_u32((const uint32_t*)argument);
+	vst1q_u32((uint32_t*)command, vshlq_u32(value, vld1q_s32(lane_shift)));
+#else
+	command->index_count = argument->index_count;
+	command->instance_count = argument->instance_count;
+	command->index_start = argument->index_offset >> shift;
+	command->vertex_base = (int32_t)argument->vertex_base;
+#endif
+	command->instance_base = argument->instance_base;
+}
+
+static bool
+render_indirect_same_bucket(const render_indirect_bucket_t* bucket, const render_primitive_t* primitive) {
+	return (bucket->pipeline_state == primitive->pipeline_state) && (bucket->index_buffer == primitive->index_buffer) &&
+	       (bucket->descriptor[0] == primitive->descriptor[0]) && (bucket->descriptor[1] == primitive->descriptor[1]) &&
+	       (bucket->descriptor[2] == primitive->descriptor[2]) && (bucket->descriptor[3] == primitive->descriptor[3]);
+}
+
+uint
+render_indirect_compile(render_indirect_buffer_t* buffer, render_backend_t* backend,
+                        const render_primitive_t* primitive, uint count, render_indexformat_t index_format) {
+	if (count > buffer->capacity) {
+		memory_deallocate(buffer->command);
+		memory_deallocate(buffer->bucket);
+		buffer->command =
+		    memory_allocate(HASH_RENDER, sizeof(render_indirect_command_t) * count, 16, MEMORY_PERSISTENT);
+		buffer->bucket = memory_allocate(HASH_RENDER, sizeof(render_indirect_bucket_t) * count, 0, MEMORY_PERSISTENT);
+		buffer->capacity = count;
+		buffer->bucket_capacity = count;
+	}
+
+	const uint shift = (index_format == RENDER_INDEXFORMAT_UINT16) ? 1 : 2;
+	render_indirect_command_t* command = buffer->command;
+	render_indirect_bucket_t* bucket = nullptr;
+	render_buffer_index_t argument_index = 0;
+	const render_buffer_t* argument_buffer = nullptr;
+	uint bucket_count = 0;
+	for (uint iprim = 0; iprim < count; ++iprim, ++primitive) {
+		if (!argument_buffer || (primitive->argument_buffer != argument_index)) {
+			argument_index = primitive->argument_buffer;
+			argument_buffer = backend->vtable.buffer_lookup(backend, argument_index);
+		}
+		if (!argument_buffer || !argument_buffer->store ||
+		    (primitive->argument_offset + sizeof(render_argument_t) > argument_buffer->allocated))
+			continue;
+
+		if (!bucket || !render_indirect_same_bucket(bucket, primitive)) {
+			bucket = buffer->bucket + bucket_count++;
+			bucket->pipeline_state = primitive->pipeline_state;
+			bucket->index_buffer = primitive->index_buffer;
+			memcpy(bucket->descriptor, primitive->descriptor, sizeof(bucket->descriptor));
+			bucket->first = (uint)(command - buffer->command);
+			bucket->count = 0;
+		}
+
+		render_indirect_gather(command++, pointer_offset_const(argument_buffer->store, primitive->argument_offset),
+		                       shift);
+		++bucket->count;
+	}
+
+	buffer->count = (uint)(command - buffer->command);
+	buffer->bucket_count = bucket_count;
+	return bucket_count;
+}
@@ -0,0 +1,51 @@
+/* indirect.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file indirect.h
+    Backend neutral indirect draw record compiler */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Initialize an empty indirect buffer
+    \param buffer Indirect buffer */
+RENDER_API void
+render_indirect_buffer_initialize(render_indirect_buffer_t* buffer);
+
+/*! Release memory used by an indirect buffer
+    \param buffer Indirect buffer */
+RENDER_API void
+render_indirect_buffer_finalize(render_indirect_buffer_t* buffer);
+
+/*! Compile a primitive stream into packed indirect draw records, replacing previous content of the
+    buffer. Arguments are gathered from the CPU store of the argument buffers and the byte index
+    offset is converted to a first index. Consecutive primitives with equal pipeline state, index
+    buffer and descriptors are grouped in buckets. Primitives with an argument buffer that cannot
+    be resolved are skipped.
+    \param buffer Indirect buffer
+    \param backend Backend used to look up argument buffers by render index
+    \param primitive Primitive stream
+    \param count Number of primitives
+    \param index_format Index format of the index buffers
+    \return Number of buckets */
+RENDER_API uint
+render_indirect_compile(render_indirect_buffer_t* buffer, render_backend_t* backend,
+                        const render_primitive_t* primitive, uint count, render_indexformat_t index_format);
@@ -33,5 +33,146 @@
 RENDER_EXTERN bool render_api_disabled[];
 RENDER_EXTERN render_config_t render_config;
 RENDER_EXTERN render_backend_t** render_backends_current;
+RENDER_EXTERN bool render_trace_enabled;
+
+//! Record begin and end trace events, a single branch when tracing is disabled. Name must be a string literal
+#define render_trace_begin(name)                  \
+	do {                                          \
+		if (render_trace_enabled)                 \
+			render_trace_event(name, 'B');        \
+	} while (0)
+#define render_trace_end(name)                    \
+	do {                                          \
+		if (render_trace_enabled)                 \
+			render_trace_event(name, 'E');        \
+	} while (0)
+
+//! Buffer lock state word, count of read locks in the low bits and writer state in the high bits
+#define RENDERBUFFER_STATE_WRITER 0x40000000
+#define RENDERBUFFER_STATE_PENDING 0x20000000
+#define RENDERBUFFER_STATE_READERS 0x1FFFFFFF
 
 // INTERNAL FUNCTIONS
+
+//! Record a trace event in the ring of the calling thread
+void
+render_trace_event(const char* name, char phase);
+
+//! Release all trace rings
+void
+render_trace_finalize(void);
+
+//! Allocate CPU pixel storage for a target with dimensions and format set
+void
+render_target_storage_allocate(render_target_t* target);
+
+//! Deallocate CPU pixel storage of a target
+void
+render_target_storage_deallocate(render_target_t* target);
+
+//! Account an allocated resource in backend statistics
+void
+render_backend_statistics_allocate(render_backend_t* backend, render_resource_type_t type, uint usage, size_t bytes);
+
+//! Remove a deallocated resource from backend statistics
+void
+render_backend_statistics_deallocate(render_backend_t* backend, render_resource_type_t type, uint usage,
+                                     size_t bytes);
+
+//! Called at pipeline flush with the backend frame of the last flush of the pipeline, completes the backend frame
+//! if the pipeline was already flushed in it. Returns true if a new backend frame was started
+bool
+render_backend_statistics_frame(render_backend_t* backend, uint64_t* last_frame);
+
+//! Wake the contending locker blocked on the buffer, if any, after releasing lock state
+void
+render_buffer_lock_wake(render_buffer_t* buffer);
+
+//! Release the range of a logical pool buffer and deallocate the buffer
+void
+render_buffer_pool_buffer_deallocate(render_buffer_t* buffer);
+
+//! Upload a range of a logical pool buffer through its pool block
+void
+render_buffer_pool_buffer_upload(render_buffer_t* buffer, size_t offset, size_t size);
+
+//! Store count matrices transposed to column major at a fixed destination stride
+void
+render_buffer_data_store_matrix(void* destination, size_t stride, const matrix_t* matrix, size_t count);
+
+//! Store the first size bytes of count constants read at source stride to a fixed destination stride
+void
+render_buffer_data_store_constant(void* destination, size_t stride, const void* data, size_t source_stride,
+                                  size_t size, size_t count);
+
+//! Declare structured data of a buffer with a CPU computed layout, growing the storage to hold all instances
+void
+render_buffer_layout_declare(render_buffer_t* buffer, size_t instance_count, const render_buffer_data_t* data,
+                             size_t data_count, render_buffer_layout_rule_t rule);
+
+//! Encode a 64-bit buffer pointer value in a buffer with a CPU computed layout
+void
+render_buffer_layout_encode_pointer(render_buffer_t* buffer, uint instance, uint index, uint64_t address);
+
+//! Encode matrices for a range of instances in a buffer with a CPU computed layout
+void
+render_buffer_layout_encode_matrix(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                   const matrix_t* matrices);
+
+//! Encode constants for a range of instances in a buffer with a CPU computed layout
+void
+render_buffer_layout_encode_constant(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                     const void* data, uint size);
+
+//! Initialize the buffer residency manager of a backend
+void
+render_buffer_residency_initialize(render_backend_t* backend);
+
+//! Finalize the buffer residency manager of a backend
+void
+render_buffer_residency_finalize(render_backend_t* backend);
+
+//! Stop tracking a buffer being deallocated and release any snapshot without restoring it
+void
+render_buffer_residency_discard(render_buffer_t* buffer);
+
+//! Evict least recently used tracked buffers while over budget, called at pipeline flush
+void
+render_buffer_residency_frame(render_backend_t* backend);
+
+//! Release CPU storage, and GPU storage if aux is set, keeping content in a snapshot or restore callback.
+//! Buffer must not be locked and the residency lock must be held
+void
+render_buffer_residency_evict(render_buffer_t* buffer, bool aux);
+
+//! Restore storage of a lost buffer, residency lock must be held
+void
+render_buffer_residency_restore(render_buffer_t* buffer);
+
+//! Initialize the upload queue of a backend
+void
+render_buffer_upload_initialize(render_backend_t* backend);
+
+//! Finalize the upload queue of a backend
+void
+render_buffer_upload_finalize(render_backend_t* backend);
+
+//! Queue a buffer for upload at the next drain of the upload queue, no-op if already queued
+void
+render_buffer_upload_enqueue(render_buffer_t* buffer);
+
+//! Drain the upload queue if the buffer is queued, or wait for an ongoing drain, before deallocation
+void
+render_buffer_upload_discard(render_buffer_t* buffer);
+
+//! Upload the region of the frame being flushed and update ring buffer statistics
+void
+render_ring_buffer_flush(render_ring_buffer_t* ring);
+
+//! Make the region of a frame current and empty, splitting the buffer in new regions if the frame count changed
+void
+render_ring_buffer_frame(render_ring_buffer_t* ring, uint frame, uint frame_count);
+
+//! Fill switch and draw counters of the frame being flushed from the encoded command stream
+void
+render_pipeline_statistics_encoded(render_pipeline_t* pipeline);
@@ -0,0 +1,201 @@
+/* layout.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+static uint
+render_buffer_layout_align(uint value, uint alignment) {
+	return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+render_buffer_layout_t*
+render_buffer_layout_allocate(const render_buffer_data_t* data, size_t data_count, render_buffer_layout_rule_t rule) {
+	uint field_count = 0;
+	for (size_t idata = 0; idata < data_count; ++idata) {
+		if (data[idata].index >= field_count)
+			field_count = data[idata].index + 1;
+	}
+
+	render_buffer_layout_t* layout =
+	    memory_allocate(HASH_RENDER, sizeof(render_buffer_layout_t) + (sizeof(render_buffer_layout_field_t) * field_count),
+	                    0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	layout->rule = rule;
+	layout->field_count = field_count;
+	layout->field = pointer_offset(layout, sizeof(render_buffer_layout_t));
+
+	// Structures are aligned to at least a vec4 in std140
+	uint offset = 0;
+	uint alignment = (rule == RENDERLAYOUT_STD140) ? 16 : 1;
+	for (size_t idata = 0; idata < data_count; ++idata) {
+		uint element_size = 0;
+		uint element_alignment = 0;
+		if (data[idata].data_type == RENDERDATA_POINTER) {
+			element_size = 8;
+			element_alignment = 8;
+		} else if (data[idata].data_type == RENDERDATA_FLOAT4) {
+			element_size = 16;
+			element_alignment = 16;
+		} else if (data[idata].data_type == RENDERDATA_MATRIX4X4) {
+			// Four column vectors
+			element_size = 64;
+			element_alignment = 16;
+		} else {
+			log_error(HASH_RENDER, ERROR_INVALID_VALUE, STRING_CONST("Invalid buffer structured data type"));
+			memory_deallocate(layout);
+			return nullptr;
+		}
+
+		render_buffer_layout_field_t* field = layout->field + data[idata].index;
+		if (field->size) {
+			log_error(HASH_RENDER, ERROR_INVALID_VALUE, STRING_CONST("Duplicate buffer structured data index"));
+			memory_deallocate(layout);
+			return nullptr;
+		}
+
+		// Array elements are aligned to a vec4 in std140
+		uint array_count = data[idata].array_count ? data[idata].array_count : 1;
+		uint array_stride = element_size;
+		if (data[idata].array_count && (rule == RENDERLAYOUT_STD140)) {
+			array_stride = render_buffer_layout_align(element_size, 16);
+			element_alignment = render_buffer_layout_align(element_alignment, 16);
+		}
+
+		offset = render_buffer_layout_align(offset, element_alignment);
+		field->offset = offset;
+		field->size = array_stride * array_count;
+		field->array_stride = array_stride;
+		field->array_count = array_count;
+		field->data_type = data[idata].data_type;
+		offset += field->size;
+		if (element_alignment > alignment)
+			alignment = element_alignment;
+	}
+
+	layout->alignment = alignment;
+	layout->stride = render_buffer_layout_align(offset, alignment);
+	return layout;
+}
+
+void
+render_buffer_layout_deallocate(render_buffer_layout_t* layout) {
+	memory_deallocate(layout);
+}
+
+const render_buffer_layout_field_t*
+render_buffer_layout_field(const render_buffer_layout_t* layout, uint index) {
+	if (!layout || (index >= layout->field_count) || !layout->field[index].size)
+		return nullptr;
+	return layout->field + index;
+}
+
+void
+render_buffer_layout_declare(render_buffer_t* buffer, size_t instance_count, const render_buffer_data_t* data,
+                             size_t data_count, render_buffer_layout_rule_t rule) {
+	if (buffer->pool) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE,
+		          STRING_CONST("Unable to declare buffer structured data in a logical pool buffer"));
+		return;
+	}
+	render_buffer_layout_t* layout = render_buffer_layout_allocate(data, data_count, rule);
+	if (!layout)
+		return;
+	render_buffer_layout_deallocate(buffer->layout);
+	buffer->layout = layout;
+
+	render_backend_t* backend = buffer->backend;
+	size_t total_size = (size_t)layout->stride * instance_count;
+	if (buffer->allocated < total_size) {
+		render_backend_statistics_deallocate(backend, RENDERRESOURCE_BUFFER, buffer->usage, buffer->allocated);
+		backend->vtable.buffer_deallocate(backend, buffer, true, false);
+		backend->vtable.buffer_allocate(backend, buffer, total_size, nullptr, 0);
+		render_backend_statistics_allocate(backend, RENDERRESOURCE_BUFFER, buffer->usage, buffer->allocated);
+	}
+	if (buffer->store) {
+		memset(buffer->store, 0, total_size);
+		buffer->used = total_size;
+	}
+}
+
+// Get the field of an encoded argument, validating the declaration and type
+static const render_buffer_layout_field_t*
+render_buffer_layout_encode_field(render_buffer_t* buffer, uint index, bool pointer, bool matrix) {
+	if (!buffer->layout) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE,
+		          STRING_CONST("Unable to encode buffer structured data without previous data layout declaration"));
+		return nullptr;
+	}
+	const render_buffer_layout_field_t* field = render_buffer_layout_field(buffer->layout, index);
+	if (!field || ((field->data_type == RENDERDATA_POINTER) != pointer) ||
+	    (matrix && (field->data_type != RENDERDATA_MATRIX4X4))) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE, STRING_CONST("Buffer structured data index type mismatch"));
+		return nullptr;
+	}
+	return field;
+}
+
+// Get the field in the first instance of an encoded range and mark the encoded span dirty
+static void*
+render_buffer_layout_encode_access(render_buffer_t* buffer, uint first_instance, uint count,
+                                   const render_buffer_layout_field_t* field) {
+	const render_buffer_layout_t* layout = buffer->layout;
+	if (!count || !buffer->store)
+		return nullptr;
+	if (((size_t)first_instance + count) * layout->stride > buffer->allocated) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE, STRING_CONST("Buffer structured data instance range out of bounds"));
+		return nullptr;
+	}
+
+	size_t offset = ((size_t)first_instance * layout->stride) + field->offset;
+	render_buffer_dirty(buffer, offset, ((size_t)(count - 1) * layout->stride) + field->size);
+	return pointer_offset(buffer->store, offset);
+}
+
+void
+render_buffer_layout_encode_pointer(render_buffer_t* buffer, uint instance, uint index, uint64_t address) {
+	const render_buffer_layout_field_t* field = render_buffer_layout_encode_field(buffer, index, true, false);
+	void* store = field ? render_buffer_layout_encode_access(buffer, instance, 1, field) : nullptr;
+	if (store)
+		memcpy(store, &address, sizeof(address));
+}
+
+void
+render_buffer_layout_encode_matrix(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                   const matrix_t* matrices) {
+	const render_buffer_layout_field_t* field = render_buffer_layout_encode_field(buffer, index, false, true);
+	void* store = field ? render_buffer_layout_encode_access(buffer, first_instance, count, field) : nullptr;
+	if (store)
+		render_buffer_data_store_matrix(store, buffer->layout->stride, matrices, count);
+}
+
+void
+render_buffer_layout_encode_constant(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                     const void* data, uint size) {
+	const render_buffer_layout_field_t* field = render_buffer_layout_encode_field(buffer, index, false, false);
+	void* store = field ? render_buffer_layout_encode_access(buffer, first_instance, count, field) : nullptr;
+	if (store) {
+		// Excess data is dropped, the field of each instance is filled from the start
+		uint stored = (size < field->size) ? size : field->size;
+		render_buffer_data_store_constant(store, buffer->layout->stride, data, size, stored, count);
+		if (stored < size)
+			log_warn(HASH_RENDER, WARNING_INVALID_VALUE,
+			         STRING_CONST("Buffer structured data constant larger than field, truncated"));
+	}
+}
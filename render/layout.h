@@ -0,0 +1,49 @@
+/* layout.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file layout.h
+    CPU computed layout of buffer structured data. A declaration of arguments is compiled into a
+    per-instance stride and field offsets following std140 or std430 alignment rules, and encoding
+    becomes a direct store into the buffer storage. Used by backends without argument encoders.
+    Matrices are stored column major, buffer pointers as 64-bit values */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Compute the layout of structured data. Fields are placed in declaration order
+    \param data Array of argument declarations
+    \param data_count Number of argument declarations
+    \param rule Alignment rules
+    \return Layout, null if a declaration is invalid */
+RENDER_API render_buffer_layout_t*
+render_buffer_layout_allocate(const render_buffer_data_t* data, size_t data_count, render_buffer_layout_rule_t rule);
+
+/*! Deallocate a layout
+    \param layout Layout */
+RENDER_API void
+render_buffer_layout_deallocate(render_buffer_layout_t* layout);
+
+/*! Get the field of an argument index
+    \param layout Layout
+    \param index Argument index
+    \return Field, null if the index is not declared */
+RENDER_API const render_buffer_layout_field_t*
+render_buffer_layout_field(const render_buffer_layout_t* layout, uint index);
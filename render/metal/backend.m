@@ -47,13 +47,11 @@ typedef struct render_backend_metal_t {
 	id<MTLArgumentEncoder> pipeline_state_encoder;
 
 	//! Buffer of buffer objects used for rendering
-	mutex_t* buffer_lock;
-	uintptr_t* buffer_array;
-	render_buffer_t** buffer_lookup;
+	render_index_table_t buffer_table;
 	id<MTLBuffer> buffer_storage;
 	id<MTLArgumentEncoder> buffer_encoder;
-	uint* buffer_free;
-	uint buffer_count;
+	//! Serializes writes through the buffer argument encoder and growth of the argument buffer
+	mutex_t* buffer_lock;
 	uint buffer_capacity;
 
 	id<MTLDepthStencilState> depth_state;
@@ -121,15 +119,57 @@ rb_metal_destruct(render_backend_t* backend) {
 	array_deallocate(backend_metal->pipeline_state);
 	array_deallocate(backend_metal->pipeline_state_free);
 
-	array_deallocate(backend_metal->buffer_free);
-	array_deallocate(backend_metal->buffer_array);
-	array_deallocate(backend_metal->buffer_lookup);
+	render_index_table_finalize(&backend_metal->buffer_table);
 
 	mutex_deallocate(backend_metal->buffer_lock);
 
 	log_info(HASH_RENDER, STRING_CONST("Destructed metal render backend"));
 }
 
+/*! Allocate the argument buffer of buffer objects with the given capacity and encode all live
+    buffers into it, replacing the current argument buffer. Called with the buffer lock held
+    once constructed */
+static bool
+rb_metal_buffer_storage_allocate(render_backend_metal_t* backend_metal, uint capacity) {
+	@autoreleasepool {
+		NSMutableArray<MTLArgumentDescriptor*>* argument_descriptor_array = [[NSMutableArray alloc] init];
+		for (uint idx = 0; idx < capacity; ++idx) {
+			MTLArgumentDescriptor* argument_descriptor = [MTLArgumentDescriptor argumentDescriptor];
+			argument_descriptor.index = idx;
+			argument_descriptor.dataType = MTLDataTypePointer;
+			argument_descriptor.access = MTLArgumentAccessReadOnly;
+			[argument_descriptor_array addObject:argument_descriptor];
+		}
+
+		id<MTLArgumentEncoder> buffer_encoder =
+		    [backend_metal->device newArgumentEncoderWithArguments:argument_descriptor_array];
+		id<MTLBuffer> buffer_storage = [backend_metal->device newBufferWithLength:capacity * sizeof(void*)
+		                                                                  options:MTLResourceStorageModeShared];
+		if (!buffer_encoder || !buffer_storage) {
+			log_errorf(HASH_RENDER, ERROR_OUT_OF_MEMORY,
+			           STRING_CONST("Unable to allocate Metal argument buffer for %u render buffers"), capacity);
+			return false;
+		}
+		buffer_storage.label = @"Buffer storage";
+		[buffer_encoder setArgumentBuffer:buffer_storage offset:0];
+
+		// Buffers still being allocated have no Metal buffer yet and encode themselves once they do
+		uint buffer_count = render_index_table_count(&backend_metal->buffer_table);
+		for (uint ibuf = 1; ibuf < buffer_count; ++ibuf) {
+			render_buffer_t* buffer = render_index_table_lookup(&backend_metal->buffer_table, ibuf);
+			if (buffer && (buffer->render_index == ibuf) && buffer->backend_data[0])
+				[buffer_encoder setBuffer:(__bridge id<MTLBuffer>)((void*)buffer->backend_data[0])
+				                   offset:0
+				                  atIndex:ibuf];
+		}
+
+		backend_metal->buffer_storage = buffer_storage;
+		backend_metal->buffer_encoder = buffer_encoder;
+		backend_metal->buffer_capacity = capacity;
+	}
+	return true;
+}
+
 static bool
 rb_metal_construct(render_backend_t* backend) {
 	render_backend_metal_t* backend_metal = (render_backend_metal_t*)backend;
@@ -168,35 +208,16 @@ rb_metal_construct(render_backend_t* backend) {
 
 	backend_metal->buffer_lock = mutex_allocate(STRING_CONST("Buffer store"));
 
-	backend_metal->buffer_count = 1;
-	backend_metal->buffer_capacity = 32 * 1024;
-	array_reserve(backend_metal->buffer_free, backend_metal->buffer_capacity);
-
-	size_t buffer_size = backend_metal->buffer_capacity * sizeof(void*);
-	backend_metal->buffer_storage = [backend_metal->device newBufferWithLength:buffer_size
-	                                                                   options:MTLResourceStorageModeShared];
-	backend_metal->buffer_storage.label = @"Buffer storage";
-	array_resize(backend_metal->buffer_array, backend_metal->buffer_capacity);
-	array_resize(backend_metal->buffer_lookup, backend_metal->buffer_capacity);
-
-	backend_metal->buffer_array[0] = 0;
-	backend_metal->buffer_lookup[0] = 0;
+	// Argument buffer of buffer objects starts at a fixed size and is reallocated when the render
+	// index table grows past it
+	render_index_table_initialize(&backend_metal->buffer_table, 0);
+	if (!rb_metal_buffer_storage_allocate(backend_metal, 32 * 1024)) {
+		rb_metal_destruct(backend);
+		return false;
+	}
 
 	@autoreleasepool {
 		NSMutableArray<MTLArgumentDescriptor*>* argument_descriptor_array = [[NSMutableArray alloc] init];
-		for (uint idx = 0; idx < backend_metal->buffer_capacity; ++idx) {
-			MTLArgumentDescriptor* argument_descriptor = [MTLArgumentDescriptor argumentDescriptor];
-			argument_descriptor.index = idx;
-			argument_descriptor.dataType = MTLDataTypePointer;
-			argument_descriptor.access = MTLArgumentAccessReadOnly;
-			[argument_descriptor_array addObject:argument_descriptor];
-		}
-
-		backend_metal->buffer_encoder =
-		    [backend_metal->device newArgumentEncoderWithArguments:argument_descriptor_array];
-		[backend_metal->buffer_encoder setArgumentBuffer:backend_metal->buffer_storage offset:0];
-
-		argument_descriptor_array = [[NSMutableArray alloc] init];
 		for (uint idx = 0; idx < array_capacity(backend_metal->pipeline_state); ++idx) {
 			MTLArgumentDescriptor* argument_descriptor = [MTLArgumentDescriptor argumentDescriptor];
 			argument_descriptor.index = idx;
@@ -208,7 +229,7 @@ rb_metal_construct(render_backend_t* backend) {
 		backend_metal->pipeline_state_encoder =
 		    [backend_metal->device newArgumentEncoderWithArguments:argument_descriptor_array];
 
-		buffer_size = backend_metal->pipeline_state_encoder.encodedLength;
+		size_t buffer_size = backend_metal->pipeline_state_encoder.encodedLength;
 		backend_metal->pipeline_state_storage =
 		    [backend_metal->device newBufferWithLength:buffer_size options:MTLResourceStorageModeShared];
 		backend_metal->pipeline_state_storage.label = @"Pipeline state storage";
@@ -378,6 +399,14 @@ rb_metal_target_deallocate(render_backend_t* backend, render_target_t* target) {
 	memory_deallocate(target);
 }
 
+static bool
+rb_metal_target_read_pixels(render_backend_t* backend, render_target_t* target, const render_rect_t* rect, void* dst,
+                            render_target_read_fn callback, void* context) {
+	FOUNDATION_UNUSED(backend, target, rect, dst, callback, context);
+	log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Metal backend does not support reading target pixels"));
+	return false;
+}
+
 static render_pipeline_t*
 rb_metal_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
 	render_backend_metal_t* backend_metal = (render_backend_metal_t*)backend;
@@ -536,13 +565,14 @@ rb_metal_pipeline_set_depth_clear(render_backend_t* backend, render_pipeline_t*
 static inline id<MTLBuffer>
 rb_metal_buffer_from_index(render_backend_metal_t* backend, uint index) {
 #if BUILD_DEBUG
-	render_buffer_t* buffer = backend->buffer_lookup[index];
-	if (index && (buffer->render_index != index)) {
+	render_buffer_t* buffer = render_index_table_lookup(&backend->buffer_table, index);
+	if (index && (!buffer || (buffer->render_index != index))) {
 		log_errorf(0, ERROR_INVALID_VALUE, STRING_CONST("Invalid buffer render index for buffer %u"), index);
 		return 0;
 	}
 #endif
-	return (__bridge id<MTLBuffer>)((void*)backend->buffer_array[index]);
+	render_buffer_t* buffer = render_index_table_lookup(&backend->buffer_table, index);
+	return buffer ? (__bridge id<MTLBuffer>)((void*)buffer->backend_data[0]) : nil;
 }
 
 static inline id<MTLRenderPipelineState>
@@ -584,15 +614,15 @@ rb_metal_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline)
 	id<MTLBuffer> descriptor_buffer[4];
 
 #if BUILD_DEBUG
-	mutex_lock(backend_metal->buffer_lock);
-	for (uint ibuf = 1; ibuf < backend_metal->buffer_count; ++ibuf) {
-		if (backend_metal->buffer_lookup[ibuf] && (backend_metal->buffer_lookup[ibuf]->render_index != ibuf)) {
+	uint buffer_count = render_index_table_count(&backend_metal->buffer_table);
+	for (uint ibuf = 1; ibuf < buffer_count; ++ibuf) {
+		render_buffer_t* buffer = render_index_table_lookup(&backend_metal->buffer_table, ibuf);
+		if (buffer && (buffer->render_index != ibuf)) {
 			log_errorf(0, ERROR_INVALID_VALUE, STRING_CONST("Buffer render index mismatch when flushing: %u %u"), ibuf,
-			           backend_metal->buffer_lookup[ibuf]->render_index);
+			           buffer->render_index);
 			exception_raise_abort();
 		}
 	}
-	mutex_unlock(backend_metal->buffer_lock);
 #endif
 
 	@autoreleasepool {
@@ -708,60 +738,73 @@ rb_metal_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline)
 			[render_encoder useResource:buffer usage:MTLResourceUsageRead];
 		}
 
-		render_buffer_lock(pipeline->primitive_buffer, RENDERBUFFER_LOCK_READ);
-		render_primitive_t* primitives = pipeline->primitive_buffer->access;
-		render_pipeline_state_t current_state = 0;
-		render_buffer_index_t current_argument = 0;
+		// Consume the delta command stream, bindings are only set when changed
+		MTLIndexType index_type =
+		    (pipeline->index_format == RENDER_INDEXFORMAT_UINT16) ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32;
 		render_buffer_t* argument_buffer = 0;
-		size_t primitive_count = pipeline->primitive_buffer->used;
-		for (size_t iprim = 0; iprim < primitive_count; ++iprim) {
-			render_primitive_t* primitive = primitives + iprim;
-			if (primitive->pipeline_state != current_state) {
-				current_state = primitive->pipeline_state;
-				id<MTLRenderPipelineState> pipeline_state =
-				    rb_metal_pipeline_state_from_index(backend_metal, current_state);
-				[render_encoder setRenderPipelineState:pipeline_state];
-			}
-			if (primitive->argument_buffer != current_argument) {
-				if (argument_buffer)
-					render_buffer_unlock(argument_buffer);
-				current_argument = primitive->argument_buffer;
-				argument_buffer = backend_metal->buffer_lookup[current_argument];
-				FOUNDATION_ASSERT(argument_buffer);
-				render_buffer_lock(argument_buffer, RENDERBUFFER_LOCK_READ);
+		id<MTLBuffer> index_buffer = nil;
+		uint instance_count = 0;
+		render_pipeline_counters_t* statistics = &pipeline->statistics_frame;
+		const render_command_t* command = pipeline->command.command;
+		for (uint icmd = 0, cmdcount = pipeline->command.count; icmd < cmdcount; ++icmd, ++command) {
+			switch (command->type) {
+				case RENDERCOMMAND_BIND_STATE: {
+					id<MTLRenderPipelineState> pipeline_state =
+					    rb_metal_pipeline_state_from_index(backend_metal, command->value);
+					[render_encoder setRenderPipelineState:pipeline_state];
+					++statistics->state_switches;
+					break;
+				}
+				case RENDERCOMMAND_BIND_ARGUMENT:
+					if (argument_buffer)
+						render_buffer_unlock(argument_buffer);
+					argument_buffer = render_index_table_lookup(&backend_metal->buffer_table, command->value);
+					FOUNDATION_ASSERT(argument_buffer);
+					render_buffer_lock(argument_buffer, RENDERBUFFER_LOCK_READ);
+					++statistics->argument_switches;
+					break;
+				case RENDERCOMMAND_BIND_DESCRIPTOR:
+					descriptor_buffer[command->slot] = rb_metal_buffer_from_index(backend_metal, command->value);
+					[render_encoder setVertexBuffer:descriptor_buffer[command->slot] offset:0 atIndex:command->slot];
+					++statistics->descriptor_rebinds;
+					break;
+				case RENDERCOMMAND_BIND_INDEX:
+					index_buffer = rb_metal_buffer_from_index(backend_metal, command->value);
+					break;
+				case RENDERCOMMAND_INSTANCE_COUNT:
+					instance_count = command->value;
+					break;
+				case RENDERCOMMAND_DRAW: {
+					render_argument_t* argument =
+					    (render_argument_t*)pointer_offset(argument_buffer->access, command->value);
+					[render_encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+					                           indexCount:argument->index_count
+					                            indexType:index_type
+					                          indexBuffer:index_buffer
+					                    indexBufferOffset:argument->index_offset
+					                        instanceCount:instance_count ? instance_count : argument->instance_count
+					                           baseVertex:argument->vertex_base
+					                         baseInstance:argument->instance_base];
+					instance_count = 0;
+					++statistics->draws;
+					break;
+				}
+				default:
+					break;
 			}
-
-			descriptor_buffer[0] = rb_metal_buffer_from_index(backend_metal, primitive->descriptor[0]);
-			descriptor_buffer[1] = rb_metal_buffer_from_index(backend_metal, primitive->descriptor[1]);
-			descriptor_buffer[2] = rb_metal_buffer_from_index(backend_metal, primitive->descriptor[2]);
-			descriptor_buffer[3] = rb_metal_buffer_from_index(backend_metal, primitive->descriptor[3]);
-
-			[render_encoder setVertexBuffer:descriptor_buffer[0] offset:0 atIndex:0];
-			[render_encoder setVertexBuffer:descriptor_buffer[1] offset:0 atIndex:1];
-			[render_encoder setVertexBuffer:descriptor_buffer[2] offset:0 atIndex:2];
-			[render_encoder setVertexBuffer:descriptor_buffer[3] offset:0 atIndex:3];
-
-			render_argument_t* argument =
-			    (render_argument_t*)pointer_offset(argument_buffer->access, primitive->argument_offset);
-			MTLIndexType index_type =
-			    (pipeline->index_format == RENDER_INDEXFORMAT_UINT16) ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32;
-			id<MTLBuffer> index_buffer = rb_metal_buffer_from_index(backend_metal, primitive->index_buffer);
-			[render_encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
-			                           indexCount:argument->index_count
-			                            indexType:index_type
-			                          indexBuffer:index_buffer
-			                    indexBufferOffset:argument->index_offset
-			                        instanceCount:argument->instance_count
-			                           baseVertex:argument->vertex_base
-			                         baseInstance:argument->instance_base];
 		}
 		if (argument_buffer)
 			render_buffer_unlock(argument_buffer);
-		render_buffer_unlock(pipeline->primitive_buffer);
 
 		[render_encoder endEncoding];
 
 #endif
+		const uint frame = pipeline->frame_current;
+		[command_buffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+		  FOUNDATION_UNUSED(buffer);
+		  render_pipeline_frame_signal(pipeline, frame);
+		}];
+
 		[command_buffer presentDrawable:current_drawable afterMinimumDuration:0.008333];
 		[command_buffer commit];
 
@@ -781,6 +824,13 @@ rb_metal_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline)
 	array_clear(pipeline_metal->render_buffer_used);
 }
 
+static void
+rb_metal_pipeline_wait(render_backend_t* backend, render_pipeline_t* pipeline, uint frame) {
+	FOUNDATION_UNUSED(backend);
+	while (atomic_load32(&pipeline->frame[frame].fence, memory_order_acquire))
+		thread_yield();
+}
+
 static render_pipeline_state_t
 rb_metal_pipeline_state_allocate(render_backend_t* backend, render_pipeline_t* pipeline, render_shader_t* shader) {
 	render_backend_metal_t* backend_metal = (render_backend_metal_t*)backend;
@@ -970,47 +1020,24 @@ rb_metal_buffer_allocate(render_backend_t* backend, render_buffer_t* buffer, siz
 		if (metal_buffer) {
 			uintptr_t buffer_handle = (uintptr_t)((__bridge_retained void*)metal_buffer);
 			if ((buffer->usage & RENDERUSAGE_RENDER) && (!buffer->render_index)) {
-				mutex_lock(backend_metal->buffer_lock);
-
-				uint render_index = 0;
-				uint buffer_free_count = array_count(backend_metal->buffer_free);
-				if (buffer_free_count) {
-					render_index = backend_metal->buffer_free[buffer_free_count - 1];
-					array_pop(backend_metal->buffer_free);
-				} else {
-					if (backend_metal->buffer_count >= backend_metal->buffer_capacity) {
-						// TODO: Reallocate storage
-						log_error(HASH_RENDER, ERROR_OUT_OF_MEMORY,
-						          STRING_CONST("Unable to allocate more render buffers"));
-					} else {
-						render_index = backend_metal->buffer_count++;
-					}
-				}
+				uint render_index = render_index_table_allocate(&backend_metal->buffer_table, buffer);
 				buffer->render_index = render_index;
 
 				if (render_index) {
-					// Store the buffer in the array of buffers
-					[backend_metal->buffer_encoder setBuffer:metal_buffer offset:0 atIndex:render_index];
-					backend_metal->buffer_array[render_index] = buffer_handle;
-					backend_metal->buffer_lookup[render_index] = buffer;
-				} else {
-					log_error(HASH_RENDER, ERROR_INVALID_VALUE, STRING_CONST("Failed to get buffer render index"));
-					exception_raise_abort();
-				}
-
-#if BUILD_DEBUG
-				for (uint ibuf = 1; ibuf < backend_metal->buffer_count; ++ibuf) {
-					if (backend_metal->buffer_lookup[ibuf] &&
-					    (backend_metal->buffer_lookup[ibuf]->render_index != ibuf)) {
-						log_errorf(0, ERROR_INVALID_VALUE,
-						           STRING_CONST("Buffer render index mismatch after creating buffer %u: %u %u"),
-						           render_index, ibuf, backend_metal->buffer_lookup[ibuf]->render_index);
-						exception_raise_abort();
+					// Store the buffer in the array of buffers, growing it to double size when full
+					mutex_lock(backend_metal->buffer_lock);
+					uint capacity = backend_metal->buffer_capacity;
+					while (capacity <= render_index)
+						capacity *= 2;
+					if ((capacity == backend_metal->buffer_capacity) ||
+					    rb_metal_buffer_storage_allocate(backend_metal, capacity)) {
+						[backend_metal->buffer_encoder setBuffer:metal_buffer offset:0 atIndex:render_index];
+					} else {
+						render_index_table_free(&backend_metal->buffer_table, render_index);
+						buffer->render_index = 0;
 					}
+					mutex_unlock(backend_metal->buffer_lock);
 				}
-#endif
-
-				mutex_unlock(backend_metal->buffer_lock);
 			}
 			buffer->backend_data[0] = buffer_handle;
 		}
@@ -1027,6 +1054,17 @@ rb_metal_buffer_deallocate(render_backend_t* backend, render_buffer_t* buffer, b
 	}
 
 	if (gpu) {
+		// Release the render index first, under the buffer lock so a concurrent growth of the
+		// argument buffer does not encode a released Metal buffer
+		uint render_index = buffer->render_index;
+		buffer->render_index = 0;
+
+		if (render_index) {
+			mutex_lock(backend_metal->buffer_lock);
+			render_index_table_free(&backend_metal->buffer_table, render_index);
+			mutex_unlock(backend_metal->buffer_lock);
+		}
+
 		if (buffer->backend_data[0]) {
 			rb_metal_release_metal_buffer(buffer->backend_data[0]);
 			buffer->backend_data[0] = 0;
@@ -1036,20 +1074,15 @@ rb_metal_buffer_deallocate(render_backend_t* backend, render_buffer_t* buffer, b
 			rb_metal_release_metal_argument_encoder(buffer->backend_data[1]);
 			buffer->backend_data[1] = 0;
 		}
-
-		uint render_index = buffer->render_index;
-		buffer->render_index = 0;
-
-		if (render_index) {
-			backend_metal->buffer_lookup[render_index] = 0;
-
-			mutex_lock(backend_metal->buffer_lock);
-			array_push(backend_metal->buffer_free, render_index);
-			mutex_unlock(backend_metal->buffer_lock);
-		}
 	}
 }
 
+static render_buffer_t*
+rb_metal_buffer_lookup(render_backend_t* backend, render_buffer_index_t index) {
+	render_backend_metal_t* backend_metal = (render_backend_metal_t*)backend;
+	return render_index_table_lookup(&backend_metal->buffer_table, index);
+}
+
 static void
 rb_metal_buffer_upload(render_backend_t* backend, render_buffer_t* buffer, size_t offset, size_t size) {
 	FOUNDATION_UNUSED(backend);
@@ -1185,6 +1218,53 @@ rb_metal_buffer_data_encode_constant(render_backend_t* backend, render_buffer_t*
 	}
 }
 
+static void*
+rb_metal_buffer_data_encode_range(render_buffer_t* buffer, uint first_instance, uint count, uint index,
+                                  size_t* instance_size) {
+	if (!buffer->backend_data[1]) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE,
+		          STRING_CONST("Unable to encode buffer structured data without previous data layout declaration"));
+		return 0;
+	}
+
+	id<MTLArgumentEncoder> encoder = (__bridge id<MTLArgumentEncoder>)((void*)buffer->backend_data[1]);
+	id<MTLBuffer> metal_buffer = (__bridge id<MTLBuffer>)((void*)buffer->backend_data[0]);
+	*instance_size = [encoder encodedLength];
+	if ((first_instance + count) * (*instance_size) > metal_buffer.length) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE,
+		          STRING_CONST("Buffer structured data instance range out of bounds"));
+		return 0;
+	}
+
+	// Locate the argument in the first instance once, remaining instances are at a fixed stride
+	[encoder setArgumentBuffer:metal_buffer offset:first_instance * (*instance_size)];
+	return [encoder constantDataAtIndex:index];
+}
+
+static void
+rb_metal_buffer_data_encode_matrix_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                         uint count, uint index, const matrix_t* matrices) {
+	FOUNDATION_UNUSED(backend);
+	if (!count)
+		return;
+	size_t instance_size = 0;
+	void* buffer_data = rb_metal_buffer_data_encode_range(buffer, first_instance, count, index, &instance_size);
+	if (buffer_data)
+		render_buffer_data_store_matrix(buffer_data, instance_size, matrices, count);
+}
+
+static void
+rb_metal_buffer_data_encode_constant_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                           uint count, uint index, const void* data, uint size) {
+	FOUNDATION_UNUSED(backend);
+	if (!count)
+		return;
+	size_t instance_size = 0;
+	void* buffer_data = rb_metal_buffer_data_encode_range(buffer, first_instance, count, index, &instance_size);
+	if (buffer_data)
+		render_buffer_data_store_constant(buffer_data, instance_size, data, size, size, count);
+}
+
 static render_backend_vtable_t render_backend_vtable_metal = {
     .construct = rb_metal_construct,
     .destruct = rb_metal_destruct,
@@ -1193,6 +1273,7 @@ static render_backend_vtable_t render_backend_vtable_metal = {
     .target_window_allocate = rb_metal_target_window_allocate,
     .target_texture_allocate = rb_metal_target_texture_allocate,
     .target_deallocate = rb_metal_target_deallocate,
+    .target_read_pixels = rb_metal_target_read_pixels,
     .pipeline_allocate = rb_metal_pipeline_allocate,
     .pipeline_deallocate = rb_metal_pipeline_deallocate,
     .pipeline_set_color_attachment = rb_metal_pipeline_set_color_attachment,
@@ -1201,6 +1282,7 @@ static render_backend_vtable_t render_backend_vtable_metal = {
     .pipeline_set_depth_clear = rb_metal_pipeline_set_depth_clear,
     .pipeline_build = rb_metal_pipeline_build,
     .pipeline_flush = rb_metal_pipeline_flush,
+    .pipeline_wait = rb_metal_pipeline_wait,
     .pipeline_use_argument_buffer = rb_metal_pipeline_use_argument_buffer,
     .pipeline_use_render_buffer = rb_metal_pipeline_use_render_buffer,
     .pipeline_state_allocate = rb_metal_pipeline_state_allocate,
@@ -1211,10 +1293,14 @@ static render_backend_vtable_t render_backend_vtable_metal = {
     .buffer_deallocate = rb_metal_buffer_deallocate,
     .buffer_upload = rb_metal_buffer_upload,
     .buffer_set_label = rb_metal_buffer_set_label,
+    .buffer_lookup = rb_metal_buffer_lookup,
     .buffer_data_declare = rb_metal_buffer_data_declare,
     .buffer_data_encode_buffer = rb_metal_buffer_data_encode_buffer,
     .buffer_data_encode_matrix = rb_metal_buffer_data_encode_matrix,
-    .buffer_data_encode_constant = rb_metal_buffer_data_encode_constant};
+    .buffer_data_encode_constant = rb_metal_buffer_data_encode_constant,
+    .buffer_data_encode_matrix_array = rb_metal_buffer_data_encode_matrix_array,
+    .buffer_data_encode_constant_array = rb_metal_buffer_data_encode_constant_array,
+    .command_stream = true};
 
 render_backend_t*
 render_backend_metal_allocate(void) {
@@ -23,16 +23,34 @@
 
 #include <render/null/backend.h>
 
+typedef struct render_backend_null_t {
+	render_backend_t backend;
+	//! Simulated device latency in milliseconds for frames in flight
+	uint latency;
+	//! Render index table of render buffers, index 0 is reserved
+	render_index_table_t buffer_table;
+	//! Storage of target and pipeline objects
+	render_slab_t target_slab;
+	render_slab_t pipeline_slab;
+} render_backend_null_t;
+
 static bool
 rb_null_construct(render_backend_t* backend) {
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
 	backend->shader_type = HASH_SHADER;
+	render_index_table_initialize(&backend_null->buffer_table, 0);
+	render_slab_initialize(&backend_null->target_slab, sizeof(render_target_t));
+	render_slab_initialize(&backend_null->pipeline_slab, sizeof(render_pipeline_t));
 	log_debug(HASH_RENDER, STRING_CONST("Constructed NULL render backend"));
 	return true;
 }
 
 static void
 rb_null_destruct(render_backend_t* backend) {
-	FOUNDATION_UNUSED(backend);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	render_index_table_finalize(&backend_null->buffer_table);
+	render_slab_finalize(&backend_null->target_slab);
+	render_slab_finalize(&backend_null->pipeline_slab);
 	log_debug(HASH_RENDER, STRING_CONST("Destructed NULL render backend"));
 }
 
@@ -58,41 +76,66 @@ rb_null_enumerate_modes(render_backend_t* backend, unsigned int adapter, render_
 static render_target_t*
 rb_null_target_window_allocate(render_backend_t* backend, window_t* window, uint tag) {
 	FOUNDATION_UNUSED(tag);
-	render_target_t* target =
-	    memory_allocate(HASH_RENDER, sizeof(render_target_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	render_handle_t handle;
+	render_target_t* target = render_slab_allocate(&backend_null->target_slab, &handle);
+	if (!target)
+		return nullptr;
 	target->backend = backend;
+	target->handle = handle;
 	target->width = window_width(window);
 	target->height = window_height(window);
 	target->type = RENDERTARGET_WINDOW;
 	target->pixelformat = PIXELFORMAT_R8G8B8A8;
 	target->colorspace = COLORSPACE_sRGB;
+	render_target_storage_allocate(target);
 	return target;
 }
 
 static render_target_t*
 rb_null_target_texture_allocate(render_backend_t* backend, uint width, uint height, render_pixelformat_t format) {
-	render_target_t* target =
-	    memory_allocate(HASH_RENDER, sizeof(render_target_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	render_handle_t handle;
+	render_target_t* target = render_slab_allocate(&backend_null->target_slab, &handle);
+	if (!target)
+		return nullptr;
 	target->backend = backend;
+	target->handle = handle;
 	target->width = width;
 	target->height = height;
 	target->type = RENDERTARGET_TEXTURE;
 	target->pixelformat = format;
 	target->colorspace = COLORSPACE_sRGB;
+	render_target_storage_allocate(target);
 	return target;
 }
 
 static void
 rb_null_target_deallocate(render_backend_t* backend, render_target_t* target) {
-	FOUNDATION_UNUSED(backend);
-	memory_deallocate(target);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	if (target) {
+		render_target_storage_deallocate(target);
+		render_slab_free(&backend_null->target_slab, target->handle);
+	}
+}
+
+static bool
+rb_null_target_read_pixels(render_backend_t* backend, render_target_t* target, const render_rect_t* rect, void* dst,
+                           render_target_read_fn callback, void* context) {
+	// Targets with CPU storage are read directly, only reached for targets without storage
+	FOUNDATION_UNUSED(backend, target, rect, dst, callback, context);
+	return false;
 }
 
 static render_pipeline_t*
 rb_null_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
-	render_pipeline_t* pipeline =
-	    memory_allocate(HASH_RENDER, sizeof(render_pipeline_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	render_handle_t handle;
+	render_pipeline_t* pipeline = render_slab_allocate(&backend_null->pipeline_slab, &handle);
+	if (!pipeline)
+		return nullptr;
 	pipeline->backend = backend;
+	pipeline->handle = handle;
 	pipeline->primitive_buffer =
 	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(render_primitive_t) * capacity, 0, 0);
 	pipeline->index_format = index_format;
@@ -101,10 +144,11 @@ rb_null_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_
 
 static void
 rb_null_pipeline_deallocate(render_backend_t* backend, render_pipeline_t* pipeline) {
-	FOUNDATION_UNUSED(backend);
-	if (pipeline)
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	if (pipeline) {
 		render_buffer_deallocate(pipeline->primitive_buffer);
-	memory_deallocate(pipeline);
+		render_slab_free(&backend_null->pipeline_slab, pipeline->handle);
+	}
 }
 
 static void
@@ -140,7 +184,20 @@ rb_null_pipeline_build(render_backend_t* backend, render_pipeline_t* pipeline) {
 
 static void
 rb_null_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline) {
-	FOUNDATION_UNUSED(backend, pipeline);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	render_pipeline_statistics_encoded(pipeline);
+	// Without simulated latency the frame is consumed immediately
+	if (!backend_null->latency)
+		render_pipeline_frame_signal(pipeline, pipeline->frame_current);
+}
+
+static void
+rb_null_pipeline_wait(render_backend_t* backend, render_pipeline_t* pipeline, uint frame) {
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	tick_t latency = (time_ticks_per_second() * (tick_t)backend_null->latency) / 1000;
+	tick_t deadline = pipeline->frame[frame].submit + latency;
+	for (tick_t current = time_current(); current < deadline; current = time_current())
+		thread_sleep((uint)(time_ticks_to_seconds(deadline - current) * REAL_C(1000.0)));
 }
 
 static void
@@ -180,7 +237,9 @@ rb_null_shader_finalize(render_backend_t* backend, render_shader_t* shader) {
 static void
 rb_null_buffer_allocate(render_backend_t* backend, render_buffer_t* buffer, size_t buffer_size, const void* data,
                         size_t data_size) {
-	FOUNDATION_UNUSED(backend);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	if ((buffer->usage & RENDERUSAGE_RENDER) && !buffer->render_index)
+		buffer->render_index = render_index_table_allocate(&backend_null->buffer_table, buffer);
 	if (buffer->usage == RENDERUSAGE_GPUONLY)
 		return;
 	buffer->store = memory_allocate(HASH_RENDER, buffer_size, 0, MEMORY_PERSISTENT);
@@ -193,11 +252,21 @@ rb_null_buffer_allocate(render_backend_t* backend, render_buffer_t* buffer, size
 
 static void
 rb_null_buffer_deallocate(render_backend_t* backend, render_buffer_t* buffer, bool cpu, bool gpu) {
-	FOUNDATION_UNUSED(backend, gpu);
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
 	if (cpu && buffer->store) {
 		memory_deallocate(buffer->store);
 		buffer->store = nullptr;
 	}
+	if (gpu && buffer->render_index) {
+		render_index_table_free(&backend_null->buffer_table, buffer->render_index);
+		buffer->render_index = 0;
+	}
+}
+
+static render_buffer_t*
+rb_null_buffer_lookup(render_backend_t* backend, render_buffer_index_t index) {
+	render_backend_null_t* backend_null = (render_backend_null_t*)backend;
+	return render_index_table_lookup(&backend_null->buffer_table, index);
 }
 
 static void
@@ -208,25 +277,44 @@ rb_null_buffer_upload(render_backend_t* backend, render_buffer_t* buffer, size_t
 static void
 rb_null_buffer_data_declare(render_backend_t* backend, render_buffer_t* buffer, size_t instance_count,
                             const render_buffer_data_t* data, size_t data_count) {
-	FOUNDATION_UNUSED(backend, buffer, data, data_count, instance_count);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_declare(buffer, instance_count, data, data_count, RENDERLAYOUT_STD140);
 }
 
 static void
 rb_null_buffer_data_encode_buffer(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                   render_buffer_t* source, uint offset) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, source, offset);
+	FOUNDATION_UNUSED(backend);
+	// No GPU addresses, encode the render index and offset of the source buffer
+	render_buffer_layout_encode_pointer(buffer, instance, index, ((uint64_t)source->render_index << 32) | offset);
 }
 
 static void
 rb_null_buffer_data_encode_constant(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                     const void* data, uint size) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, data, size);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_constant(buffer, instance, 1, index, data, size);
 }
 
 static void
 rb_null_buffer_data_encode_matrix(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                   const matrix_t* matrix) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, matrix);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_matrix(buffer, instance, 1, index, matrix);
+}
+
+static void
+rb_null_buffer_data_encode_matrix_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                        uint count, uint index, const matrix_t* matrices) {
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_matrix(buffer, first_instance, count, index, matrices);
+}
+
+static void
+rb_null_buffer_data_encode_constant_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                          uint count, uint index, const void* data, uint size) {
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_constant(buffer, first_instance, count, index, data, size);
 }
 
 static void
@@ -242,6 +330,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .target_window_allocate = rb_null_target_window_allocate,
     .target_texture_allocate = rb_null_target_texture_allocate,
     .target_deallocate = rb_null_target_deallocate,
+    .target_read_pixels = rb_null_target_read_pixels,
     .pipeline_allocate = rb_null_pipeline_allocate,
     .pipeline_deallocate = rb_null_pipeline_deallocate,
     .pipeline_set_color_attachment = rb_null_pipeline_set_color_attachment,
@@ -250,6 +339,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .pipeline_set_depth_clear = rb_null_pipeline_set_depth_clear,
     .pipeline_build = rb_null_pipeline_build,
     .pipeline_flush = rb_null_pipeline_flush,
+    .pipeline_wait = rb_null_pipeline_wait,
     .pipeline_use_argument_buffer = rb_null_pipeline_use_argument_buffer,
     .pipeline_use_render_buffer = rb_null_pipeline_use_render_buffer,
     .pipeline_state_allocate = rb_null_pipeline_state_allocate,
@@ -260,17 +350,27 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .buffer_deallocate = rb_null_buffer_deallocate,
     .buffer_upload = rb_null_buffer_upload,
     .buffer_set_label = rb_null_buffer_set_label,
+    .buffer_lookup = rb_null_buffer_lookup,
     .buffer_data_declare = rb_null_buffer_data_declare,
     .buffer_data_encode_buffer = rb_null_buffer_data_encode_buffer,
     .buffer_data_encode_matrix = rb_null_buffer_data_encode_matrix,
-    .buffer_data_encode_constant = rb_null_buffer_data_encode_constant};
+    .buffer_data_encode_constant = rb_null_buffer_data_encode_constant,
+    .buffer_data_encode_matrix_array = rb_null_buffer_data_encode_matrix_array,
+    .buffer_data_encode_constant_array = rb_null_buffer_data_encode_constant_array,
+    .command_stream = true};
 
 render_backend_t*
 render_backend_null_allocate(void) {
 	render_backend_t* backend =
-	    memory_allocate(HASH_RENDER, sizeof(render_backend_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	    memory_allocate(HASH_RENDER, sizeof(render_backend_null_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
 	backend->api = RENDERAPI_NULL;
 	backend->api_group = RENDERAPIGROUP_NONE;
 	backend->vtable = render_backend_vtable_null;
 	return backend;
 }
+
+void
+render_backend_null_set_latency(render_backend_t* backend, uint milliseconds) {
+	if (backend && (backend->api == RENDERAPI_NULL))
+		((render_backend_null_t*)backend)->latency = milliseconds;
+}
@@ -25,3 +25,10 @@
 
 RENDER_API render_backend_t*
 render_backend_null_allocate(void);
+
+/*! Set simulated device latency of the null backend. Frames flushed by pipelines are kept in flight
+    until the latency has passed, to measure overlap of frames in flight
+    \param backend Null backend
+    \param milliseconds Latency in milliseconds, 0 to consume frames immediately */
+RENDER_API void
+render_backend_null_set_latency(render_backend_t* backend, uint milliseconds);
@@ -18,22 +18,105 @@
 
 #include <render/pipeline.h>
 #include <render/backend.h>
+#include <render/buffer.h>
+#include <render/command.h>
+#include <render/indirect.h>
+#include <render/ring.h>
+#include <render/upload.h>
 #include <render/hashstrings.h>
+#include <render/internal.h>
 
 #include <foundation/array.h>
 #include <foundation/atomic.h>
+#include <foundation/memory.h>
+#include <foundation/time.h>
 
 #include <task/task.h>
 
+//! Primitive chunk currently being filled by a thread
+typedef struct render_pipeline_thread_chunk_t {
+	render_pipeline_t* pipeline;
+	uint32_t generation;
+	uint used;
+	uint size;
+	render_primitive_t* store;
+	render_pipeline_chunk_t* fill;
+} render_pipeline_thread_chunk_t;
+
+FOUNDATION_DECLARE_THREAD_LOCAL_ARRAY(render_pipeline_thread_chunk_t, pipeline_chunk,
+                                      RENDER_PIPELINE_THREAD_CHUNK_COUNT)
+
+static atomic32_t render_pipeline_generation;
+
+//! Recording work item dispatched to the task scheduler
+typedef struct render_pipeline_record_t {
+	render_pipeline_t* pipeline;
+	render_pipeline_record_fn function;
+	void* context;
+} render_pipeline_record_t;
+
 render_pipeline_t*
 render_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
-	return backend->vtable.pipeline_allocate(backend, index_format, capacity);
+	render_pipeline_t* pipeline = backend->vtable.pipeline_allocate(backend, index_format, capacity);
+	if (!pipeline)
+		return nullptr;
+
+	pipeline->primitive_capacity =
+	    pipeline->primitive_buffer ? (uint)(pipeline->primitive_buffer->allocated / sizeof(render_primitive_t)) : 0;
+	pipeline->primitive_chunk_count =
+	    (pipeline->primitive_capacity + (RENDER_PIPELINE_CHUNK_SIZE - 1)) / RENDER_PIPELINE_CHUNK_SIZE;
+	if (pipeline->primitive_chunk_count)
+		pipeline->primitive_chunk =
+		    memory_allocate(HASH_RENDER, sizeof(render_pipeline_chunk_t) * pipeline->primitive_chunk_count, 64,
+		                    MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	pipeline->generation = (uint32_t)atomic_incr32(&render_pipeline_generation, memory_order_relaxed);
+	// Counts as flushed in the current backend frame, so a first flush completes it
+	pipeline->backend_frame = backend->framecount;
+	atomic_store32(&pipeline->primitive_used, 0, memory_order_release);
+
+	render_command_buffer_initialize(&pipeline->command);
+	render_indirect_buffer_initialize(&pipeline->indirect);
+
+	pipeline->frame[0].primitive_buffer = pipeline->primitive_buffer;
+	pipeline->frame_count = 1;
+	if (pipeline->primitive_buffer)
+		render_pipeline_set_frame_count(pipeline, RENDER_PIPELINE_FRAME_COUNT);
+
+	return pipeline;
 }
 
 void
 render_pipeline_deallocate(render_pipeline_t* pipeline) {
-	if (pipeline && pipeline->backend)
+	if (pipeline && pipeline->backend) {
+		if (atomic_load32(&pipeline->record_pending, memory_order_acquire))
+			task_yield_and_wait(&pipeline->record_pending);
+		for (size_t iblock = 0, bsize = array_size(pipeline->record_block); iblock < bsize; ++iblock)
+			memory_deallocate(pipeline->record_block[iblock]);
+		array_deallocate(pipeline->record_block);
+		render_pipeline_set_frame_count(pipeline, 1);
+		while (array_size(pipeline->ring_buffer))
+			render_ring_buffer_deallocate(pipeline->ring_buffer[0]);
+		array_deallocate(pipeline->ring_buffer);
+		render_pipeline_disable(pipeline, RENDERPIPELINE_SORT);
+		render_command_buffer_finalize(&pipeline->command);
+		render_indirect_buffer_finalize(&pipeline->indirect);
+		for (uint iblock = 0; iblock < RENDER_PIPELINE_BLOCK_COUNT; ++iblock)
+			memory_deallocate(atomic_load_ptr(&pipeline->primitive_block[iblock], memory_order_acquire));
+		atomicptr_t* block_list[2] = {&pipeline->primitive_block_free, &pipeline->primitive_block_spare};
+		for (uint ilist = 0; ilist < 2; ++ilist) {
+			render_pipeline_block_t* block = atomic_load_ptr(block_list[ilist], memory_order_acquire);
+			while (block) {
+				render_pipeline_block_t* next = block->next;
+				memory_deallocate(block);
+				block = next;
+			}
+			atomic_store_ptr(block_list[ilist], nullptr, memory_order_release);
+		}
+		memory_deallocate(pipeline->primitive_chunk);
+		pipeline->primitive_chunk = nullptr;
+		pipeline->primitive_chunk_count = 0;
 		pipeline->backend->vtable.pipeline_deallocate(pipeline->backend, pipeline);
+	}
 }
 
 void
@@ -61,27 +144,635 @@ render_pipeline_build(render_pipeline_t* pipeline) {
 	pipeline->backend->vtable.pipeline_build(pipeline->backend, pipeline);
 }
 
+//! Wait for the backend to consume a frame in flight, returns true if the frame was still in flight
+static bool
+render_pipeline_frame_wait(render_pipeline_t* pipeline, uint frame) {
+	render_pipeline_frame_t* slot = pipeline->frame + frame;
+	if (!atomic_load32(&slot->fence, memory_order_acquire))
+		return false;
+	pipeline->backend->vtable.pipeline_wait(pipeline->backend, pipeline, frame);
+	atomic_store32(&slot->fence, 0, memory_order_release);
+	return true;
+}
+
+//! Allocate a primitive buffer for a frame
+static render_buffer_t*
+render_pipeline_frame_buffer_allocate(render_pipeline_t* pipeline, uint capacity) {
+	render_buffer_t* buffer =
+	    render_buffer_allocate(pipeline->backend, RENDERUSAGE_RENDER, sizeof(render_primitive_t) * capacity, 0, 0);
+	render_buffer_set_label(buffer, STRING_CONST("Pipeline primitive buffer"));
+	return buffer;
+}
+
+void
+render_pipeline_set_frame_count(render_pipeline_t* pipeline, uint count) {
+	if (count < 1)
+		count = 1;
+	else if (count > RENDER_PIPELINE_FRAME_MAX)
+		count = RENDER_PIPELINE_FRAME_MAX;
+
+	for (uint iframe = 0; iframe < pipeline->frame_count; ++iframe)
+		render_pipeline_frame_wait(pipeline, iframe);
+
+	// Move the buffer of the recorded frame to the first slot
+	pipeline->frame[pipeline->frame_current].primitive_buffer = pipeline->frame[0].primitive_buffer;
+	pipeline->frame[0].primitive_buffer = pipeline->primitive_buffer;
+	pipeline->frame_current = 0;
+
+	for (uint iframe = count; iframe < pipeline->frame_count; ++iframe) {
+		render_buffer_deallocate(pipeline->frame[iframe].primitive_buffer);
+		pipeline->frame[iframe].primitive_buffer = nullptr;
+	}
+	for (uint iframe = pipeline->frame_count; iframe < count; ++iframe)
+		pipeline->frame[iframe].primitive_buffer =
+		    render_pipeline_frame_buffer_allocate(pipeline, pipeline->primitive_capacity);
+	pipeline->frame_count = count;
+
+	// All frames are consumed, ring buffer regions can be split again
+	for (size_t iring = 0, rsize = array_size(pipeline->ring_buffer); iring < rsize; ++iring)
+		render_ring_buffer_frame(pipeline->ring_buffer[iring], 0, count);
+}
+
+void
+render_pipeline_frame_signal(render_pipeline_t* pipeline, uint frame) {
+	atomic_store32(&pipeline->frame[frame].fence, 0, memory_order_release);
+}
+
+void
+render_pipeline_enable(render_pipeline_t* pipeline, uint flags) {
+	if ((flags & RENDERPIPELINE_SORT) && !pipeline->sort_key && pipeline->primitive_capacity) {
+		size_t capacity = pipeline->primitive_capacity;
+		pipeline->sort_key = memory_allocate(HASH_RENDER, sizeof(uint64_t) * capacity * 2, 0, MEMORY_PERSISTENT);
+		pipeline->sort_index = memory_allocate(HASH_RENDER, sizeof(uint) * capacity * 2, 0, MEMORY_PERSISTENT);
+		pipeline->sort_store =
+		    memory_allocate(HASH_RENDER, sizeof(render_primitive_t) * capacity, 0, MEMORY_PERSISTENT);
+	}
+	pipeline->flags |= flags;
+}
+
+void
+render_pipeline_disable(render_pipeline_t* pipeline, uint flags) {
+	if (flags & RENDERPIPELINE_SORT) {
+		memory_deallocate(pipeline->sort_key);
+		memory_deallocate(pipeline->sort_index);
+		memory_deallocate(pipeline->sort_store);
+		pipeline->sort_key = nullptr;
+		pipeline->sort_index = nullptr;
+		pipeline->sort_store = nullptr;
+	}
+	pipeline->flags &= ~flags;
+}
+
+/*! Build sort key with the most expensive state to switch in the most significant bits. Render indices
+    are truncated to 16 bits and the descriptors are folded, which only affects grouping, not correctness */
+static uint64_t
+render_pipeline_sort_key(const render_primitive_t* primitive) {
+	uint32_t descriptor = (primitive->descriptor[0] * 0x9E3779B1U) ^ (primitive->descriptor[1] * 0x85EBCA77U) ^
+	                      (primitive->descriptor[2] * 0xC2B2AE3DU) ^ (primitive->descriptor[3] * 0x27D4EB2FU);
+	descriptor ^= descriptor >> 16;
+	return ((uint64_t)(primitive->pipeline_state & 0xFFFF) << 48) |
+	       ((uint64_t)(primitive->argument_buffer & 0xFFFF) << 32) |
+	       ((uint64_t)(primitive->index_buffer & 0xFFFF) << 16) | (uint64_t)(descriptor & 0xFFFF);
+}
+
+//! Count number of binding state changes needed to go from one primitive to the next
+static uint
+render_pipeline_state_changes(const render_primitive_t* previous, const render_primitive_t* primitive) {
+	return (uint)(previous->pipeline_state != primitive->pipeline_state) +
+	       (uint)(previous->argument_buffer != primitive->argument_buffer) +
+	       (uint)(previous->index_buffer != primitive->index_buffer) +
+	       (uint)(previous->descriptor[0] != primitive->descriptor[0]) +
+	       (uint)(previous->descriptor[1] != primitive->descriptor[1]) +
+	       (uint)(previous->descriptor[2] != primitive->descriptor[2]) +
+	       (uint)(previous->descriptor[3] != primitive->descriptor[3]);
+}
+
+//! Stable LSD radix sort of the primitive buffer on binding state sort keys
+static void
+render_pipeline_sort(render_pipeline_t* pipeline) {
+	uint count = (uint)pipeline->primitive_buffer->used;
+	pipeline->sort_changes_saved = 0;
+	if (count < 2)
+		return;
+
+	render_primitive_t* primitive_store = pipeline->primitive_buffer->store;
+	uint64_t* key = pipeline->sort_key;
+	uint64_t* key_swap = key + pipeline->primitive_capacity;
+	uint* index = pipeline->sort_index;
+	uint* index_swap = index + pipeline->primitive_capacity;
+	uint histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+
+	uint changes_unsorted = 0;
+	for (uint iprim = 0; iprim < count; ++iprim) {
+		uint64_t primitive_key = render_pipeline_sort_key(primitive_store + iprim);
+		key[iprim] = primitive_key;
+		index[iprim] = iprim;
+		for (uint ipass = 0; ipass < 8; ++ipass)
+			++histogram[ipass][(primitive_key >> (ipass * 8)) & 0xFF];
+		if (iprim)
+			changes_unsorted += render_pipeline_state_changes(primitive_store + (iprim - 1), primitive_store + iprim);
+	}
+
+	for (uint ipass = 0; ipass < 8; ++ipass) {
+		uint shift = ipass * 8;
+		uint* bucket = histogram[ipass];
+		// All keys share this byte, pass would not change order
+		if (bucket[(key[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint offset = 0;
+		for (uint ibucket = 0; ibucket < 256; ++ibucket) {
+			uint bucket_count = bucket[ibucket];
+			bucket[ibucket] = offset;
+			offset += bucket_count;
+		}
+		for (uint iprim = 0; iprim < count; ++iprim) {
+			uint target = bucket[(key[iprim] >> shift) & 0xFF]++;
+			key_swap[target] = key[iprim];
+			index_swap[target] = index[iprim];
+		}
+
+		uint64_t* key_tmp = key;
+		key = key_swap;
+		key_swap = key_tmp;
+		uint* index_tmp = index;
+		index = index_swap;
+		index_swap = index_tmp;
+	}
+
+	render_primitive_t* sorted_store = pipeline->sort_store;
+	uint changes_sorted = 0;
+	sorted_store[0] = primitive_store[index[0]];
+	for (uint iprim = 1; iprim < count; ++iprim) {
+		sorted_store[iprim] = primitive_store[index[iprim]];
+		changes_sorted += render_pipeline_state_changes(sorted_store + (iprim - 1), sorted_store + iprim);
+	}
+	memcpy(primitive_store, sorted_store, sizeof(render_primitive_t) * count);
+
+	pipeline->sort_changes_saved = (changes_unsorted > changes_sorted) ? (changes_unsorted - changes_sorted) : 0;
+	pipeline->sort_changes_saved_total += pipeline->sort_changes_saved;
+}
+
+//! Total number of primitive slots addressable by chunk reservations, including overflow blocks
+static uint
+render_pipeline_slot_limit(render_pipeline_t* pipeline) {
+	return (pipeline->primitive_chunk_count + (RENDER_PIPELINE_BLOCK_COUNT * RENDER_PIPELINE_BLOCK_CHUNK_COUNT)) *
+	       RENDER_PIPELINE_CHUNK_SIZE;
+}
+
+//! Get overflow block, chaining a free or new block to the pipeline if not already done by another thread
+static render_pipeline_block_t*
+render_pipeline_block(render_pipeline_t* pipeline, uint iblock) {
+	atomicptr_t* slot = pipeline->primitive_block + iblock;
+	render_pipeline_block_t* block = atomic_load_ptr(slot, memory_order_acquire);
+	if (block)
+		return block;
+
+	// Blocks are only pushed to the free list at flush, so concurrent pops here are not subject to ABA
+	block = atomic_load_ptr(&pipeline->primitive_block_free, memory_order_acquire);
+	while (block && !atomic_cas_ptr(&pipeline->primitive_block_free, block->next, block, memory_order_release,
+	                                memory_order_acquire))
+		block = atomic_load_ptr(&pipeline->primitive_block_free, memory_order_acquire);
+	if (!block)
+		block = memory_allocate(HASH_RENDER, sizeof(render_pipeline_block_t), 64,
+		                        MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	block->next = nullptr;
+
+	if (!atomic_cas_ptr(slot, block, nullptr, memory_order_release, memory_order_acquire)) {
+		// Lost the race, use the chained block. The unused block can not be released or pushed back on the
+		// free list since other threads may be popping it, keep it on the spare list until flush
+		render_pipeline_block_t* spare;
+		do {
+			spare = atomic_load_ptr(&pipeline->primitive_block_spare, memory_order_relaxed);
+			block->next = spare;
+		} while (!atomic_cas_ptr(&pipeline->primitive_block_spare, block, spare, memory_order_release,
+		                         memory_order_relaxed));
+		block = atomic_load_ptr(slot, memory_order_acquire);
+	}
+	return block;
+}
+
+//! Get fill count and storage of a reserved chunk, returns number of primitive slots in chunk
+static uint
+render_pipeline_chunk(render_pipeline_t* pipeline, uint chunk, render_pipeline_chunk_t** fill,
+                      render_primitive_t** store) {
+	if (chunk < pipeline->primitive_chunk_count) {
+		uint base = chunk * RENDER_PIPELINE_CHUNK_SIZE;
+		*fill = pipeline->primitive_chunk + chunk;
+		*store = (render_primitive_t*)pipeline->primitive_buffer->store + base;
+		return (base + RENDER_PIPELINE_CHUNK_SIZE < pipeline->primitive_capacity) ? RENDER_PIPELINE_CHUNK_SIZE :
+		                                                                            pipeline->primitive_capacity - base;
+	}
+	chunk -= pipeline->primitive_chunk_count;
+	render_pipeline_block_t* block = render_pipeline_block(pipeline, chunk / RENDER_PIPELINE_BLOCK_CHUNK_COUNT);
+	chunk %= RENDER_PIPELINE_BLOCK_CHUNK_COUNT;
+	*fill = block->chunk + chunk;
+	*store = block->primitive + (chunk * RENDER_PIPELINE_CHUNK_SIZE);
+	return RENDER_PIPELINE_CHUNK_SIZE;
+}
+
+//! Replace the primitive buffer with a larger buffer to fit the given number of primitives
+static render_buffer_t*
+render_pipeline_grow(render_pipeline_t* pipeline, uint count) {
+	const uint block_size = RENDER_PIPELINE_BLOCK_CHUNK_COUNT * RENDER_PIPELINE_CHUNK_SIZE;
+	uint capacity = ((count + (block_size - 1)) / block_size) * block_size;
+	render_buffer_t* buffer = render_pipeline_frame_buffer_allocate(pipeline, capacity);
+	log_debugf(HASH_RENDER, STRING_CONST("Growing pipeline primitive buffer from %u to %u primitives"),
+	           pipeline->primitive_capacity, capacity);
+	return buffer;
+}
+
+/*! Move primitives in partially filled chunks and overflow blocks together to make the primitive
+    buffer contiguous, growing the buffer if overflow blocks were needed, and recycle overflow blocks */
+static uint
+render_pipeline_compact(render_pipeline_t* pipeline) {
+	uint reserved = (uint)atomic_load32(&pipeline->primitive_used, memory_order_relaxed);
+	uint chunk_count = (reserved + (RENDER_PIPELINE_CHUNK_SIZE - 1)) / RENDER_PIPELINE_CHUNK_SIZE;
+	if (chunk_count > pipeline->primitive_chunk_count)
+		chunk_count = pipeline->primitive_chunk_count;
+
+	uint total = 0;
+	for (uint ichunk = 0; ichunk < chunk_count; ++ichunk)
+		total += (uint)atomic_load32(&pipeline->primitive_chunk[ichunk].used, memory_order_acquire);
+	render_pipeline_block_t* block[RENDER_PIPELINE_BLOCK_COUNT];
+	uint block_count = 0;
+	for (uint iblock = 0; iblock < RENDER_PIPELINE_BLOCK_COUNT; ++iblock) {
+		block[iblock] = atomic_load_ptr(&pipeline->primitive_block[iblock], memory_order_acquire);
+		if (!block[iblock])
+			continue;
+		block_count = iblock + 1;
+		for (uint ichunk = 0; ichunk < RENDER_PIPELINE_BLOCK_CHUNK_COUNT; ++ichunk)
+			total += (uint)atomic_load32(&block[iblock]->chunk[ichunk].used, memory_order_acquire);
+	}
+
+	render_buffer_t* buffer = pipeline->primitive_buffer;
+	if (total > pipeline->primitive_capacity)
+		buffer = render_pipeline_grow(pipeline, total);
+
+	render_primitive_t* source = pipeline->primitive_buffer->store;
+	render_primitive_t* primitive_store = buffer->store;
+	uint used = 0;
+	for (uint ichunk = 0; ichunk < chunk_count; ++ichunk) {
+		render_pipeline_chunk_t* chunk = pipeline->primitive_chunk + ichunk;
+		uint fill = (uint)atomic_load32(&chunk->used, memory_order_relaxed);
+		render_primitive_t* chunk_store = source + (ichunk * RENDER_PIPELINE_CHUNK_SIZE);
+		if (fill && (primitive_store + used != chunk_store))
+			memmove(primitive_store + used, chunk_store, sizeof(render_primitive_t) * fill);
+		used += fill;
+		atomic_store32(&chunk->used, 0, memory_order_relaxed);
+	}
+
+	render_pipeline_block_t* block_free = atomic_load_ptr(&pipeline->primitive_block_free, memory_order_acquire);
+	render_pipeline_block_t* spare = atomic_load_ptr(&pipeline->primitive_block_spare, memory_order_acquire);
+	while (spare) {
+		render_pipeline_block_t* next = spare->next;
+		spare->next = block_free;
+		block_free = spare;
+		spare = next;
+	}
+	atomic_store_ptr(&pipeline->primitive_block_spare, nullptr, memory_order_relaxed);
+	for (uint iblock = 0; iblock < block_count; ++iblock) {
+		if (!block[iblock])
+			continue;
+		for (uint ichunk = 0; ichunk < RENDER_PIPELINE_BLOCK_CHUNK_COUNT; ++ichunk) {
+			render_pipeline_chunk_t* chunk = block[iblock]->chunk + ichunk;
+			uint fill = (uint)atomic_load32(&chunk->used, memory_order_relaxed);
+			if (fill)
+				memcpy(primitive_store + used, block[iblock]->primitive + (ichunk * RENDER_PIPELINE_CHUNK_SIZE),
+				       sizeof(render_primitive_t) * fill);
+			used += fill;
+			atomic_store32(&chunk->used, 0, memory_order_relaxed);
+		}
+		block[iblock]->next = block_free;
+		block_free = block[iblock];
+		atomic_store_ptr(&pipeline->primitive_block[iblock], nullptr, memory_order_relaxed);
+	}
+	atomic_store_ptr(&pipeline->primitive_block_free, block_free, memory_order_release);
+
+	if (buffer != pipeline->primitive_buffer) {
+		render_buffer_deallocate(pipeline->primitive_buffer);
+		pipeline->primitive_buffer = buffer;
+		pipeline->primitive_capacity = (uint)(buffer->allocated / sizeof(render_primitive_t));
+		memory_deallocate(pipeline->primitive_chunk);
+		pipeline->primitive_chunk_count =
+		    (pipeline->primitive_capacity + (RENDER_PIPELINE_CHUNK_SIZE - 1)) / RENDER_PIPELINE_CHUNK_SIZE;
+		pipeline->primitive_chunk =
+		    memory_allocate(HASH_RENDER, sizeof(render_pipeline_chunk_t) * pipeline->primitive_chunk_count, 64,
+		                    MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		if (pipeline->flags & RENDERPIPELINE_SORT) {
+			render_pipeline_disable(pipeline, RENDERPIPELINE_SORT);
+			render_pipeline_enable(pipeline, RENDERPIPELINE_SORT);
+		}
+	}
+
+	if (used > pipeline->primitive_high_water)
+		pipeline->primitive_high_water = used;
+	uint dropped = (uint)atomic_load32(&pipeline->primitive_dropped, memory_order_relaxed);
+	pipeline->primitive_dropped_total += dropped;
+	pipeline->statistics_frame.primitives_dropped = (real)dropped;
+	atomic_store32(&pipeline->primitive_dropped, 0, memory_order_relaxed);
+
+	return used;
+}
+
 void
 render_pipeline_flush(render_pipeline_t* pipeline) {
-	if (pipeline->barrier) {
+	render_trace_begin("render_pipeline_flush");
+	render_pipeline_counters_t* statistics = &pipeline->statistics_frame;
+	memset(statistics, 0, sizeof(render_pipeline_counters_t));
+	tick_t start = time_current();
+
+	if (pipeline->barrier)
 		task_yield_and_wait(pipeline->barrier);
-		atomic_thread_fence_acquire();
-	}
-	pipeline->primitive_buffer->used = (uint)atomic_load32(&pipeline->primitive_used, memory_order_relaxed);
+	if ((pipeline->barrier != &pipeline->record_pending) &&
+	    atomic_load32(&pipeline->record_pending, memory_order_acquire))
+		task_yield_and_wait(&pipeline->record_pending);
+	atomic_thread_fence_acquire();
+	for (size_t iblock = 0, bsize = array_size(pipeline->record_block); iblock < bsize; ++iblock)
+		memory_deallocate(pipeline->record_block[iblock]);
+	array_clear(pipeline->record_block);
+	tick_t barrier_end = time_current();
+
+	// Compaction can replace the primitive buffer, so store the count only after it has returned
+	uint used = render_pipeline_compact(pipeline);
+	pipeline->primitive_buffer->used = used;
+	if (pipeline->flags & RENDERPIPELINE_SORT)
+		render_pipeline_sort(pipeline);
+	if (pipeline->backend->vtable.command_stream)
+		render_command_encode(&pipeline->command, pipeline->backend, pipeline->primitive_buffer->store,
+		                      (uint)pipeline->primitive_buffer->used, pipeline->flags);
+	else
+		render_command_count(&pipeline->command, pipeline->backend, pipeline->primitive_buffer->store,
+		                     (uint)pipeline->primitive_buffer->used, pipeline->flags);
+	if (pipeline->flags & RENDERPIPELINE_INDIRECT)
+		render_indirect_compile(&pipeline->indirect, pipeline->backend, pipeline->primitive_buffer->store,
+		                        (uint)pipeline->primitive_buffer->used, pipeline->index_format);
+
+	statistics->primitives_queued = (real)pipeline->primitive_buffer->used;
+	render_buffer_upload_flush(pipeline->backend);
+	for (size_t iring = 0, rsize = array_size(pipeline->ring_buffer); iring < rsize; ++iring)
+		render_ring_buffer_flush(pipeline->ring_buffer[iring]);
+
+	render_pipeline_frame_t* frame = pipeline->frame + pipeline->frame_current;
+	frame->primitive_buffer = pipeline->primitive_buffer;
+	frame->submit = time_current();
+	atomic_store32(&frame->fence, 1, memory_order_release);
 	pipeline->backend->vtable.pipeline_flush(pipeline->backend, pipeline);
+	tick_t backend_end = time_current();
+
+	statistics->time_barrier = (real)time_ticks_to_seconds(barrier_end - start);
+	statistics->time_queue = (real)time_ticks_to_seconds(frame->submit - barrier_end);
+	statistics->time_backend = (real)time_ticks_to_seconds(backend_end - frame->submit);
+	if (render_backend_statistics_frame(pipeline->backend, &pipeline->backend_frame))
+		render_buffer_residency_frame(pipeline->backend);
+	pipeline->statistics_history[pipeline->statistics_frame_count % RENDER_PIPELINE_STATISTICS_FRAMES] = *statistics;
+	++pipeline->statistics_frame_count;
+
+	// Swap to next frame in the ring, only waiting if it is still in flight
+	pipeline->frame_current = (pipeline->frame_current + 1) % pipeline->frame_count;
+	if (render_pipeline_frame_wait(pipeline, pipeline->frame_current))
+		++pipeline->frame_wait_count;
+	frame = pipeline->frame + pipeline->frame_current;
+	if (frame->primitive_buffer->allocated < sizeof(render_primitive_t) * pipeline->primitive_capacity) {
+		// Primitive buffer of a previous frame grew, match the capacity of the chunk array
+		render_buffer_deallocate(frame->primitive_buffer);
+		frame->primitive_buffer = render_pipeline_frame_buffer_allocate(pipeline, pipeline->primitive_capacity);
+	}
+	pipeline->primitive_buffer = frame->primitive_buffer;
+	pipeline->primitive_buffer->used = 0;
 	atomic_store32(&pipeline->primitive_used, 0, memory_order_relaxed);
+	for (size_t iring = 0, rsize = array_size(pipeline->ring_buffer); iring < rsize; ++iring)
+		render_ring_buffer_frame(pipeline->ring_buffer[iring], pipeline->frame_current, pipeline->frame_count);
+	pipeline->generation = (uint32_t)atomic_incr32(&render_pipeline_generation, memory_order_relaxed);
+	render_trace_end("render_pipeline_flush");
+}
+
+static render_pipeline_thread_chunk_t*
+render_pipeline_thread_chunk(render_pipeline_t* pipeline) {
+	render_pipeline_thread_chunk_t* thread_chunk = get_thread_pipeline_chunk();
+	uint islot = 0;
+	for (; islot < RENDER_PIPELINE_THREAD_CHUNK_COUNT; ++islot) {
+		if (thread_chunk[islot].pipeline == pipeline) {
+			if (thread_chunk[islot].generation == pipeline->generation)
+				return thread_chunk + islot;
+			break;
+		}
+	}
+	if (islot == RENDER_PIPELINE_THREAD_CHUNK_COUNT) {
+		// Pick a free slot, or drop the last used pipeline chunk. Primitives already
+		// queued in the dropped chunk are kept, any remaining free slots are compacted at flush
+		for (islot = 0; islot < RENDER_PIPELINE_THREAD_CHUNK_COUNT - 1; ++islot) {
+			if (!thread_chunk[islot].pipeline)
+				break;
+		}
+	}
+	thread_chunk[islot].pipeline = pipeline;
+	thread_chunk[islot].generation = pipeline->generation;
+	thread_chunk[islot].used = 0;
+	thread_chunk[islot].size = 0;
+	thread_chunk[islot].store = nullptr;
+	thread_chunk[islot].fill = nullptr;
+	return thread_chunk + islot;
+}
+
+//! Reserve a range of whole chunks, returns number of chunks reserved which is less than requested if exhausted
+static uint
+render_pipeline_reserve(render_pipeline_t* pipeline, uint chunk_count, uint* first_chunk) {
+	uint limit = render_pipeline_slot_limit(pipeline);
+	if ((uint)atomic_load32(&pipeline->primitive_used, memory_order_relaxed) >= limit)
+		return 0;
+	int32_t size = (int32_t)(chunk_count * RENDER_PIPELINE_CHUNK_SIZE);
+	uint base = (uint)(atomic_add32(&pipeline->primitive_used, size, memory_order_relaxed) - size);
+	if (base >= limit)
+		return 0;
+	uint available = (limit - base) / RENDER_PIPELINE_CHUNK_SIZE;
+	*first_chunk = base / RENDER_PIPELINE_CHUNK_SIZE;
+	return (chunk_count < available) ? chunk_count : available;
+}
+
+//! Make the given chunk the open chunk of the thread, with the given number of slots already used
+static void
+render_pipeline_open_chunk(render_pipeline_t* pipeline, render_pipeline_thread_chunk_t* thread_chunk, uint chunk,
+                           uint used) {
+	thread_chunk->size = render_pipeline_chunk(pipeline, chunk, &thread_chunk->fill, &thread_chunk->store);
+	thread_chunk->used = used;
 }
 
 void
 render_pipeline_queue(render_pipeline_t* pipeline, render_primitive_type type, const render_primitive_t* primitive) {
 	FOUNDATION_UNUSED(type);
-	int32_t index = atomic_incr32(&pipeline->primitive_used, memory_order_release);
-	if ((uint)index <= pipeline->primitive_buffer->allocated) {
-		render_primitive_t* primitve_store = pipeline->primitive_buffer->store;
-		primitve_store[index - 1] = *primitive;
+	render_pipeline_thread_chunk_t* thread_chunk = render_pipeline_thread_chunk(pipeline);
+	if (thread_chunk->used >= thread_chunk->size) {
+		uint chunk = 0;
+		if (!render_pipeline_reserve(pipeline, 1, &chunk)) {
+			atomic_incr32(&pipeline->primitive_dropped, memory_order_relaxed);
+			return;
+		}
+		render_pipeline_open_chunk(pipeline, thread_chunk, chunk, 0);
+	}
+
+	thread_chunk->store[thread_chunk->used++] = *primitive;
+	atomic_store32(&thread_chunk->fill->used, (int32_t)thread_chunk->used, memory_order_release);
+}
+
+uint
+render_pipeline_queue_batch(render_pipeline_t* pipeline, render_primitive_type type,
+                            const render_primitive_t* primitives, uint count) {
+	FOUNDATION_UNUSED(type);
+	if (!count)
+		return 0;
+
+	render_trace_begin("render_pipeline_queue_batch");
+	uint first_chunk = 0;
+	uint chunk_count =
+	    render_pipeline_reserve(pipeline, (count + (RENDER_PIPELINE_CHUNK_SIZE - 1)) / RENDER_PIPELINE_CHUNK_SIZE,
+	                            &first_chunk);
+	if (!chunk_count) {
+		atomic_add32(&pipeline->primitive_dropped, (int32_t)count, memory_order_relaxed);
+		render_trace_end("render_pipeline_queue_batch");
+		return 0;
+	}
+
+	render_pipeline_chunk_t* fill = nullptr;
+	render_primitive_t* store = nullptr;
+	uint queued = 0;
+	uint used = 0;
+	uint size = 0;
+	uint last_chunk = first_chunk;
+	uint base = first_chunk * RENDER_PIPELINE_CHUNK_SIZE;
+	if ((first_chunk + chunk_count <= pipeline->primitive_chunk_count) &&
+	    (base + count <= pipeline->primitive_capacity)) {
+		// Whole range is in the primitive buffer, copy in one go
+		render_primitive_t* primitive_store = pipeline->primitive_buffer->store;
+		memcpy(primitive_store + base, primitives, sizeof(render_primitive_t) * count);
+		queued = count;
+		last_chunk = (base + count - 1) / RENDER_PIPELINE_CHUNK_SIZE;
+		for (uint ichunk = first_chunk; ichunk < last_chunk; ++ichunk)
+			atomic_store32(&pipeline->primitive_chunk[ichunk].used, RENDER_PIPELINE_CHUNK_SIZE,
+			               memory_order_release);
+		size = render_pipeline_chunk(pipeline, last_chunk, &fill, &store);
+		used = (base + count) - (last_chunk * RENDER_PIPELINE_CHUNK_SIZE);
+		atomic_store32(&fill->used, (int32_t)used, memory_order_release);
 	} else {
-		atomic_store32(&pipeline->primitive_used, (int32_t)pipeline->primitive_buffer->allocated, memory_order_relaxed);
+		// Range spans a truncated chunk or overflow blocks, copy chunk by chunk
+		uint chunk = first_chunk;
+		uint chunk_end = first_chunk + chunk_count;
+		while (queued < count) {
+			if (chunk == chunk_end) {
+				uint remain = count - queued;
+				chunk_count = render_pipeline_reserve(
+				    pipeline, (remain + (RENDER_PIPELINE_CHUNK_SIZE - 1)) / RENDER_PIPELINE_CHUNK_SIZE, &chunk);
+				if (!chunk_count)
+					break;
+				chunk_end = chunk + chunk_count;
+			}
+			size = render_pipeline_chunk(pipeline, chunk, &fill, &store);
+			used = (size < count - queued) ? size : count - queued;
+			memcpy(store, primitives + queued, sizeof(render_primitive_t) * used);
+			atomic_store32(&fill->used, (int32_t)used, memory_order_release);
+			queued += used;
+			last_chunk = chunk++;
+		}
+		if (queued < count)
+			atomic_add32(&pipeline->primitive_dropped, (int32_t)(count - queued), memory_order_relaxed);
 	}
+
+	// Let following single primitive queue calls continue in the partially filled last chunk
+	if (used < size) {
+		render_pipeline_thread_chunk_t* thread_chunk = render_pipeline_thread_chunk(pipeline);
+		thread_chunk->size = size;
+		thread_chunk->used = used;
+		thread_chunk->fill = fill;
+		thread_chunk->store = store;
+	}
+
+	render_trace_end("render_pipeline_queue_batch");
+	return queued;
+}
+
+static void
+render_pipeline_record_task(task_context_t context) {
+	render_pipeline_record_t* record = context;
+	render_pipeline_t* pipeline = record->pipeline;
+	record->function(pipeline, record->context);
+	atomic_decr32(&pipeline->record_pending, memory_order_release);
+}
+
+void
+render_pipeline_record_parallel(render_pipeline_t* pipeline, render_pipeline_record_fn function, void** contexts,
+                                uint count) {
+	if (!count)
+		return;
+
+	task_scheduler_t* scheduler = render_config.task_scheduler;
+	if (!scheduler) {
+		for (uint iitem = 0; iitem < count; ++iitem)
+			function(pipeline, contexts[iitem]);
+		return;
+	}
+
+	// Work items and tasks are kept until the flush has waited for the tasks to complete
+	void* block =
+	    memory_allocate(HASH_RENDER, (sizeof(render_pipeline_record_t) + sizeof(task_t)) * count, 0, MEMORY_PERSISTENT);
+	render_pipeline_record_t* record = block;
+	task_t* task = pointer_offset(block, sizeof(render_pipeline_record_t) * count);
+	memset(task, 0, sizeof(task_t) * count);
+	for (uint iitem = 0; iitem < count; ++iitem) {
+		record[iitem].pipeline = pipeline;
+		record[iitem].function = function;
+		record[iitem].context = contexts[iitem];
+		task[iitem].function = render_pipeline_record_task;
+		task[iitem].context = record + iitem;
+	}
+	array_push(pipeline->record_block, block);
+
+	if (!pipeline->barrier)
+		pipeline->barrier = &pipeline->record_pending;
+	atomic_add32(&pipeline->record_pending, (int32_t)count, memory_order_release);
+	task_scheduler_queue(scheduler, task, count, nullptr);
+}
+
+uint
+render_pipeline_primitive_high_water(render_pipeline_t* pipeline) {
+	return pipeline->primitive_high_water;
+}
+
+uint64_t
+render_pipeline_primitive_dropped(render_pipeline_t* pipeline) {
+	return pipeline->primitive_dropped_total + (uint)atomic_load32(&pipeline->primitive_dropped, memory_order_relaxed);
+}
+
+void
+render_pipeline_statistics_encoded(render_pipeline_t* pipeline) {
+	render_pipeline_counters_t* statistics = &pipeline->statistics_frame;
+	statistics->state_switches = (real)pipeline->command.state_binds;
+	statistics->argument_switches = (real)pipeline->command.argument_binds;
+	statistics->descriptor_rebinds = (real)pipeline->command.descriptor_binds;
+	statistics->draws = (real)pipeline->command.draws;
+}
+
+void
+render_pipeline_statistics(render_pipeline_t* pipeline, render_pipeline_statistics_t* statistics) {
+	memset(statistics, 0, sizeof(render_pipeline_statistics_t));
+	statistics->frame_count = pipeline->statistics_frame_count;
+	if (!pipeline->statistics_frame_count)
+		return;
+
+	uint history_count = (uint)math_min(pipeline->statistics_frame_count, RENDER_PIPELINE_STATISTICS_FRAMES);
+	uint last = (uint)((pipeline->statistics_frame_count - 1) % RENDER_PIPELINE_STATISTICS_FRAMES);
+	statistics->frame = pipeline->statistics_history[last];
+
+	// Counters are all reals, average them as arrays
+	const size_t counter_count = sizeof(render_pipeline_counters_t) / sizeof(real);
+	real* average = (real*)&statistics->average;
+	for (uint iframe = 0; iframe < history_count; ++iframe) {
+		const real* counter = (const real*)(pipeline->statistics_history + iframe);
+		for (size_t icounter = 0; icounter < counter_count; ++icounter)
+			average[icounter] += counter[icounter];
+	}
+	for (size_t icounter = 0; icounter < counter_count; ++icounter)
+		average[icounter] /= (real)history_count;
 }
 
 void
@@ -96,11 +787,17 @@ render_pipeline_use_render_buffer(render_pipeline_t* pipeline, render_buffer_ind
 
 render_pipeline_state_t
 render_pipeline_state_allocate(render_backend_t* backend, render_pipeline_t* pipeline, render_shader_t* shader) {
-	return backend->vtable.pipeline_state_allocate(backend, pipeline, shader);
+	render_pipeline_state_t state = backend->vtable.pipeline_state_allocate(backend, pipeline, shader);
+	if (state)
+		render_backend_statistics_allocate(backend, RENDERRESOURCE_PIPELINE_STATE, RENDERUSAGE_GPUONLY, 0);
+	return state;
 }
 
 void
 render_pipeline_state_deallocate(render_backend_t* backend, render_pipeline_state_t state) {
-	if (backend)
+	if (backend) {
+		if (state)
+			render_backend_statistics_deallocate(backend, RENDERRESOURCE_PIPELINE_STATE, RENDERUSAGE_GPUONLY, 0);
 		backend->vtable.pipeline_state_deallocate(backend, state);
+	}
 }
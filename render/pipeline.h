@@ -46,12 +46,82 @@ render_pipeline_set_depth_clear(render_pipeline_t* pipeline, render_clear_action
 RENDER_API void
 render_pipeline_build(render_pipeline_t* pipeline);
 
+/*! Enable pipeline flags
+    \param pipeline Pipeline
+    \param flags Flags to enable (render_pipeline_flag_t) */
+RENDER_API void
+render_pipeline_enable(render_pipeline_t* pipeline, uint flags);
+
+/*! Disable pipeline flags
+    \param pipeline Pipeline
+    \param flags Flags to disable (render_pipeline_flag_t) */
+RENDER_API void
+render_pipeline_disable(render_pipeline_t* pipeline, uint flags);
+
 RENDER_API void
 render_pipeline_flush(render_pipeline_t* pipeline);
 
+/*! Record primitives in parallel by fanning out work items over the task scheduler given in the
+    render module config. Each work item calls the record function with the pipeline and its context,
+    queueing through the thread local chunk of the executing thread. The pipeline barrier is set to
+    the outstanding task counter if no barrier is set, and flush waits for all outstanding tasks.
+    Without a task scheduler the work items are recorded in the calling thread
+    \param pipeline Pipeline
+    \param function Record function
+    \param contexts Array of work item contexts passed to the record function
+    \param count Number of work items */
+RENDER_API void
+render_pipeline_record_parallel(render_pipeline_t* pipeline, render_pipeline_record_fn function, void** contexts,
+                                uint count);
+
 RENDER_API void
 render_pipeline_queue(render_pipeline_t* pipeline, render_primitive_type type, const render_primitive_t* primitive);
 
+/*! Queue an array of primitives with a single reservation in the primitive buffer
+    \param pipeline Pipeline
+    \param type Primitive type
+    \param primitives Primitive array
+    \param count Number of primitives in array
+    \return Number of primitives queued, less than count if pipeline capacity was exceeded */
+RENDER_API uint
+render_pipeline_queue_batch(render_pipeline_t* pipeline, render_primitive_type type,
+                            const render_primitive_t* primitives, uint count);
+
+/*! Set number of frames in flight. Each frame has its own primitive buffer, and flushing a frame
+    swaps recording to the next frame in the ring, only waiting for the backend to consume a frame
+    when the ring wraps. Waits for all frames in flight to complete before changing the ring, must
+    not be called while primitives are queued
+    \param pipeline Pipeline
+    \param count Number of frames in flight, clamped to [1, RENDER_PIPELINE_FRAME_MAX] */
+RENDER_API void
+render_pipeline_set_frame_count(render_pipeline_t* pipeline, uint count);
+
+/*! Signal that the backend has consumed a frame in flight, called by backends
+    \param pipeline Pipeline
+    \param frame Frame slot index */
+RENDER_API void
+render_pipeline_frame_signal(render_pipeline_t* pipeline, uint frame);
+
+/*! Get the highest number of primitives queued to the pipeline in a single frame
+    \param pipeline Pipeline
+    \return Primitive high-water mark */
+RENDER_API uint
+render_pipeline_primitive_high_water(render_pipeline_t* pipeline);
+
+/*! Get the number of primitives dropped since the pipeline was allocated, which only happens when
+    the primitive buffer and all overflow blocks are exhausted in a frame
+    \param pipeline Pipeline
+    \return Number of dropped primitives */
+RENDER_API uint64_t
+render_pipeline_primitive_dropped(render_pipeline_t* pipeline);
+
+/*! Get statistics of the last flushed frame and averages over the most recent
+    RENDER_PIPELINE_STATISTICS_FRAMES flushed frames
+    \param pipeline Pipeline
+    \param statistics Statistics result */
+RENDER_API void
+render_pipeline_statistics(render_pipeline_t* pipeline, render_pipeline_statistics_t* statistics);
+
 RENDER_API void
 render_pipeline_use_argument_buffer(render_pipeline_t* pipeline, render_buffer_index_t buffer);
 
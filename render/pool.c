@@ -0,0 +1,530 @@
+/* pool.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+//! Default alignment of ranges in bytes
+#define RENDER_BUFFER_POOL_ALIGNMENT 16
+#define RENDER_BUFFER_POOL_INVALID 0xFFFFFFFFU
+
+static uint
+render_buffer_pool_log2(uint32_t value) {
+#if FOUNDATION_COMPILER_MSVC
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return (uint)index;
+#else
+	return 31U - (uint)__builtin_clz(value);
+#endif
+}
+
+static uint
+render_buffer_pool_ctz(uint32_t value) {
+#if FOUNDATION_COMPILER_MSVC
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (uint)index;
+#else
+	return (uint)__builtin_ctz(value);
+#endif
+}
+
+//! Map a size in alignment units to first and second level size class
+static void
+render_buffer_pool_mapping(uint units, uint* fl, uint* sl) {
+	if (units < RENDER_BUFFER_POOL_SL_COUNT) {
+		*fl = 0;
+		*sl = units;
+	} else {
+		uint log2 = render_buffer_pool_log2(units);
+		*fl = log2 - RENDER_BUFFER_POOL_SL_LOG2 + 1;
+		*sl = (units >> (log2 - RENDER_BUFFER_POOL_SL_LOG2)) ^ RENDER_BUFFER_POOL_SL_COUNT;
+	}
+}
+
+//! Round a size in alignment units up to the lower bound of a size class, any free range in that class fits
+static uint
+render_buffer_pool_round(uint units) {
+	if (units >= RENDER_BUFFER_POOL_SL_COUNT) {
+		uint round = (1U << (render_buffer_pool_log2(units) - RENDER_BUFFER_POOL_SL_LOG2)) - 1;
+		units = (units + round) & ~round;
+	}
+	return units;
+}
+
+static void
+render_buffer_pool_free_insert(render_buffer_pool_t* pool, uint index) {
+	render_buffer_pool_range_t* range = pool->range + index;
+	uint fl, sl;
+	render_buffer_pool_mapping(range->size / pool->alignment, &fl, &sl);
+	uint head = pool->free_head[fl][sl];
+	range->free = true;
+	range->prev_free = RENDER_BUFFER_POOL_INVALID;
+	range->next_free = head;
+	if (head != RENDER_BUFFER_POOL_INVALID)
+		pool->range[head].prev_free = index;
+	pool->free_head[fl][sl] = index;
+	pool->first_level |= (1U << fl);
+	pool->second_level[fl] |= (1U << sl);
+}
+
+static void
+render_buffer_pool_free_remove(render_buffer_pool_t* pool, uint index) {
+	render_buffer_pool_range_t* range = pool->range + index;
+	uint fl, sl;
+	render_buffer_pool_mapping(range->size / pool->alignment, &fl, &sl);
+	if (range->prev_free != RENDER_BUFFER_POOL_INVALID)
+		pool->range[range->prev_free].next_free = range->next_free;
+	else
+		pool->free_head[fl][sl] = range->next_free;
+	if (range->next_free != RENDER_BUFFER_POOL_INVALID)
+		pool->range[range->next_free].prev_free = range->prev_free;
+	if (pool->free_head[fl][sl] == RENDER_BUFFER_POOL_INVALID) {
+		pool->second_level[fl] &= ~(1U << sl);
+		if (!pool->second_level[fl])
+			pool->first_level &= ~(1U << fl);
+	}
+	range->free = false;
+}
+
+//! Find a free range in the given size class or any larger class
+static uint
+render_buffer_pool_free_find(render_buffer_pool_t* pool, uint fl, uint sl) {
+	uint32_t sl_map = pool->second_level[fl] & (~0U << sl);
+	if (!sl_map) {
+		uint32_t fl_map = (fl + 1 < RENDER_BUFFER_POOL_FL_COUNT) ? (pool->first_level & (~0U << (fl + 1))) : 0;
+		if (!fl_map)
+			return RENDER_BUFFER_POOL_INVALID;
+		fl = render_buffer_pool_ctz(fl_map);
+		sl_map = pool->second_level[fl];
+	}
+	return pool->free_head[fl][render_buffer_pool_ctz(sl_map)];
+}
+
+//! Get an unused range node, may grow and move the node array
+static uint
+render_buffer_pool_node_allocate(render_buffer_pool_t* pool) {
+	uint index;
+	if (array_size(pool->range_unused)) {
+		index = pool->range_unused[array_size(pool->range_unused) - 1];
+		array_pop(pool->range_unused);
+	} else {
+		render_buffer_pool_range_t range;
+		array_push(pool->range, range);
+		index = (uint)array_size(pool->range) - 1;
+	}
+	render_buffer_pool_range_t* range = pool->range + index;
+	memset(range, 0, sizeof(render_buffer_pool_range_t));
+	range->prev_physical = range->next_physical = RENDER_BUFFER_POOL_INVALID;
+	range->prev_free = range->next_free = RENDER_BUFFER_POOL_INVALID;
+	return index;
+}
+
+static void
+render_buffer_pool_node_release(render_buffer_pool_t* pool, uint index) {
+	pool->range[index].block = RENDER_BUFFER_POOL_INVALID;
+	pool->range[index].buffer = nullptr;
+	pool->range[index].free = false;
+	array_push(pool->range_unused, index);
+}
+
+static void
+render_buffer_pool_reset(render_buffer_pool_t* pool) {
+	array_clear(pool->range);
+	array_clear(pool->range_unused);
+	pool->first_level = 0;
+	memset(pool->second_level, 0, sizeof(pool->second_level));
+	memset(pool->free_head, 0xFF, sizeof(pool->free_head));
+}
+
+static bool
+render_buffer_pool_block_add(render_buffer_pool_t* pool, uint size) {
+	render_buffer_t* buffer = render_buffer_allocate(pool->backend, pool->usage, size, nullptr, 0);
+	if (buffer->allocated < size) {
+		render_buffer_deallocate(buffer);
+		return false;
+	}
+	render_buffer_set_label(buffer, STRING_CONST("Buffer pool block"));
+
+	uint block = (uint)array_size(pool->block);
+	for (uint iblock = 0; iblock < block; ++iblock) {
+		if (!pool->block[iblock]) {
+			block = iblock;
+			break;
+		}
+	}
+	if (block < array_size(pool->block))
+		pool->block[block] = buffer;
+	else
+		array_push(pool->block, buffer);
+
+	uint index = render_buffer_pool_node_allocate(pool);
+	pool->range[index].block = block;
+	pool->range[index].size = size;
+	render_buffer_pool_free_insert(pool, index);
+	return true;
+}
+
+//! Reserve a range of the given aligned size, adding a block if no free range fits
+static uint
+render_buffer_pool_range_reserve(render_buffer_pool_t* pool, uint size) {
+	uint units = render_buffer_pool_round(size / pool->alignment);
+	uint fl, sl;
+	render_buffer_pool_mapping(units, &fl, &sl);
+	uint index = render_buffer_pool_free_find(pool, fl, sl);
+	if (index == RENDER_BUFFER_POOL_INVALID) {
+		// Blocks at least the size of the rounded class so the new range is found in the class
+		uint block_size = units * pool->alignment;
+		if (block_size < pool->block_size)
+			block_size = pool->block_size;
+		if (!render_buffer_pool_block_add(pool, block_size))
+			return RENDER_BUFFER_POOL_INVALID;
+		index = render_buffer_pool_free_find(pool, fl, sl);
+	}
+	render_buffer_pool_free_remove(pool, index);
+
+	uint remain = pool->range[index].size - size;
+	if (remain >= pool->alignment) {
+		uint split = render_buffer_pool_node_allocate(pool);
+		render_buffer_pool_range_t* range = pool->range + index;
+		render_buffer_pool_range_t* tail = pool->range + split;
+		tail->block = range->block;
+		tail->offset = range->offset + size;
+		tail->size = remain;
+		tail->prev_physical = index;
+		tail->next_physical = range->next_physical;
+		if (range->next_physical != RENDER_BUFFER_POOL_INVALID)
+			pool->range[range->next_physical].prev_physical = split;
+		range->next_physical = split;
+		range->size = size;
+		render_buffer_pool_free_insert(pool, split);
+	}
+	return index;
+}
+
+//! Release a range and merge it with free neighbours in the block
+static void
+render_buffer_pool_range_release(render_buffer_pool_t* pool, uint index) {
+	render_buffer_pool_range_t* range = pool->range + index;
+	range->buffer = nullptr;
+
+	uint next = range->next_physical;
+	if ((next != RENDER_BUFFER_POOL_INVALID) && pool->range[next].free) {
+		render_buffer_pool_free_remove(pool, next);
+		range->size += pool->range[next].size;
+		range->next_physical = pool->range[next].next_physical;
+		if (range->next_physical != RENDER_BUFFER_POOL_INVALID)
+			pool->range[range->next_physical].prev_physical = index;
+		render_buffer_pool_node_release(pool, next);
+	}
+
+	uint prev = range->prev_physical;
+	if ((prev != RENDER_BUFFER_POOL_INVALID) && pool->range[prev].free) {
+		render_buffer_pool_range_t* prev_range = pool->range + prev;
+		render_buffer_pool_free_remove(pool, prev);
+		prev_range->size += range->size;
+		prev_range->next_physical = range->next_physical;
+		if (prev_range->next_physical != RENDER_BUFFER_POOL_INVALID)
+			pool->range[prev_range->next_physical].prev_physical = prev;
+		render_buffer_pool_node_release(pool, index);
+		index = prev;
+	}
+
+	render_buffer_pool_free_insert(pool, index);
+}
+
+render_buffer_pool_t*
+render_buffer_pool_allocate(render_backend_t* backend, uint usage, size_t block_size, uint alignment) {
+	if (!alignment)
+		alignment = RENDER_BUFFER_POOL_ALIGNMENT;
+	FOUNDATION_ASSERT(!(alignment & (alignment - 1)));
+	if (!block_size)
+		block_size = RENDER_BUFFER_POOL_BLOCK_SIZE;
+	if (block_size > (size_t)INT32_MAX)
+		block_size = (size_t)INT32_MAX;
+
+	render_buffer_pool_t* pool =
+	    memory_allocate(HASH_RENDER, sizeof(render_buffer_pool_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	pool->backend = backend;
+	pool->usage = usage;
+	pool->alignment = alignment;
+	pool->block_size = (uint)block_size & ~(alignment - 1);
+	pool->lock = mutex_allocate(STRING_CONST("render_buffer_pool"));
+	render_buffer_pool_reset(pool);
+	return pool;
+}
+
+void
+render_buffer_pool_deallocate(render_buffer_pool_t* pool) {
+	if (!pool)
+		return;
+	if (pool->allocation_count)
+		log_warnf(HASH_RENDER, WARNING_MEMORY, STRING_CONST("Buffer pool deallocated with %u logical buffers in use"),
+		          pool->allocation_count);
+	for (size_t iblock = 0, bsize = array_size(pool->block); iblock < bsize; ++iblock)
+		render_buffer_deallocate(pool->block[iblock]);
+	array_deallocate(pool->block);
+	array_deallocate(pool->range);
+	array_deallocate(pool->range_unused);
+	mutex_deallocate(pool->lock);
+	memory_deallocate(pool);
+}
+
+render_buffer_t*
+render_buffer_pool_buffer_allocate(render_buffer_pool_t* pool, size_t buffer_size, const void* data,
+                                   size_t data_size) {
+	if (!buffer_size || (buffer_size > (size_t)INT32_MAX))
+		return nullptr;
+	uint size = (uint)(buffer_size + (pool->alignment - 1)) & ~(pool->alignment - 1);
+
+	mutex_lock(pool->lock);
+	uint index = render_buffer_pool_range_reserve(pool, size);
+	if (index == RENDER_BUFFER_POOL_INVALID) {
+		mutex_unlock(pool->lock);
+		log_warnf(HASH_RENDER, WARNING_MEMORY, STRING_CONST("Unable to allocate %" PRIsize " bytes from buffer pool"),
+		          buffer_size);
+		return nullptr;
+	}
+
+	render_buffer_pool_range_t* range = pool->range + index;
+	render_buffer_t* block = pool->block[range->block];
+	render_handle_t handle;
+	render_buffer_t* buffer = render_slab_allocate(&pool->backend->buffer_slab, &handle);
+	if (!buffer) {
+		render_buffer_pool_range_release(pool, index);
+		mutex_unlock(pool->lock);
+		return nullptr;
+	}
+	buffer->backend = pool->backend;
+	buffer->handle = handle;
+	buffer->usage = block->usage;
+	buffer->render_index = block->render_index;
+	buffer->allocated = buffer_size;
+	buffer->store = block->store ? pointer_offset(block->store, range->offset) : nullptr;
+	buffer->pool = pool;
+	buffer->pool_range = index;
+	buffer->offset = range->offset;
+	semaphore_initialize(&buffer->lock, 1);
+	semaphore_initialize(&buffer->lock_wake, 0);
+	range->buffer = buffer;
+
+	++pool->allocation_count;
+	pool->bytes_allocated += range->size;
+	mutex_unlock(pool->lock);
+
+	if (data_size && buffer->store) {
+		buffer->used = (data_size < buffer_size) ? data_size : buffer_size;
+		memcpy(buffer->store, data, buffer->used);
+		buffer->flags |= RENDERBUFFER_DIRTY;
+		render_buffer_upload(buffer, 0, buffer->used);
+	}
+	return buffer;
+}
+
+void
+render_buffer_pool_buffer_deallocate(render_buffer_t* buffer) {
+	render_buffer_pool_t* pool = buffer->pool;
+	mutex_lock(pool->lock);
+	pool->bytes_allocated -= pool->range[buffer->pool_range].size;
+	--pool->allocation_count;
+	render_buffer_pool_range_release(pool, buffer->pool_range);
+	mutex_unlock(pool->lock);
+	semaphore_finalize(&buffer->lock);
+	semaphore_finalize(&buffer->lock_wake);
+	render_slab_free(&buffer->backend->buffer_slab, buffer->handle);
+}
+
+void
+render_buffer_pool_buffer_upload(render_buffer_t* buffer, size_t offset, size_t size) {
+	render_buffer_pool_t* pool = buffer->pool;
+	mutex_lock(pool->lock);
+	render_buffer_t* block = pool->block[pool->range[buffer->pool_range].block];
+	block->flags |= RENDERBUFFER_DIRTY;
+	render_buffer_upload(block, buffer->offset + offset, size ? size : buffer->allocated);
+	mutex_unlock(pool->lock);
+}
+
+void
+render_buffer_pool_statistics(render_buffer_pool_t* pool, render_buffer_pool_statistics_t* statistics) {
+	memset(statistics, 0, sizeof(render_buffer_pool_statistics_t));
+	mutex_lock(pool->lock);
+	for (size_t iblock = 0, bsize = array_size(pool->block); iblock < bsize; ++iblock) {
+		if (pool->block[iblock]) {
+			++statistics->block_count;
+			statistics->bytes_reserved += pool->block[iblock]->allocated;
+		}
+	}
+	for (size_t irange = 0, rsize = array_size(pool->range); irange < rsize; ++irange) {
+		const render_buffer_pool_range_t* range = pool->range + irange;
+		if (!range->free)
+			continue;
+		++statistics->free_range_count;
+		statistics->bytes_free += range->size;
+		if (range->size > statistics->largest_free)
+			statistics->largest_free = range->size;
+	}
+	statistics->allocation_count = pool->allocation_count;
+	statistics->bytes_allocated = pool->bytes_allocated;
+	mutex_unlock(pool->lock);
+	if (statistics->bytes_free)
+		statistics->fragmentation =
+		    REAL_C(1.0) - ((real)statistics->largest_free / (real)statistics->bytes_free);
+}
+
+size_t
+render_buffer_pool_compact(render_buffer_pool_t* pool) {
+	mutex_lock(pool->lock);
+
+	// Gather logical buffers in address order, walking the ranges of each block from its first range
+	uint block_count = (uint)array_size(pool->block);
+	uint* block_end = memory_allocate(HASH_RENDER, sizeof(uint) * (block_count + 1), 0,
+	                                  MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+	uint* block_first = memory_allocate(HASH_RENDER, sizeof(uint) * (block_count + 1), 0, MEMORY_TEMPORARY);
+	memset(block_first, 0xFF, sizeof(uint) * (block_count + 1));
+	bool movable = true;
+	for (uint irange = 0, rsize = (uint)array_size(pool->range); irange < rsize; ++irange) {
+		const render_buffer_pool_range_t* range = pool->range + irange;
+		if (range->block == RENDER_BUFFER_POOL_INVALID)
+			continue;
+		if (range->prev_physical == RENDER_BUFFER_POOL_INVALID)
+			block_first[range->block] = irange;
+		if (range->buffer && atomic_load32(&range->buffer->lock_state, memory_order_acquire))
+			movable = false;
+	}
+	for (uint iblock = 0; iblock < block_count; ++iblock) {
+		if (pool->block[iblock] && !pool->block[iblock]->store)
+			movable = false;
+	}
+
+	render_buffer_t** live = nullptr;
+	if (movable) {
+		for (uint iblock = 0; iblock < block_count; ++iblock) {
+			for (uint irange = block_first[iblock]; irange != RENDER_BUFFER_POOL_INVALID;
+			     irange = pool->range[irange].next_physical) {
+				if (pool->range[irange].buffer)
+					array_push(live, pool->range[irange].buffer);
+			}
+		}
+	}
+
+	// Pack in address order, a range only ever moves to a lower address so moved data is never overwritten
+	size_t moved = 0;
+	uint target = 0;
+	uint target_offset = 0;
+	uint* live_size = nullptr;
+	for (size_t ilive = 0, lsize = array_size(live); ilive < lsize; ++ilive) {
+		render_buffer_t* buffer = live[ilive];
+		const render_buffer_pool_range_t* range = pool->range + buffer->pool_range;
+		uint size = range->size;
+		while (!pool->block[target] || (target_offset + size > pool->block[target]->allocated)) {
+			++target;
+			target_offset = 0;
+		}
+		if ((target != range->block) || (target_offset != range->offset)) {
+			void* store = pointer_offset(pool->block[target]->store, target_offset);
+			memmove(store, buffer->store, buffer->allocated);
+			moved += buffer->allocated;
+			buffer->render_index = pool->block[target]->render_index;
+			buffer->offset = target_offset;
+			buffer->store = store;
+		}
+		// Range index is reassigned when the range nodes are rebuilt below
+		buffer->pool_range = target;
+		array_push(live_size, size);
+		target_offset += size;
+		block_end[target] = target_offset;
+	}
+
+	bool rebuild = (moved > 0);
+	for (uint iblock = 0; movable && (iblock < block_count); ++iblock) {
+		if (pool->block[iblock] && !block_end[iblock])
+			rebuild = true;
+	}
+
+	if (rebuild) {
+		// Rebuild range nodes from the packed layout, with one free tail range per block. The first range
+		// array is reused to track the last range of each block
+		render_buffer_pool_reset(pool);
+		uint* block_last = block_first;
+		memset(block_last, 0xFF, sizeof(uint) * (block_count + 1));
+		uint prev = RENDER_BUFFER_POOL_INVALID;
+		uint prev_block = RENDER_BUFFER_POOL_INVALID;
+		for (size_t ilive = 0, lsize = array_size(live); ilive < lsize; ++ilive) {
+			render_buffer_t* buffer = live[ilive];
+			uint block = buffer->pool_range;
+			uint index = render_buffer_pool_node_allocate(pool);
+			render_buffer_pool_range_t* range = pool->range + index;
+			range->buffer = buffer;
+			range->block = block;
+			range->offset = buffer->offset;
+			range->size = live_size[ilive];
+			if (block == prev_block) {
+				range->prev_physical = prev;
+				pool->range[prev].next_physical = index;
+			}
+			buffer->pool_range = index;
+			block_last[block] = index;
+			prev = index;
+			prev_block = block;
+		}
+		for (uint iblock = 0; iblock < block_count; ++iblock) {
+			render_buffer_t* block = pool->block[iblock];
+			if (!block)
+				continue;
+			if (!block_end[iblock]) {
+				render_buffer_deallocate(block);
+				pool->block[iblock] = nullptr;
+				continue;
+			}
+			if (block_end[iblock] < block->allocated) {
+				uint last = block_last[iblock];
+				uint index = render_buffer_pool_node_allocate(pool);
+				pool->range[index].block = iblock;
+				pool->range[index].offset = block_end[iblock];
+				pool->range[index].size = (uint)block->allocated - block_end[iblock];
+				pool->range[index].prev_physical = last;
+				pool->range[last].next_physical = index;
+				render_buffer_pool_free_insert(pool, index);
+			}
+			block->flags |= RENDERBUFFER_DIRTY;
+			render_buffer_upload(block, 0, block_end[iblock]);
+		}
+		while (array_size(pool->block) && !pool->block[array_size(pool->block) - 1])
+			array_pop(pool->block);
+	} else {
+		// Layout is unchanged, restore range indices of the logical buffers
+		for (uint iblock = 0; iblock < block_count; ++iblock) {
+			for (uint irange = block_first[iblock]; irange != RENDER_BUFFER_POOL_INVALID;
+			     irange = pool->range[irange].next_physical) {
+				if (pool->range[irange].buffer)
+					pool->range[irange].buffer->pool_range = irange;
+			}
+		}
+	}
+
+	array_deallocate(live_size);
+	array_deallocate(live);
+	memory_deallocate(block_first);
+	memory_deallocate(block_end);
+	mutex_unlock(pool->lock);
+
+	return moved;
+}
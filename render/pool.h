@@ -0,0 +1,76 @@
+/* pool.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file pool.h
+    Suballocating buffer pool carving logical buffers out of a few large backend buffers. Ranges
+    are managed with a two-level segregated fit allocator. A logical buffer shares the render
+    index of its pool block and carries the byte offset of its range in the block, which must
+    be added to argument, index and vertex offsets when referenced by primitives. Logical buffers
+    are locked, uploaded and deallocated with the regular buffer interface.
+
+    Descriptor bindings carry no offset, backends bind the whole pool block from its start. A
+    logical buffer used as a primitive descriptor must be addressed with its offset by the shader,
+    for example through argument or instance data */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Allocate a buffer pool
+    \param backend Backend
+    \param usage Usage flags of the pool blocks (render_usage_t)
+    \param block_size Size of each pool block in bytes, 0 for RENDER_BUFFER_POOL_BLOCK_SIZE.
+                      Larger buffers are given a dedicated block
+    \param alignment Alignment of ranges in bytes, must be a power of two, 0 for default
+    \return Buffer pool */
+RENDER_API render_buffer_pool_t*
+render_buffer_pool_allocate(render_backend_t* backend, uint usage, size_t block_size, uint alignment);
+
+/*! Deallocate a buffer pool. All logical buffers must be deallocated before the pool
+    \param pool Buffer pool */
+RENDER_API void
+render_buffer_pool_deallocate(render_buffer_pool_t* pool);
+
+/*! Allocate a logical buffer from the pool, deallocate with render_buffer_deallocate
+    \param pool Buffer pool
+    \param buffer_size Size of buffer in bytes
+    \param data Initial data, can be null
+    \param data_size Size of initial data in bytes
+    \return Logical buffer, null if the range could not be allocated */
+RENDER_API render_buffer_t*
+render_buffer_pool_buffer_allocate(render_buffer_pool_t* pool, size_t buffer_size, const void* data,
+                                   size_t data_size);
+
+/*! Query pool usage and fragmentation
+    \param pool Buffer pool
+    \param statistics Statistics structure to fill */
+RENDER_API void
+render_buffer_pool_statistics(render_buffer_pool_t* pool, render_buffer_pool_statistics_t* statistics);
+
+/*! Compact the pool by packing logical buffers to the start of the pool blocks, in block order,
+    and release blocks left empty. Render index and offset of moved buffers change, so primitives
+    must not be queued concurrently. Primitives already queued, including frames in flight, keep
+    the previous render index and offset in argument, index and descriptor references and must be
+    queued again with the values read back from the moved buffers. Nothing is moved if any
+    logical buffer is locked or the blocks have no CPU storage
+    \param pool Buffer pool
+    \return Number of bytes moved */
+RENDER_API size_t
+render_buffer_pool_compact(render_buffer_pool_t* pool);
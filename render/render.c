@@ -37,7 +37,7 @@ render_module_initialize(render_config_t config) {
 	if (render_initialized)
 		return 0;
 
-	FOUNDATION_UNUSED(config);
+	render_config = config;
 
 	render_api_disabled[RENDERAPI_UNKNOWN] = true;
 	render_api_disabled[RENDERAPI_DEFAULT] = true;
@@ -57,6 +57,7 @@ render_module_finalize(void) {
 		return;
 
 	array_deallocate(render_backends_current);
+	render_trace_finalize();
 
 	render_initialized = false;
 }
@@ -26,10 +26,20 @@
 #include <render/hashstrings.h>
 #include <render/backend.h>
 #include <render/buffer.h>
+#include <render/command.h>
+#include <render/indirect.h>
+#include <render/layout.h>
 #include <render/pipeline.h>
+#include <render/pool.h>
 #include <render/projection.h>
+#include <render/residency.h>
+#include <render/ring.h>
 #include <render/shader.h>
+#include <render/slab.h>
+#include <render/table.h>
 #include <render/target.h>
+#include <render/trace.h>
+#include <render/upload.h>
 #include <render/import.h>
 #include <render/compile.h>
 
@@ -0,0 +1,317 @@
+/* residency.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+#include <stdlib.h>
+
+// Snapshots are run length encoded. A control byte below 128 is followed by control + 1 literal
+// bytes, otherwise the following byte is repeated control - 125 times
+#define RENDER_RESIDENCY_LITERAL_MAX 128
+#define RENDER_RESIDENCY_RUN_MIN 3
+#define RENDER_RESIDENCY_RUN_MAX 130
+
+static size_t
+render_buffer_residency_compress(const uint8_t* source, size_t size, uint8_t* dest) {
+	size_t in = 0;
+	size_t out = 0;
+	while (in < size) {
+		size_t run = 1;
+		while (((in + run) < size) && (run < RENDER_RESIDENCY_RUN_MAX) && (source[in + run] == source[in]))
+			++run;
+		if (run >= RENDER_RESIDENCY_RUN_MIN) {
+			dest[out++] = (uint8_t)(run + 125);
+			dest[out++] = source[in];
+			in += run;
+			continue;
+		}
+
+		// Literal span up to the start of the next run
+		size_t literal = 0;
+		while (((in + literal) < size) && (literal < RENDER_RESIDENCY_LITERAL_MAX)) {
+			const uint8_t* next = source + in + literal;
+			if (((in + literal + 2) < size) && (next[0] == next[1]) && (next[0] == next[2]))
+				break;
+			++literal;
+		}
+		dest[out++] = (uint8_t)(literal - 1);
+		memcpy(dest + out, source + in, literal);
+		out += literal;
+		in += literal;
+	}
+	return out;
+}
+
+static bool
+render_buffer_residency_decompress(const uint8_t* source, size_t size, uint8_t* dest, size_t capacity) {
+	size_t in = 0;
+	size_t out = 0;
+	while (in < size) {
+		uint control = source[in++];
+		if (control < RENDER_RESIDENCY_LITERAL_MAX) {
+			size_t literal = control + 1;
+			if (((in + literal) > size) || ((out + literal) > capacity))
+				return false;
+			memcpy(dest + out, source + in, literal);
+			in += literal;
+			out += literal;
+		} else {
+			size_t run = control - 125;
+			if ((in >= size) || ((out + run) > capacity))
+				return false;
+			memset(dest + out, source[in++], run);
+			out += run;
+		}
+	}
+	return (out == capacity);
+}
+
+void
+render_buffer_residency_initialize(render_backend_t* backend) {
+	memset(&backend->residency, 0, sizeof(render_buffer_residency_t));
+	backend->residency.lock = mutex_allocate(STRING_CONST("Buffer residency"));
+}
+
+void
+render_buffer_residency_finalize(render_backend_t* backend) {
+	render_buffer_residency_t* residency = &backend->residency;
+	if (array_size(residency->buffer))
+		log_warnf(HASH_RENDER, WARNING_MEMORY, STRING_CONST("Backend deallocated with %u tracked buffers"),
+		          (uint)array_size(residency->buffer));
+	for (size_t ibuf = 0, bsize = array_size(residency->buffer); ibuf < bsize; ++ibuf)
+		residency->buffer[ibuf]->residency_index = 0;
+	array_deallocate(residency->buffer);
+	array_deallocate(residency->candidate);
+	mutex_deallocate(residency->lock);
+	residency->lock = nullptr;
+}
+
+void
+render_buffer_residency_budget(render_backend_t* backend, size_t budget, uint frames) {
+	mutex_lock(backend->residency.lock);
+	backend->residency.budget = budget;
+	backend->residency.frames = frames;
+	mutex_unlock(backend->residency.lock);
+}
+
+void
+render_buffer_residency_track(render_buffer_t* buffer, render_buffer_restore_fn restore, void* userdata) {
+	if (buffer->pool || (buffer->backend->api == RENDERAPI_SOFTWARE)) {
+		log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Buffer storage is not evictable"));
+		return;
+	}
+	render_buffer_residency_t* residency = &buffer->backend->residency;
+	mutex_lock(residency->lock);
+	buffer->restore = restore;
+	buffer->restore_data = userdata;
+	if (!buffer->residency_index) {
+		array_push(residency->buffer, buffer);
+		buffer->residency_index = (uint)array_size(residency->buffer);
+		buffer->last_frame = buffer->backend->framecount;
+		if (buffer->flags & RENDERBUFFER_LOST)
+			residency->bytes_snapshot += buffer->snapshot_size;
+		else if (buffer->store)
+			residency->bytes_resident += buffer->allocated;
+	}
+	mutex_unlock(residency->lock);
+}
+
+// Remove a buffer from the tracked set, residency lock must be held
+static void
+render_buffer_residency_remove(render_buffer_residency_t* residency, render_buffer_t* buffer) {
+	if (buffer->flags & RENDERBUFFER_LOST)
+		residency->bytes_snapshot -= buffer->snapshot_size;
+	else if (buffer->store)
+		residency->bytes_resident -= buffer->allocated;
+	uint islot = buffer->residency_index - 1;
+	array_erase(residency->buffer, islot);
+	if (islot < array_size(residency->buffer))
+		residency->buffer[islot]->residency_index = islot + 1;
+	buffer->residency_index = 0;
+	buffer->restore = nullptr;
+	buffer->restore_data = nullptr;
+}
+
+void
+render_buffer_residency_untrack(render_buffer_t* buffer) {
+	if (!buffer->residency_index)
+		return;
+	render_buffer_residency_t* residency = &buffer->backend->residency;
+	mutex_lock(residency->lock);
+	render_buffer_residency_restore(buffer);
+	render_buffer_residency_remove(residency, buffer);
+	mutex_unlock(residency->lock);
+}
+
+void
+render_buffer_residency_discard(render_buffer_t* buffer) {
+	render_buffer_residency_t* residency = &buffer->backend->residency;
+	mutex_lock(residency->lock);
+	if (buffer->residency_index)
+		render_buffer_residency_remove(residency, buffer);
+	memory_deallocate(buffer->snapshot);
+	buffer->snapshot = nullptr;
+	buffer->snapshot_size = 0;
+	mutex_unlock(residency->lock);
+}
+
+void
+render_buffer_residency_statistics(render_backend_t* backend, render_buffer_residency_statistics_t* statistics) {
+	render_buffer_residency_t* residency = &backend->residency;
+	memset(statistics, 0, sizeof(render_buffer_residency_statistics_t));
+	mutex_lock(residency->lock);
+	statistics->tracked_count = (uint)array_size(residency->buffer);
+	for (uint ibuf = 0; ibuf < statistics->tracked_count; ++ibuf) {
+		if (residency->buffer[ibuf]->flags & RENDERBUFFER_LOST)
+			++statistics->evicted_count;
+	}
+	statistics->bytes_resident = residency->bytes_resident;
+	statistics->bytes_snapshot = residency->bytes_snapshot;
+	statistics->evictions = residency->evictions;
+	statistics->restores = residency->restores;
+	mutex_unlock(residency->lock);
+}
+
+void
+render_buffer_residency_evict(render_buffer_t* buffer, bool aux) {
+	if (buffer->pool || !buffer->store || (buffer->flags & RENDERBUFFER_LOST))
+		return;
+	render_backend_t* backend = buffer->backend;
+	render_buffer_residency_t* residency = &backend->residency;
+
+	void* snapshot = nullptr;
+	size_t snapshot_size = 0;
+	if (!buffer->restore && buffer->allocated) {
+		size_t capacity = buffer->allocated + (buffer->allocated / RENDER_RESIDENCY_LITERAL_MAX) + 1;
+		uint8_t* compressed = memory_allocate(HASH_RENDER, capacity, 0, MEMORY_TEMPORARY);
+		snapshot_size = render_buffer_residency_compress(buffer->store, buffer->allocated, compressed);
+		snapshot = memory_allocate(HASH_RENDER, snapshot_size, 0, MEMORY_PERSISTENT);
+		memcpy(snapshot, compressed, snapshot_size);
+		memory_deallocate(compressed);
+	}
+
+	void* store = buffer->store;
+	backend->vtable.buffer_deallocate(backend, buffer, true, aux);
+	if (!aux && (buffer->store == store)) {
+		// Storage is device memory kept by the backend, nothing was released
+		memory_deallocate(snapshot);
+		return;
+	}
+
+	// Any remaining store pointer maps the released GPU storage
+	buffer->store = nullptr;
+	buffer->snapshot = snapshot;
+	buffer->snapshot_size = snapshot_size;
+	buffer->flags |= RENDERBUFFER_LOST | (aux ? RENDERBUFFER_LOST_AUX : 0);
+	if (buffer->residency_index) {
+		residency->bytes_resident -= buffer->allocated;
+		residency->bytes_snapshot += snapshot_size;
+	}
+	++residency->evictions;
+}
+
+void
+render_buffer_residency_restore(render_buffer_t* buffer) {
+	if (!(buffer->flags & RENDERBUFFER_LOST))
+		return;
+	render_backend_t* backend = buffer->backend;
+	render_buffer_residency_t* residency = &backend->residency;
+
+	size_t used = buffer->used;
+	size_t size = buffer->allocated;
+	backend->vtable.buffer_allocate(backend, buffer, size, nullptr, 0);
+	buffer->used = used;
+
+	bool restored = false;
+	if (buffer->store) {
+		if (buffer->restore)
+			restored = buffer->restore(buffer, buffer->store, size, buffer->restore_data);
+		else
+			restored = render_buffer_residency_decompress(buffer->snapshot, buffer->snapshot_size, buffer->store, size);
+	}
+	if (!restored)
+		log_warn(HASH_RENDER, WARNING_RESOURCE, STRING_CONST("Unable to restore content of lost buffer"));
+
+	if (buffer->residency_index) {
+		residency->bytes_snapshot -= buffer->snapshot_size;
+		residency->bytes_resident += buffer->store ? size : 0;
+	}
+	memory_deallocate(buffer->snapshot);
+	buffer->snapshot = nullptr;
+	buffer->snapshot_size = 0;
+	++residency->restores;
+
+	bool aux = (buffer->flags & RENDERBUFFER_LOST_AUX);
+	buffer->flags &= ~(uint)(RENDERBUFFER_LOST | RENDERBUFFER_LOST_AUX);
+	if (aux && restored) {
+		buffer->flags &= ~(uint)RENDERBUFFER_DIRTY_RANGE;
+		buffer->flags |= RENDERBUFFER_DIRTY;
+		render_buffer_upload(buffer, 0, 0);
+	}
+}
+
+static int
+render_buffer_residency_compare(const void* lhs, const void* rhs) {
+	const render_buffer_t* lhs_buffer = *(render_buffer_t* const*)lhs;
+	const render_buffer_t* rhs_buffer = *(render_buffer_t* const*)rhs;
+	if (lhs_buffer->last_frame < rhs_buffer->last_frame)
+		return -1;
+	return (lhs_buffer->last_frame > rhs_buffer->last_frame) ? 1 : 0;
+}
+
+void
+render_buffer_residency_frame(render_backend_t* backend) {
+	render_buffer_residency_t* residency = &backend->residency;
+	if (!residency->budget)
+		return;
+	mutex_lock(residency->lock);
+	if ((residency->bytes_resident + residency->bytes_snapshot) > residency->budget) {
+		render_trace_begin("render_buffer_residency_frame");
+		// Candidates are buffers untouched for the configured number of frames with no pending upload,
+		// evicted oldest first
+		array_clear(residency->candidate);
+		for (size_t ibuf = 0, bsize = array_size(residency->buffer); ibuf < bsize; ++ibuf) {
+			render_buffer_t* buffer = residency->buffer[ibuf];
+			if (!buffer->store || (buffer->flags & (RENDERBUFFER_LOST | RENDERBUFFER_DIRTY)))
+				continue;
+			if ((backend->framecount - buffer->last_frame) >= residency->frames)
+				array_push(residency->candidate, buffer);
+		}
+		size_t candidate_count = array_size(residency->candidate);
+		if (candidate_count)
+			qsort(residency->candidate, candidate_count, sizeof(render_buffer_t*), render_buffer_residency_compare);
+
+		for (size_t ibuf = 0; ibuf < candidate_count; ++ibuf) {
+			if ((residency->bytes_resident + residency->bytes_snapshot) <= residency->budget)
+				break;
+			// Hold the write lock during eviction, skipping buffers locked by other threads
+			render_buffer_t* buffer = residency->candidate[ibuf];
+			if (!atomic_cas32(&buffer->lock_state, RENDERBUFFER_STATE_WRITER, 0, memory_order_acquire,
+			                  memory_order_relaxed))
+				continue;
+			render_buffer_residency_evict(buffer, false);
+			atomic_add32(&buffer->lock_state, -RENDERBUFFER_STATE_WRITER, memory_order_release);
+			render_buffer_lock_wake(buffer);
+		}
+		render_trace_end("render_buffer_residency_frame");
+	}
+	mutex_unlock(residency->lock);
+}
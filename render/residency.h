@@ -0,0 +1,56 @@
+/* residency.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file residency.h
+    Residency management of buffer CPU storage. Tracked buffers that have not been locked for a
+    number of frames have their CPU storage released in least recently used order when the resident
+    storage exceeds the budget of the backend. The storage is restored transparently on the next
+    lock, either from a compressed snapshot taken on eviction or through a restore callback */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Set budget of resident CPU storage for tracked buffers of a backend. Eviction is done when a
+    pipeline of the backend is flushed
+    \param backend Backend
+    \param budget Budget in bytes, 0 to disable eviction
+    \param frames Number of frames a buffer must be untouched before it can be evicted */
+RENDER_API void
+render_buffer_residency_budget(render_backend_t* backend, size_t budget, uint frames);
+
+/*! Track a buffer for eviction. Buffers read by the backend without locking them, like logical
+    pool buffers or the storage of the software backend, are not evictable
+    \param buffer Buffer
+    \param restore Callback reloading the content of the buffer, null to keep a compressed snapshot
+    \param userdata Userdata passed to the restore callback */
+RENDER_API void
+render_buffer_residency_track(render_buffer_t* buffer, render_buffer_restore_fn restore, void* userdata);
+
+/*! Stop tracking a buffer, restoring the storage if evicted. Buffers are untracked when deallocated
+    \param buffer Buffer */
+RENDER_API void
+render_buffer_residency_untrack(render_buffer_t* buffer);
+
+/*! Get residency statistics of a backend
+    \param backend Backend
+    \param statistics Statistics */
+RENDER_API void
+render_buffer_residency_statistics(render_backend_t* backend, render_buffer_residency_statistics_t* statistics);
@@ -0,0 +1,133 @@
+/* ring.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+//! Default alignment of allocations, matching the size of a four component float vector
+#define RENDER_RING_BUFFER_ALIGNMENT 16
+
+render_ring_buffer_t*
+render_ring_buffer_allocate(render_pipeline_t* pipeline, size_t size, uint alignment) {
+	if (!alignment)
+		alignment = RENDER_RING_BUFFER_ALIGNMENT;
+	FOUNDATION_ASSERT(!(alignment & (alignment - 1)));
+	// Used offset of a region is an atomic 32-bit counter
+	if (size > (size_t)INT32_MAX)
+		size = (size_t)INT32_MAX;
+
+	render_buffer_t* buffer = render_buffer_allocate(pipeline->backend, RENDERUSAGE_RENDER, size, nullptr, 0);
+	if (!buffer->store) {
+		log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Backend did not provide CPU storage for ring buffer"));
+		render_buffer_deallocate(buffer);
+		return nullptr;
+	}
+	render_buffer_set_label(buffer, STRING_CONST("Ring buffer"));
+
+	render_ring_buffer_t* ring =
+	    memory_allocate(HASH_RENDER, sizeof(render_ring_buffer_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	ring->pipeline = pipeline;
+	ring->buffer = buffer;
+	ring->alignment = alignment;
+	render_ring_buffer_frame(ring, pipeline->frame_current, pipeline->frame_count);
+	array_push(pipeline->ring_buffer, ring);
+	return ring;
+}
+
+void
+render_ring_buffer_deallocate(render_ring_buffer_t* ring) {
+	if (!ring)
+		return;
+	render_pipeline_t* pipeline = ring->pipeline;
+	for (size_t iring = 0, rsize = array_size(pipeline->ring_buffer); iring < rsize; ++iring) {
+		if (pipeline->ring_buffer[iring] == ring) {
+			array_erase(pipeline->ring_buffer, iring);
+			break;
+		}
+	}
+	render_buffer_deallocate(ring->buffer);
+	memory_deallocate(ring);
+}
+
+render_ring_allocation_t
+render_ring_buffer_reserve(render_ring_buffer_t* ring, size_t size) {
+	render_ring_allocation_t allocation;
+	memset(&allocation, 0, sizeof(allocation));
+	if (size > ring->region_size) {
+		atomic_incr32(&ring->dropped, memory_order_relaxed);
+		return allocation;
+	}
+
+	uint aligned = (uint)(size + (ring->alignment - 1)) & ~(ring->alignment - 1);
+	uint offset;
+	while (true) {
+		offset = (uint)atomic_load32(&ring->used, memory_order_relaxed);
+		if (offset + aligned > ring->region_size) {
+			atomic_incr32(&ring->dropped, memory_order_relaxed);
+			return allocation;
+		}
+		if (atomic_cas32(&ring->used, (int32_t)(offset + aligned), (int32_t)offset, memory_order_relaxed,
+		                 memory_order_relaxed))
+			break;
+	}
+
+	allocation.render_index = ring->buffer->render_index;
+	allocation.offset = ring->region_offset + offset;
+	allocation.pointer = pointer_offset(ring->buffer->store, allocation.offset);
+	return allocation;
+}
+
+size_t
+render_ring_buffer_region_size(render_ring_buffer_t* ring) {
+	return ring->region_size;
+}
+
+size_t
+render_ring_buffer_high_water(render_ring_buffer_t* ring) {
+	return ring->high_water;
+}
+
+uint64_t
+render_ring_buffer_dropped(render_ring_buffer_t* ring) {
+	return ring->dropped_total + (uint64_t)atomic_load32(&ring->dropped, memory_order_relaxed);
+}
+
+void
+render_ring_buffer_flush(render_ring_buffer_t* ring) {
+	uint used = (uint)atomic_load32(&ring->used, memory_order_acquire);
+	if (used > ring->high_water)
+		ring->high_water = used;
+	ring->dropped_total += (uint64_t)atomic_load32(&ring->dropped, memory_order_relaxed);
+	atomic_store32(&ring->dropped, 0, memory_order_relaxed);
+	if (used) {
+		ring->buffer->flags |= RENDERBUFFER_DIRTY;
+		render_buffer_upload(ring->buffer, ring->region_offset, used);
+	}
+}
+
+void
+render_ring_buffer_frame(render_ring_buffer_t* ring, uint frame, uint frame_count) {
+	if (frame_count != ring->region_count) {
+		ring->region_count = frame_count;
+		ring->region_size = (uint)(ring->buffer->allocated / frame_count) & ~(ring->alignment - 1);
+	}
+	ring->region_offset = frame * ring->region_size;
+	atomic_store32(&ring->used, 0, memory_order_release);
+}
@@ -0,0 +1,69 @@
+/* ring.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file ring.h
+    Transient per-frame ring allocator for dynamic render data. A single render buffer is split in
+    one region per pipeline frame in flight, allocations bump a lock-free offset in the region of
+    the frame being recorded. The region is uploaded when the pipeline is flushed and reused once
+    the backend has consumed the frame */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Allocate a ring buffer attached to a pipeline. The ring buffer is deallocated with the pipeline
+    if not deallocated before
+    \param pipeline Pipeline
+    \param size Total size in bytes, split in one region per frame in flight
+    \param alignment Alignment of allocations in bytes, must be a power of two, 0 for default
+    \return Ring buffer, null if the buffer could not be allocated */
+RENDER_API render_ring_buffer_t*
+render_ring_buffer_allocate(render_pipeline_t* pipeline, size_t size, uint alignment);
+
+/*! Deallocate a ring buffer and detach it from the pipeline
+    \param ring Ring buffer */
+RENDER_API void
+render_ring_buffer_deallocate(render_ring_buffer_t* ring);
+
+/*! Allocate transient memory valid for the frame being recorded. Thread safe and lock-free
+    \param ring Ring buffer
+    \param size Size in bytes
+    \return Render index of the buffer, byte offset and CPU pointer of the allocation, pointer is
+            null if the region of the frame is exhausted */
+RENDER_API render_ring_allocation_t
+render_ring_buffer_reserve(render_ring_buffer_t* ring, size_t size);
+
+/*! Query size of the region available to a single frame
+    \param ring Ring buffer
+    \return Region size in bytes */
+RENDER_API size_t
+render_ring_buffer_region_size(render_ring_buffer_t* ring);
+
+/*! Query the highest number of bytes allocated in a single frame
+    \param ring Ring buffer
+    \return Bytes allocated */
+RENDER_API size_t
+render_ring_buffer_high_water(render_ring_buffer_t* ring);
+
+/*! Query the number of allocations that failed since the region of the frame was exhausted
+    \param ring Ring buffer
+    \return Number of failed allocations */
+RENDER_API uint64_t
+render_ring_buffer_dropped(render_ring_buffer_t* ring);
@@ -67,6 +67,7 @@ render_shader_load(render_backend_t* backend, const uuid_t uuid) {
 	if (shader)
 		return shader;
 
+	render_trace_begin("render_shader_load");
 	uint64_t platform = render_backend_resource_platform(backend);
 	stream_t* stream;
 	resource_header_t header;
@@ -89,6 +90,7 @@ retry:
 			if (shader) {
 				stream_read(stream, shader, sizeof(render_shader_t));
 				shader->backend = nullptr;
+				shader->size = 0;
 			}
 		}
 		if (!shader && !recompiled) {
@@ -140,12 +142,14 @@ retry:
 	}
 
 	error_context_pop();
+	render_trace_end("render_shader_load");
 
 	return shader;
 }
 
 bool
 render_shader_reload(render_shader_t* shader, const uuid_t uuid) {
+	render_trace_begin("render_shader_reload");
 	error_context_declare_local(char uuidbuf[40];
 	                            const string_t uuidstr = string_from_uuid(uuidbuf, sizeof(uuidbuf), uuid));
 	error_context_push(STRING_CONST("reloading shader"), STRING_ARGS(uuidstr));
@@ -163,6 +167,7 @@ render_shader_reload(render_shader_t* shader, const uuid_t uuid) {
 			if (header.type == HASH_SHADER) {
 				render_shader_initialize(&tmpshader);
 				stream_read(stream, &tmpshader, sizeof(render_shader_t));
+				tmpshader.size = 0;
 				success = true;
 			}
 		}
@@ -197,11 +202,15 @@ render_shader_reload(render_shader_t* shader, const uuid_t uuid) {
 		memcpy(swapdata, shader->backend_data, sizeof(swapdata));
 		memcpy(shader->backend_data, tmpshader.backend_data, sizeof(shader->backend_data));
 		memcpy(tmpshader.backend_data, swapdata, sizeof(swapdata));
+		uint32_t swapsize = shader->size;
+		shader->size = tmpshader.size;
+		tmpshader.size = swapsize;
 	}
 
 	render_backend_shader_finalize(backend, &tmpshader);
 
 	error_context_pop();
+	render_trace_end("render_shader_reload");
 
 	return success;
 }
@@ -0,0 +1,152 @@
+/* slab.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+#define RENDER_SLAB_OBJECT_MASK (RENDER_SLAB_OBJECT_COUNT - 1)
+#define RENDER_HANDLE_INDEX_MASK ((1U << RENDER_HANDLE_INDEX_BITS) - 1)
+#define RENDER_HANDLE_GENERATION_MASK ((1U << (32 - RENDER_HANDLE_INDEX_BITS)) - 1)
+
+#define RENDER_HANDLE(index, generation) ((render_handle_t)(((generation) << RENDER_HANDLE_INDEX_BITS) | (index)))
+#define RENDER_HANDLE_INDEX(handle) ((uint)(handle) & RENDER_HANDLE_INDEX_MASK)
+
+void
+render_slab_initialize(render_slab_t* slab, size_t object_size) {
+	memset(slab, 0, sizeof(render_slab_t));
+	// Objects are 16 byte aligned, placed after the slot array of the slab
+	slab->stride = (uint)((object_size + 15) & ~(size_t)15);
+	slab->offset = (uint)((sizeof(render_slab_slot_t) * RENDER_SLAB_OBJECT_COUNT + 63) & ~(size_t)63);
+	slab->lock = mutex_allocate(STRING_CONST("Render slab pool"));
+	atomic_store32(&slab->used, 0, memory_order_release);
+}
+
+void
+render_slab_finalize(render_slab_t* slab) {
+	for (uint islab = 0; islab < RENDER_SLAB_COUNT; ++islab) {
+		memory_deallocate(atomic_load_ptr(&slab->slab[islab], memory_order_acquire));
+		atomic_store_ptr(&slab->slab[islab], nullptr, memory_order_relaxed);
+	}
+	mutex_deallocate(slab->lock);
+	slab->lock = nullptr;
+}
+
+static render_slab_slot_t*
+render_slab_slot(render_slab_t* slab, uint index, void** object) {
+	void* block = atomic_load_ptr(&slab->slab[index / RENDER_SLAB_OBJECT_COUNT], memory_order_acquire);
+	if (!block)
+		return nullptr;
+	if (object)
+		*object = pointer_offset(block, slab->offset + (slab->stride * (index & RENDER_SLAB_OBJECT_MASK)));
+	return (render_slab_slot_t*)block + (index & RENDER_SLAB_OBJECT_MASK);
+}
+
+void*
+render_slab_allocate(render_slab_t* slab, render_handle_t* handle) {
+	void* object = nullptr;
+	render_slab_slot_t* slot = nullptr;
+	uint index;
+
+	mutex_lock(slab->lock);
+	if (slab->free) {
+		index = slab->free - 1;
+		slot = render_slab_slot(slab, index, &object);
+		slab->free = slot->next_free;
+	} else {
+		index = (uint)atomic_load32(&slab->used, memory_order_relaxed);
+		if (index > RENDER_HANDLE_INDEX_MASK) {
+			mutex_unlock(slab->lock);
+			log_errorf(HASH_RENDER, ERROR_OUT_OF_MEMORY, STRING_CONST("Render slab pool exhausted at %u objects"),
+			           index);
+			*handle = 0;
+			return nullptr;
+		}
+		atomicptr_t* block = &slab->slab[index / RENDER_SLAB_OBJECT_COUNT];
+		if (!atomic_load_ptr(block, memory_order_relaxed)) {
+			void* storage =
+			    memory_allocate(HASH_RENDER, slab->offset + ((size_t)slab->stride * RENDER_SLAB_OBJECT_COUNT), 64,
+			                    MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+			atomic_store_ptr(block, storage, memory_order_release);
+		}
+		slot = render_slab_slot(slab, index, &object);
+		atomic_store32(&slab->used, (int32_t)(index + 1), memory_order_release);
+	}
+
+	// Generation 0 is skipped so that no valid handle is 0
+	if (!slot->generation)
+		slot->generation = 1;
+	*handle = RENDER_HANDLE(index, slot->generation);
+	++slab->count;
+	memset(object, 0, slab->stride);
+	atomic_store32(&slot->handle, (int32_t)*handle, memory_order_release);
+	mutex_unlock(slab->lock);
+
+	return object;
+}
+
+bool
+render_slab_free(render_slab_t* slab, render_handle_t handle) {
+	uint index = RENDER_HANDLE_INDEX(handle);
+	mutex_lock(slab->lock);
+	render_slab_slot_t* slot = handle ? render_slab_slot(slab, index, nullptr) : nullptr;
+	if (!slot || ((render_handle_t)atomic_load32(&slot->handle, memory_order_relaxed) != handle)) {
+		mutex_unlock(slab->lock);
+		return false;
+	}
+	atomic_store32(&slot->handle, 0, memory_order_release);
+	slot->generation = (slot->generation + 1) & RENDER_HANDLE_GENERATION_MASK;
+	slot->next_free = slab->free;
+	slab->free = index + 1;
+	--slab->count;
+	mutex_unlock(slab->lock);
+	return true;
+}
+
+void*
+render_slab_lookup(render_slab_t* slab, render_handle_t handle) {
+	void* object = nullptr;
+	render_slab_slot_t* slot = handle ? render_slab_slot(slab, RENDER_HANDLE_INDEX(handle), &object) : nullptr;
+	if (!slot || ((render_handle_t)atomic_load32(&slot->handle, memory_order_acquire) != handle))
+		return nullptr;
+	return object;
+}
+
+void*
+render_slab_next(render_slab_t* slab, uint* slot) {
+	uint used = (uint)atomic_load32(&slab->used, memory_order_acquire);
+	for (uint index = *slot; index < used; ++index) {
+		void* object = nullptr;
+		render_slab_slot_t* slab_slot = render_slab_slot(slab, index, &object);
+		if (atomic_load32(&slab_slot->handle, memory_order_acquire)) {
+			*slot = index + 1;
+			return object;
+		}
+	}
+	*slot = used;
+	return nullptr;
+}
+
+uint
+render_slab_count(render_slab_t* slab) {
+	mutex_lock(slab->lock);
+	uint count = slab->count;
+	mutex_unlock(slab->lock);
+	return count;
+}
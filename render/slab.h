@@ -0,0 +1,77 @@
+/* slab.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file slab.h
+    Slab pool of fixed size objects addressed by 32-bit generational handles. Objects are stored
+    contiguously in slabs allocated on demand and never moved, freed slots are recycled through a
+    free list. The low RENDER_HANDLE_INDEX_BITS bits of a handle are the slot index and the high
+    bits the generation of the slot, which is bumped on release so stale handles fail to resolve.
+    Handle 0 is invalid */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Initialize a slab pool
+    \param slab Slab pool
+    \param object_size Size of an object in bytes */
+RENDER_API void
+render_slab_initialize(render_slab_t* slab, size_t object_size);
+
+/*! Finalize a slab pool and release all slabs. Objects still allocated are released without
+    being finalized
+    \param slab Slab pool */
+RENDER_API void
+render_slab_finalize(render_slab_t* slab);
+
+/*! Allocate a zero initialized object. Thread safe
+    \param slab Slab pool
+    \param handle Receives the handle of the object
+    \return Object, null if the pool is at capacity */
+RENDER_API void*
+render_slab_allocate(render_slab_t* slab, render_handle_t* handle);
+
+/*! Release an object. Thread safe
+    \param slab Slab pool
+    \param handle Handle of the object
+    \return true if released, false if the handle is stale or invalid */
+RENDER_API bool
+render_slab_free(render_slab_t* slab, render_handle_t handle);
+
+/*! Resolve a handle to the object. Thread safe and lock-free
+    \param slab Slab pool
+    \param handle Handle
+    \return Object, null if the handle is stale or invalid */
+RENDER_API void*
+render_slab_lookup(render_slab_t* slab, render_handle_t handle);
+
+/*! Iterate live objects in slot order. Not safe against concurrent allocation or release
+    \param slab Slab pool
+    \param slot Slot to start searching from, updated to the slot after the returned object.
+                Initialize to 0 to start iteration
+    \return Next live object, null if no more objects */
+RENDER_API void*
+render_slab_next(render_slab_t* slab, uint* slot);
+
+/*! Query the number of live objects
+    \param slab Slab pool
+    \return Number of live objects */
+RENDER_API uint
+render_slab_count(render_slab_t* slab);
@@ -0,0 +1,915 @@
+/* backend.c  -  Render library  -  Public Domain  -  2014 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+#include <window/window.h>
+#include <vector/vector.h>
+#include <task/task.h>
+#include <render/render.h>
+#include <render/internal.h>
+
+#include <render/software/backend.h>
+
+#if FOUNDATION_ARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+typedef struct render_backend_software_t {
+	render_backend_t backend;
+	//! Render index table of render buffers, index 0 is reserved
+	render_index_table_t buffer_table;
+	//! Shaders of pipeline states, state 0 is reserved
+	render_shader_t** pipeline_state;
+} render_backend_software_t;
+
+//! Triangle set up for rasterization, attributes are stored as screen space plane equations
+typedef struct rb_software_triangle_t {
+	//! Edge functions e(x, y) = a * x + b * y + c, positive inside
+	float edge[3][3];
+	//! Depth plane and inverse w plane
+	float depth[3];
+	float inverse_w[3];
+	//! Varying divided by w planes
+	float varying[RENDER_SOFTWARE_VARYING_MAX][3];
+	int min_x;
+	int min_y;
+	int max_x;
+	int max_y;
+	const render_software_shader_t* shader;
+	const void* descriptor[4];
+} rb_software_triangle_t;
+
+typedef struct render_pipeline_software_t render_pipeline_software_t;
+
+//! Draw decoded from the command stream, with the state bound at the draw
+typedef struct rb_software_draw_t {
+	const render_software_shader_t* shader;
+	const void* descriptor[4];
+	const void* index_store;
+	uint index_count;
+	uint vertex_base;
+	uint instance_base;
+	uint instance_count;
+} rb_software_draw_t;
+
+//! Vertex shading and triangle setup work item for a range of draws
+typedef struct rb_software_setup_t {
+	render_pipeline_software_t* pipeline;
+	uint draw_first;
+	uint draw_end;
+	//! Triangles set up from the draw range, in submission order
+	rb_software_triangle_t* triangle;
+} rb_software_setup_t;
+
+//! Rasterization work item for one tile
+typedef struct rb_software_tile_t {
+	render_pipeline_software_t* pipeline;
+	uint index;
+	//! Triangle indices binned to the tile, in submission order
+	uint* triangle;
+} rb_software_tile_t;
+
+struct render_pipeline_software_t {
+	render_pipeline_t pipeline;
+	uint32_t color_clear;
+	float depth_clear;
+	render_clear_action_t color_clear_action;
+	render_clear_action_t depth_clear_action;
+	//! Depth attachment tested in current flush, null if missing or not matching the color attachment
+	render_target_t* depth_target;
+	//! Size of the color attachment in current flush
+	uint width;
+	uint height;
+	//! Draws of last flush, and setup work items over ranges of them
+	rb_software_draw_t* draw;
+	rb_software_setup_t* setup;
+	uint setup_count;
+	task_t* setup_task;
+	//! Triangles set up in last flush, merged from setup work items in submission order
+	rb_software_triangle_t* triangle;
+	//! Tiles covering the color attachment
+	rb_software_tile_t* tile;
+	uint tile_columns;
+	uint tile_rows;
+	task_t* task;
+	//! Number of tasks outstanding in the current stage of the flush
+	atomic32_t task_pending;
+	//! Number of fragments written in last flush
+	atomic32_t fragment_count;
+};
+
+static bool
+rb_software_construct(render_backend_t* backend) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	backend->shader_type = HASH_SHADER;
+	render_index_table_initialize(&backend_software->buffer_table, 0);
+	array_push(backend_software->pipeline_state, nullptr);
+	log_debug(HASH_RENDER, STRING_CONST("Constructed software render backend"));
+	return true;
+}
+
+static void
+rb_software_destruct(render_backend_t* backend) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	array_deallocate(backend_software->pipeline_state);
+	render_index_table_finalize(&backend_software->buffer_table);
+	log_debug(HASH_RENDER, STRING_CONST("Destructed software render backend"));
+}
+
+static size_t
+rb_software_enumerate_adapters(render_backend_t* backend, unsigned int* store, size_t capacity) {
+	FOUNDATION_UNUSED(backend);
+	if (capacity)
+		store[0] = (unsigned int)WINDOW_ADAPTER_DEFAULT;
+	return 1;
+}
+
+static size_t
+rb_software_enumerate_modes(render_backend_t* backend, unsigned int adapter, render_resolution_t* store,
+                            size_t capacity) {
+	FOUNDATION_UNUSED(backend);
+	FOUNDATION_UNUSED(adapter);
+	if (capacity) {
+		render_resolution_t mode = {0, 800, 600, PIXELFORMAT_R8G8B8A8, 60};
+		store[0] = mode;
+	}
+	return 1;
+}
+
+static render_target_t*
+rb_software_target_allocate(render_backend_t* backend, render_target_type_t type, uint width, uint height,
+                            render_pixelformat_t format) {
+	render_target_t* target =
+	    memory_allocate(HASH_RENDER, sizeof(render_target_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	target->backend = backend;
+	target->width = width;
+	target->height = height;
+	target->type = type;
+	target->pixelformat = format;
+	target->colorspace = COLORSPACE_sRGB;
+	render_target_storage_allocate(target);
+	return target;
+}
+
+static render_target_t*
+rb_software_target_window_allocate(render_backend_t* backend, window_t* window, uint tag) {
+	FOUNDATION_UNUSED(tag);
+	// Window targets are rendered to memory, presentation is not implemented
+	return rb_software_target_allocate(backend, RENDERTARGET_WINDOW, window_width(window), window_height(window),
+	                                   PIXELFORMAT_R8G8B8A8);
+}
+
+static render_target_t*
+rb_software_target_texture_allocate(render_backend_t* backend, uint width, uint height, render_pixelformat_t format) {
+	return rb_software_target_allocate(backend, RENDERTARGET_TEXTURE, width, height, format);
+}
+
+static void
+rb_software_target_deallocate(render_backend_t* backend, render_target_t* target) {
+	FOUNDATION_UNUSED(backend);
+	if (target)
+		render_target_storage_deallocate(target);
+	memory_deallocate(target);
+}
+
+static bool
+rb_software_target_read_pixels(render_backend_t* backend, render_target_t* target, const render_rect_t* rect,
+                               void* dst, render_target_read_fn callback, void* context) {
+	// Targets with CPU storage are read directly, only reached for targets without storage
+	FOUNDATION_UNUSED(backend, target, rect, dst, callback, context);
+	return false;
+}
+
+static render_pipeline_t*
+rb_software_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
+	render_pipeline_software_t* pipeline_software = memory_allocate(HASH_RENDER, sizeof(render_pipeline_software_t),
+	                                                                0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	render_pipeline_t* pipeline = (render_pipeline_t*)pipeline_software;
+	pipeline->backend = backend;
+	pipeline->primitive_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(render_primitive_t) * capacity, 0, 0);
+	pipeline->index_format = index_format;
+	pipeline_software->depth_clear = 1.0f;
+	return pipeline;
+}
+
+static void
+rb_software_pipeline_deallocate(render_backend_t* backend, render_pipeline_t* pipeline) {
+	FOUNDATION_UNUSED(backend);
+	if (pipeline) {
+		render_pipeline_software_t* pipeline_software = (render_pipeline_software_t*)pipeline;
+		for (uint itile = 0, tsize = pipeline_software->tile_columns * pipeline_software->tile_rows; itile < tsize;
+		     ++itile)
+			array_deallocate(pipeline_software->tile[itile].triangle);
+		memory_deallocate(pipeline_software->tile);
+		memory_deallocate(pipeline_software->task);
+		for (size_t isetup = 0, ssize = array_size(pipeline_software->setup); isetup < ssize; ++isetup)
+			array_deallocate(pipeline_software->setup[isetup].triangle);
+		array_deallocate(pipeline_software->setup);
+		array_deallocate(pipeline_software->setup_task);
+		array_deallocate(pipeline_software->draw);
+		array_deallocate(pipeline_software->triangle);
+		render_buffer_deallocate(pipeline->primitive_buffer);
+	}
+	memory_deallocate(pipeline);
+}
+
+static void
+rb_software_pipeline_set_color_attachment(render_backend_t* backend, render_pipeline_t* pipeline, uint slot,
+                                          render_target_t* target) {
+	FOUNDATION_UNUSED(backend);
+	if (slot < RENDER_TARGET_COLOR_ATTACHMENT_COUNT)
+		pipeline->color_attachment[slot] = target;
+}
+
+static void
+rb_software_pipeline_set_depth_attachment(render_backend_t* backend, render_pipeline_t* pipeline,
+                                          render_target_t* target) {
+	FOUNDATION_UNUSED(backend);
+	pipeline->depth_attachment = target;
+}
+
+static uint32_t
+rb_software_pack_color(vector_t color) {
+	float component[4] = {vector_x(color), vector_y(color), vector_z(color), vector_w(color)};
+	uint32_t packed = 0;
+	for (uint icomp = 0; icomp < 4; ++icomp) {
+		float value = math_clamp(component[icomp], 0.0f, 1.0f);
+		packed |= ((uint32_t)(value * 255.0f + 0.5f)) << (icomp * 8);
+	}
+	return packed;
+}
+
+static void
+rb_software_pipeline_set_color_clear(render_backend_t* backend, render_pipeline_t* pipeline, uint slot,
+                                     render_clear_action_t action, vector_t color) {
+	FOUNDATION_UNUSED(backend);
+	// Only the first color attachment is rasterized
+	if (slot)
+		return;
+	render_pipeline_software_t* pipeline_software = (render_pipeline_software_t*)pipeline;
+	pipeline_software->color_clear_action = action;
+	pipeline_software->color_clear = rb_software_pack_color(color);
+}
+
+static void
+rb_software_pipeline_set_depth_clear(render_backend_t* backend, render_pipeline_t* pipeline,
+                                     render_clear_action_t action, vector_t color) {
+	FOUNDATION_UNUSED(backend);
+	render_pipeline_software_t* pipeline_software = (render_pipeline_software_t*)pipeline;
+	pipeline_software->depth_clear_action = action;
+	pipeline_software->depth_clear = vector_x(color);
+}
+
+static void
+rb_software_pipeline_build(render_backend_t* backend, render_pipeline_t* pipeline) {
+	FOUNDATION_UNUSED(backend, pipeline);
+}
+
+//! Plane equation of an attribute from its value at the three vertices
+static void
+rb_software_plane(const rb_software_triangle_t* triangle, float inverse_area, float v0, float v1, float v2,
+                  float* plane) {
+	// Edge 0 is opposite vertex 0, weight of vertex i is edge i over area
+	for (uint icoeff = 0; icoeff < 3; ++icoeff)
+		plane[icoeff] = (triangle->edge[0][icoeff] * v0 + triangle->edge[1][icoeff] * v1 +
+		                 triangle->edge[2][icoeff] * v2) *
+		                inverse_area;
+}
+
+//! Set up a triangle from clip space vertices, culled triangles are dropped
+static void
+rb_software_triangle_setup(rb_software_setup_t* setup, const render_software_shader_t* shader,
+                           const void* const* descriptor, float position[3][4],
+                           float varying[3][RENDER_SOFTWARE_VARYING_MAX], uint width, uint height) {
+	float x[3], y[3], z[3], inverse_w[3];
+	for (uint ivert = 0; ivert < 3; ++ivert) {
+		// Near plane clipping is not implemented, reject triangles crossing w = 0
+		if (position[ivert][3] <= 0.00001f)
+			return;
+		inverse_w[ivert] = 1.0f / position[ivert][3];
+		x[ivert] = ((position[ivert][0] * inverse_w[ivert]) * 0.5f + 0.5f) * (float)width;
+		y[ivert] = (0.5f - (position[ivert][1] * inverse_w[ivert]) * 0.5f) * (float)height;
+		z[ivert] = position[ivert][2] * inverse_w[ivert];
+	}
+
+	// Counter clockwise front faces are clockwise in screen space with y down, cull back faces
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+	if (area >= 0.0f)
+		return;
+
+	rb_software_triangle_t triangle;
+	// Swap vertex 1 and 2 to get positive area and edge functions positive inside
+	const uint order[3] = {0, 2, 1};
+	float sx[3], sy[3];
+	for (uint ivert = 0; ivert < 3; ++ivert) {
+		sx[ivert] = x[order[ivert]];
+		sy[ivert] = y[order[ivert]];
+	}
+	for (uint iedge = 0; iedge < 3; ++iedge) {
+		uint i = (iedge + 1) % 3;
+		uint j = (iedge + 2) % 3;
+		triangle.edge[iedge][0] = sy[i] - sy[j];
+		triangle.edge[iedge][1] = sx[j] - sx[i];
+		triangle.edge[iedge][2] = sx[i] * sy[j] - sx[j] * sy[i];
+	}
+	float inverse_area = 1.0f / -area;
+	uint v0 = order[0], v1 = order[1], v2 = order[2];
+	rb_software_plane(&triangle, inverse_area, z[v0], z[v1], z[v2], triangle.depth);
+	rb_software_plane(&triangle, inverse_area, inverse_w[v0], inverse_w[v1], inverse_w[v2], triangle.inverse_w);
+	for (uint ivar = 0; ivar < shader->varying_count; ++ivar)
+		rb_software_plane(&triangle, inverse_area, varying[v0][ivar] * inverse_w[v0],
+		                  varying[v1][ivar] * inverse_w[v1], varying[v2][ivar] * inverse_w[v2],
+		                  triangle.varying[ivar]);
+
+	float min_x = math_min(sx[0], math_min(sx[1], sx[2]));
+	float min_y = math_min(sy[0], math_min(sy[1], sy[2]));
+	float max_x = math_max(sx[0], math_max(sx[1], sx[2]));
+	float max_y = math_max(sy[0], math_max(sy[1], sy[2]));
+	triangle.min_x = math_clamp((int)math_floor(min_x), 0, (int)width);
+	triangle.min_y = math_clamp((int)math_floor(min_y), 0, (int)height);
+	triangle.max_x = math_clamp((int)math_ceil(max_x), 0, (int)width);
+	triangle.max_y = math_clamp((int)math_ceil(max_y), 0, (int)height);
+	if ((triangle.min_x >= triangle.max_x) || (triangle.min_y >= triangle.max_y))
+		return;
+
+	triangle.shader = shader;
+	memcpy(triangle.descriptor, descriptor, sizeof(triangle.descriptor));
+	array_push_memcpy(setup->triangle, &triangle);
+}
+
+//! Decode the draws of the pipeline command stream with the state bound at each draw, and split them in
+//! setup work items of at least RENDER_SOFTWARE_SETUP_TRIANGLES triangles
+static void
+rb_software_pipeline_decode(render_backend_software_t* backend_software,
+                            render_pipeline_software_t* pipeline_software) {
+	render_pipeline_t* pipeline = (render_pipeline_t*)pipeline_software;
+	render_backend_t* backend = (render_backend_t*)backend_software;
+	const render_software_shader_t* shader = nullptr;
+	const render_buffer_t* argument_buffer = nullptr;
+	const render_buffer_t* index_buffer = nullptr;
+	const void* descriptor[4] = {0, 0, 0, 0};
+	uint instance_override = 0;
+	const uint index_size = (pipeline->index_format == RENDER_INDEXFORMAT_UINT16) ? 2 : 4;
+
+	array_clear(pipeline_software->draw);
+	pipeline_software->setup_count = 0;
+	uint setup_triangles = 0;
+	render_pipeline_counters_t* statistics = &pipeline->statistics_frame;
+	const render_command_t* command = pipeline->command.command;
+	for (uint icmd = 0, cmdcount = pipeline->command.count; icmd < cmdcount; ++icmd, ++command) {
+		switch (command->type) {
+			case RENDERCOMMAND_BIND_STATE: {
+				render_shader_t* state_shader = (command->value < array_size(backend_software->pipeline_state)) ?
+				                                    backend_software->pipeline_state[command->value] :
+				                                    nullptr;
+				shader = state_shader ? (const render_software_shader_t*)state_shader->backend_data[0] : nullptr;
+				++statistics->state_switches;
+				break;
+			}
+			case RENDERCOMMAND_BIND_ARGUMENT:
+				argument_buffer = backend->vtable.buffer_lookup(backend, command->value);
+				++statistics->argument_switches;
+				break;
+			case RENDERCOMMAND_BIND_DESCRIPTOR: {
+				const render_buffer_t* buffer = backend->vtable.buffer_lookup(backend, command->value);
+				descriptor[command->slot] = buffer ? buffer->store : nullptr;
+				++statistics->descriptor_rebinds;
+				break;
+			}
+			case RENDERCOMMAND_BIND_INDEX:
+				index_buffer = backend->vtable.buffer_lookup(backend, command->value);
+				break;
+			case RENDERCOMMAND_INSTANCE_COUNT:
+				instance_override = command->value;
+				break;
+			case RENDERCOMMAND_DRAW: {
+				uint instance_count = instance_override;
+				instance_override = 0;
+				if (!shader || !shader->vertex || !argument_buffer || !argument_buffer->store || !index_buffer ||
+				    !index_buffer->store || (command->value + sizeof(render_argument_t) > argument_buffer->allocated))
+					break;
+				const render_argument_t* argument = pointer_offset_const(argument_buffer->store, command->value);
+				if (!instance_count)
+					instance_count = argument->instance_count;
+				size_t index_end = argument->index_offset + ((size_t)argument->index_count * index_size);
+				if (index_end > index_buffer->allocated)
+					break;
+				++statistics->draws;
+
+				rb_software_draw_t draw;
+				draw.shader = shader;
+				memcpy(draw.descriptor, descriptor, sizeof(draw.descriptor));
+				draw.index_store = pointer_offset_const(index_buffer->store, argument->index_offset);
+				draw.index_count = argument->index_count;
+				draw.vertex_base = argument->vertex_base;
+				draw.instance_base = argument->instance_base;
+				draw.instance_count = instance_count;
+				uint draw_index = (uint)array_size(pipeline_software->draw);
+				array_push_memcpy(pipeline_software->draw, &draw);
+
+				// Draws are not split, a work item ends at the draw reaching the triangle count
+				if (!setup_triangles) {
+					if (pipeline_software->setup_count == array_size(pipeline_software->setup)) {
+						rb_software_setup_t setup;
+						memset(&setup, 0, sizeof(setup));
+						array_push_memcpy(pipeline_software->setup, &setup);
+					}
+					rb_software_setup_t* setup = pipeline_software->setup + pipeline_software->setup_count++;
+					setup->pipeline = pipeline_software;
+					setup->draw_first = draw_index;
+					array_clear(setup->triangle);
+				}
+				pipeline_software->setup[pipeline_software->setup_count - 1].draw_end = draw_index + 1;
+				setup_triangles += (draw.index_count / 3) * instance_count;
+				if (setup_triangles >= RENDER_SOFTWARE_SETUP_TRIANGLES)
+					setup_triangles = 0;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+//! Run vertex functions and set up triangles for the draw range of a setup work item
+static void
+rb_software_pipeline_setup(rb_software_setup_t* setup) {
+	render_pipeline_software_t* pipeline_software = setup->pipeline;
+	const uint index_size = (pipeline_software->pipeline.index_format == RENDER_INDEXFORMAT_UINT16) ? 2 : 4;
+	const uint width = pipeline_software->width;
+	const uint height = pipeline_software->height;
+
+	float position[3][4];
+	float varying[3][RENDER_SOFTWARE_VARYING_MAX];
+	for (uint idraw = setup->draw_first; idraw < setup->draw_end; ++idraw) {
+		const rb_software_draw_t* draw = pipeline_software->draw + idraw;
+		const render_software_shader_t* shader = draw->shader;
+		for (uint iinst = 0; iinst < draw->instance_count; ++iinst) {
+			uint instance = draw->instance_base + iinst;
+			for (uint iindex = 0; iindex + 2 < draw->index_count; iindex += 3) {
+				for (uint ivert = 0; ivert < 3; ++ivert) {
+					uint vertex = (index_size == 2) ? ((const uint16_t*)draw->index_store)[iindex + ivert] :
+					                                  ((const uint32_t*)draw->index_store)[iindex + ivert];
+					shader->vertex(draw->descriptor, vertex + draw->vertex_base, instance, position[ivert],
+					               varying[ivert]);
+				}
+				rb_software_triangle_setup(setup, shader, draw->descriptor, position, varying, width, height);
+			}
+		}
+	}
+}
+
+static void
+rb_software_setup_task(task_context_t context) {
+	rb_software_setup_t* setup = context;
+	rb_software_pipeline_setup(setup);
+	atomic_decr32(&setup->pipeline->task_pending, memory_order_release);
+}
+
+//! Bin triangles overlapping a row of tiles to the tiles, in submission order
+static void
+rb_software_tile_bin(render_pipeline_software_t* pipeline_software, uint row) {
+	const int row_min_y = (int)row * RENDER_SOFTWARE_TILE_SIZE;
+	const int row_max_y = row_min_y + RENDER_SOFTWARE_TILE_SIZE;
+	rb_software_tile_t* tile_row = pipeline_software->tile + (row * pipeline_software->tile_columns);
+	const rb_software_triangle_t* triangle = pipeline_software->triangle;
+	for (uint itri = 0, tsize = (uint)array_size(pipeline_software->triangle); itri < tsize; ++itri, ++triangle) {
+		if ((triangle->min_y >= row_max_y) || (triangle->max_y <= row_min_y))
+			continue;
+		int tile_min_x = triangle->min_x / RENDER_SOFTWARE_TILE_SIZE;
+		int tile_max_x = (triangle->max_x - 1) / RENDER_SOFTWARE_TILE_SIZE;
+		for (int tile_x = tile_min_x; tile_x <= tile_max_x; ++tile_x)
+			array_push(tile_row[tile_x].triangle, itri);
+	}
+}
+
+static void
+rb_software_bin_task(task_context_t context) {
+	rb_software_tile_t* tile = context;
+	rb_software_tile_bin(tile->pipeline, tile->index / tile->pipeline->tile_columns);
+	atomic_decr32(&tile->pipeline->task_pending, memory_order_release);
+}
+
+//! Shade covered fragments of a triangle at the given pixel
+static FOUNDATION_FORCEINLINE void
+rb_software_shade(const rb_software_triangle_t* triangle, float px, float py, float depth, uint32_t* color_pixel,
+                  float* depth_pixel) {
+	float inverse_w =
+	    triangle->inverse_w[0] * px + triangle->inverse_w[1] * py + triangle->inverse_w[2];
+	float w = 1.0f / inverse_w;
+	float varying[RENDER_SOFTWARE_VARYING_MAX];
+	for (uint ivar = 0; ivar < triangle->shader->varying_count; ++ivar)
+		varying[ivar] =
+		    (triangle->varying[ivar][0] * px + triangle->varying[ivar][1] * py + triangle->varying[ivar][2]) * w;
+	if (triangle->shader->fragment)
+		*color_pixel = triangle->shader->fragment(triangle->descriptor, varying);
+	if (depth_pixel)
+		*depth_pixel = depth;
+}
+
+//! Rasterize all triangles binned to a tile, in submission order
+static void
+rb_software_tile_rasterize(rb_software_tile_t* tile) {
+	render_pipeline_software_t* pipeline_software = tile->pipeline;
+	render_pipeline_t* pipeline = (render_pipeline_t*)pipeline_software;
+	render_target_t* color = pipeline->color_attachment[0];
+	render_target_t* depth = pipeline_software->depth_target;
+	const uint color_row_size = color->stride / sizeof(uint32_t);
+	const uint depth_row_size = depth ? depth->stride / sizeof(float) : 0;
+	const int tile_x0 = (int)(tile->index % pipeline_software->tile_columns) * RENDER_SOFTWARE_TILE_SIZE;
+	const int tile_y0 = (int)(tile->index / pipeline_software->tile_columns) * RENDER_SOFTWARE_TILE_SIZE;
+	uint32_t* color_pixels = color->pixels;
+	float* depth_pixels = depth ? depth->pixels : nullptr;
+	int fragment_count = 0;
+
+	for (size_t itri = 0, tsize = array_size(tile->triangle); itri < tsize; ++itri) {
+		const rb_software_triangle_t* triangle = pipeline_software->triangle + tile->triangle[itri];
+		int x0 = math_max(triangle->min_x, tile_x0);
+		int y0 = math_max(triangle->min_y, tile_y0);
+		int x1 = math_min(triangle->max_x, tile_x0 + RENDER_SOFTWARE_TILE_SIZE);
+		int y1 = math_min(triangle->max_y, tile_y0 + RENDER_SOFTWARE_TILE_SIZE);
+		for (int y = y0; y < y1; ++y) {
+			const float py = (float)y + 0.5f;
+			uint32_t* color_row = color_pixels + ((size_t)y * color_row_size);
+			float* depth_row = depth_pixels ? depth_pixels + ((size_t)y * depth_row_size) : nullptr;
+#if FOUNDATION_ARCH_SSE2
+			// Evaluate edge functions and depth for four pixels at a time
+			const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+			const __m128 zero = _mm_setzero_ps();
+			__m128 edge_a[3], edge_row[3];
+			for (uint iedge = 0; iedge < 3; ++iedge) {
+				edge_a[iedge] = _mm_set1_ps(triangle->edge[iedge][0]);
+				edge_row[iedge] = _mm_set1_ps(triangle->edge[iedge][1] * py + triangle->edge[iedge][2]);
+			}
+			const __m128 depth_a = _mm_set1_ps(triangle->depth[0]);
+			const __m128 depth_row_value = _mm_set1_ps(triangle->depth[1] * py + triangle->depth[2]);
+			for (int x = x0; x < x1; x += 4) {
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane);
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], px), edge_row[0]), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], px), edge_row[1]), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], px), edge_row[2]), zero));
+				int mask = _mm_movemask_ps(inside);
+				if (!mask)
+					continue;
+				float fragment_depth[4];
+				_mm_storeu_ps(fragment_depth, _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row_value));
+				for (int ilane = 0; ilane < 4; ++ilane) {
+					int pixel = x + ilane;
+					if (!(mask & (1 << ilane)) || (pixel >= x1))
+						continue;
+					if (depth_row && !(fragment_depth[ilane] < depth_row[pixel]))
+						continue;
+					rb_software_shade(triangle, (float)pixel + 0.5f, py, fragment_depth[ilane], color_row + pixel,
+					                  depth_row ? depth_row + pixel : nullptr);
+					++fragment_count;
+				}
+			}
+#else
+			for (int x = x0; x < x1; ++x) {
+				const float px = (float)x + 0.5f;
+				bool inside = true;
+				for (uint iedge = 0; inside && (iedge < 3); ++iedge)
+					inside = (triangle->edge[iedge][0] * px + triangle->edge[iedge][1] * py +
+					          triangle->edge[iedge][2]) >= 0.0f;
+				if (!inside)
+					continue;
+				float fragment_depth = triangle->depth[0] * px + triangle->depth[1] * py + triangle->depth[2];
+				if (depth_row && !(fragment_depth < depth_row[x]))
+					continue;
+				rb_software_shade(triangle, px, py, fragment_depth, color_row + x, depth_row ? depth_row + x : nullptr);
+				++fragment_count;
+			}
+#endif
+		}
+	}
+
+	atomic_add32(&pipeline_software->fragment_count, fragment_count, memory_order_relaxed);
+}
+
+static void
+rb_software_tile_task(task_context_t context) {
+	rb_software_tile_t* tile = context;
+	rb_software_tile_rasterize(tile);
+	atomic_decr32(&tile->pipeline->task_pending, memory_order_release);
+}
+
+//! Run tasks of a flush stage on the configured scheduler, or in the calling thread if there is no scheduler or
+//! only a single task, and wait for all tasks to complete
+static void
+rb_software_task_run(render_pipeline_software_t* pipeline_software, task_t* task, uint count) {
+	if (!count)
+		return;
+	task_scheduler_t* scheduler = render_config.task_scheduler;
+	atomic_store32(&pipeline_software->task_pending, (int32_t)count, memory_order_release);
+	if (scheduler && (count > 1)) {
+		task_scheduler_queue(scheduler, task, count, nullptr);
+		task_yield_and_wait(&pipeline_software->task_pending);
+	} else {
+		for (uint itask = 0; itask < count; ++itask)
+			task[itask].function(task[itask].context);
+	}
+}
+
+//! Resize tile grid to cover the target, and clear binned triangles
+static void
+rb_software_tile_prepare(render_pipeline_software_t* pipeline_software, uint width, uint height) {
+	uint columns = (width + (RENDER_SOFTWARE_TILE_SIZE - 1)) / RENDER_SOFTWARE_TILE_SIZE;
+	uint rows = (height + (RENDER_SOFTWARE_TILE_SIZE - 1)) / RENDER_SOFTWARE_TILE_SIZE;
+	uint tile_count = pipeline_software->tile_columns * pipeline_software->tile_rows;
+	if ((columns != pipeline_software->tile_columns) || (rows != pipeline_software->tile_rows)) {
+		for (uint itile = 0; itile < tile_count; ++itile)
+			array_deallocate(pipeline_software->tile[itile].triangle);
+		memory_deallocate(pipeline_software->tile);
+		memory_deallocate(pipeline_software->task);
+		tile_count = columns * rows;
+		pipeline_software->tile = memory_allocate(HASH_RENDER, sizeof(rb_software_tile_t) * tile_count, 0,
+		                                          MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		pipeline_software->task =
+		    memory_allocate(HASH_RENDER, sizeof(task_t) * tile_count, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		pipeline_software->tile_columns = columns;
+		pipeline_software->tile_rows = rows;
+	}
+	for (uint itile = 0; itile < tile_count; ++itile) {
+		pipeline_software->tile[itile].pipeline = pipeline_software;
+		pipeline_software->tile[itile].index = itile;
+		array_clear(pipeline_software->tile[itile].triangle);
+	}
+	array_clear(pipeline_software->triangle);
+}
+
+static void
+rb_software_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	render_pipeline_software_t* pipeline_software = (render_pipeline_software_t*)pipeline;
+	render_target_t* color = pipeline->color_attachment[0];
+	render_target_t* depth = pipeline->depth_attachment;
+
+	atomic_store32(&pipeline_software->fragment_count, 0, memory_order_relaxed);
+	if (!color || !color->pixels || (color->pixelformat != PIXELFORMAT_R8G8B8A8)) {
+		render_pipeline_frame_signal(pipeline, pipeline->frame_current);
+		return;
+	}
+	if (depth && (!depth->pixels || (depth->pixelformat != PIXELFORMAT_DEPTH32F) ||
+	              (depth->width < color->width) || (depth->height < color->height)))
+		depth = nullptr;
+	pipeline_software->depth_target = depth;
+
+	const uint width = color->width;
+	const uint height = color->height;
+	if (pipeline_software->color_clear_action == RENDERCLEAR_CLEAR) {
+		uint32_t* pixel = color->pixels;
+		for (size_t ipix = 0, pixel_count = ((size_t)color->stride * height) / sizeof(uint32_t); ipix < pixel_count;
+		     ++ipix)
+			pixel[ipix] = pipeline_software->color_clear;
+	}
+	if (depth && (pipeline_software->depth_clear_action == RENDERCLEAR_CLEAR)) {
+		float* pixel = depth->pixels;
+		for (size_t ipix = 0, pixel_count = ((size_t)depth->stride * depth->height) / sizeof(float);
+		     ipix < pixel_count; ++ipix)
+			pixel[ipix] = pipeline_software->depth_clear;
+	}
+
+	rb_software_tile_prepare(pipeline_software, width, height);
+	pipeline_software->width = width;
+	pipeline_software->height = height;
+
+	// Draw ranges are set up in parallel, the triangles of each range are merged in submission order
+	rb_software_pipeline_decode(backend_software, pipeline_software);
+	uint setup_count = pipeline_software->setup_count;
+	array_resize(pipeline_software->setup_task, setup_count);
+	for (uint isetup = 0; isetup < setup_count; ++isetup) {
+		memset(pipeline_software->setup_task + isetup, 0, sizeof(task_t));
+		pipeline_software->setup_task[isetup].function = rb_software_setup_task;
+		pipeline_software->setup_task[isetup].context = pipeline_software->setup + isetup;
+	}
+	rb_software_task_run(pipeline_software, pipeline_software->setup_task, setup_count);
+	size_t triangle_count = 0;
+	for (uint isetup = 0; isetup < setup_count; ++isetup)
+		triangle_count += array_size(pipeline_software->setup[isetup].triangle);
+	array_resize(pipeline_software->triangle, triangle_count);
+	triangle_count = 0;
+	for (uint isetup = 0; isetup < setup_count; ++isetup) {
+		const rb_software_setup_t* setup = pipeline_software->setup + isetup;
+		size_t count = array_size(setup->triangle);
+		if (count)
+			memcpy(pipeline_software->triangle + triangle_count, setup->triangle,
+			       sizeof(rb_software_triangle_t) * count);
+		triangle_count += count;
+	}
+
+	// Each tile row is binned by a single task, keeping triangles of each tile in submission order
+	uint tile_count = pipeline_software->tile_columns * pipeline_software->tile_rows;
+	uint task_count = 0;
+	if (triangle_count) {
+		for (uint irow = 0; irow < pipeline_software->tile_rows; ++irow, ++task_count) {
+			pipeline_software->task[task_count].function = rb_software_bin_task;
+			pipeline_software->task[task_count].context =
+			    pipeline_software->tile + (irow * pipeline_software->tile_columns);
+		}
+	}
+	rb_software_task_run(pipeline_software, pipeline_software->task, task_count);
+
+	// Tiles cover disjoint pixels, so they can be rasterized in parallel
+	task_count = 0;
+	for (uint itile = 0; itile < tile_count; ++itile) {
+		if (!array_size(pipeline_software->tile[itile].triangle))
+			continue;
+		pipeline_software->task[task_count].function = rb_software_tile_task;
+		pipeline_software->task[task_count].context = pipeline_software->tile + itile;
+		++task_count;
+	}
+	rb_software_task_run(pipeline_software, pipeline_software->task, task_count);
+
+	// Rasterization is complete when the flush returns
+	render_pipeline_frame_signal(pipeline, pipeline->frame_current);
+}
+
+static void
+rb_software_pipeline_wait(render_backend_t* backend, render_pipeline_t* pipeline, uint frame) {
+	FOUNDATION_UNUSED(backend, pipeline, frame);
+}
+
+static void
+rb_software_pipeline_use_argument_buffer(render_backend_t* backend, render_pipeline_t* pipeline,
+                                         render_buffer_index_t buffer) {
+	FOUNDATION_UNUSED(backend, pipeline, buffer);
+}
+
+static void
+rb_software_pipeline_use_render_buffer(render_backend_t* backend, render_pipeline_t* pipeline,
+                                       render_buffer_index_t buffer) {
+	FOUNDATION_UNUSED(backend, pipeline, buffer);
+}
+
+static render_pipeline_state_t
+rb_software_pipeline_state_allocate(render_backend_t* backend, render_pipeline_t* pipeline, render_shader_t* shader) {
+	FOUNDATION_UNUSED(pipeline);
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	if (!shader || !shader->backend_data[0]) {
+		log_error(HASH_RENDER, ERROR_INVALID_VALUE,
+		          STRING_CONST("Software pipeline state requires a shader with a software program"));
+		return 0;
+	}
+	render_pipeline_state_t state = (render_pipeline_state_t)array_size(backend_software->pipeline_state);
+	array_push(backend_software->pipeline_state, shader);
+	return state;
+}
+
+static void
+rb_software_pipeline_state_deallocate(render_backend_t* backend, render_pipeline_state_t state) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	if (state && (state < array_size(backend_software->pipeline_state)))
+		backend_software->pipeline_state[state] = nullptr;
+}
+
+static bool
+rb_software_shader_upload(render_backend_t* backend, render_shader_t* shader, const void* buffer, size_t size) {
+	FOUNDATION_UNUSED(backend, shader, buffer, size);
+	log_warn(HASH_RENDER, WARNING_UNSUPPORTED,
+	         STRING_CONST("Software backend shaders are CPU programs set with render_backend_software_shader_set"));
+	return false;
+}
+
+static void
+rb_software_shader_finalize(render_backend_t* backend, render_shader_t* shader) {
+	FOUNDATION_UNUSED(backend);
+	shader->backend_data[0] = 0;
+}
+
+static void
+rb_software_buffer_allocate(render_backend_t* backend, render_buffer_t* buffer, size_t buffer_size, const void* data,
+                            size_t data_size) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	if ((buffer->usage & RENDERUSAGE_RENDER) && !buffer->render_index)
+		buffer->render_index = render_index_table_allocate(&backend_software->buffer_table, buffer);
+	// All buffers need CPU storage since the device is the CPU
+	buffer->store = memory_allocate(HASH_RENDER, buffer_size, 16, MEMORY_PERSISTENT);
+	buffer->allocated = buffer_size;
+	if (data_size && buffer->store) {
+		memcpy(buffer->store, data, data_size);
+		buffer->used = data_size;
+	}
+}
+
+static void
+rb_software_buffer_deallocate(render_backend_t* backend, render_buffer_t* buffer, bool cpu, bool gpu) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	FOUNDATION_UNUSED(cpu);
+	// Storage is the device memory, only released with the GPU side
+	if (gpu && buffer->store) {
+		memory_deallocate(buffer->store);
+		buffer->store = nullptr;
+	}
+	if (gpu && buffer->render_index) {
+		render_index_table_free(&backend_software->buffer_table, buffer->render_index);
+		buffer->render_index = 0;
+	}
+}
+
+static render_buffer_t*
+rb_software_buffer_lookup(render_backend_t* backend, render_buffer_index_t index) {
+	render_backend_software_t* backend_software = (render_backend_software_t*)backend;
+	return render_index_table_lookup(&backend_software->buffer_table, index);
+}
+
+static void
+rb_software_buffer_upload(render_backend_t* backend, render_buffer_t* buffer, size_t offset, size_t size) {
+	FOUNDATION_UNUSED(backend, buffer, offset, size);
+}
+
+static void
+rb_software_buffer_data_declare(render_backend_t* backend, render_buffer_t* buffer, size_t instance_count,
+                                const render_buffer_data_t* data, size_t data_count) {
+	FOUNDATION_UNUSED(backend, buffer, data, data_count, instance_count);
+}
+
+static void
+rb_software_buffer_data_encode_buffer(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
+                                      render_buffer_t* source, uint offset) {
+	FOUNDATION_UNUSED(backend, buffer, instance, index, source, offset);
+}
+
+static void
+rb_software_buffer_data_encode_constant(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
+                                        const void* data, uint size) {
+	FOUNDATION_UNUSED(backend, buffer, instance, index, data, size);
+}
+
+static void
+rb_software_buffer_data_encode_matrix(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
+                                      const matrix_t* matrix) {
+	FOUNDATION_UNUSED(backend, buffer, instance, index, matrix);
+}
+
+static void
+rb_software_buffer_set_label(render_backend_t* backend, render_buffer_t* buffer, const char* name, size_t length) {
+	FOUNDATION_UNUSED(backend, buffer, name, length);
+}
+
+static render_backend_vtable_t render_backend_vtable_software = {
+    .construct = rb_software_construct,
+    .destruct = rb_software_destruct,
+    .enumerate_adapters = rb_software_enumerate_adapters,
+    .enumerate_modes = rb_software_enumerate_modes,
+    .target_window_allocate = rb_software_target_window_allocate,
+    .target_texture_allocate = rb_software_target_texture_allocate,
+    .target_deallocate = rb_software_target_deallocate,
+    .target_read_pixels = rb_software_target_read_pixels,
+    .pipeline_allocate = rb_software_pipeline_allocate,
+    .pipeline_deallocate = rb_software_pipeline_deallocate,
+    .pipeline_set_color_attachment = rb_software_pipeline_set_color_attachment,
+    .pipeline_set_depth_attachment = rb_software_pipeline_set_depth_attachment,
+    .pipeline_set_color_clear = rb_software_pipeline_set_color_clear,
+    .pipeline_set_depth_clear = rb_software_pipeline_set_depth_clear,
+    .pipeline_build = rb_software_pipeline_build,
+    .pipeline_flush = rb_software_pipeline_flush,
+    .pipeline_wait = rb_software_pipeline_wait,
+    .pipeline_use_argument_buffer = rb_software_pipeline_use_argument_buffer,
+    .pipeline_use_render_buffer = rb_software_pipeline_use_render_buffer,
+    .pipeline_state_allocate = rb_software_pipeline_state_allocate,
+    .pipeline_state_deallocate = rb_software_pipeline_state_deallocate,
+    .shader_upload = rb_software_shader_upload,
+    .shader_finalize = rb_software_shader_finalize,
+    .buffer_allocate = rb_software_buffer_allocate,
+    .buffer_deallocate = rb_software_buffer_deallocate,
+    .buffer_upload = rb_software_buffer_upload,
+    .buffer_set_label = rb_software_buffer_set_label,
+    .buffer_lookup = rb_software_buffer_lookup,
+    .buffer_data_declare = rb_software_buffer_data_declare,
+    .buffer_data_encode_buffer = rb_software_buffer_data_encode_buffer,
+    .buffer_data_encode_matrix = rb_software_buffer_data_encode_matrix,
+    .buffer_data_encode_constant = rb_software_buffer_data_encode_constant,
+    .command_stream = true};
+
+render_backend_t*
+render_backend_software_allocate(void) {
+	render_backend_t* backend = memory_allocate(HASH_RENDER, sizeof(render_backend_software_t), 0,
+	                                            MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	backend->api = RENDERAPI_SOFTWARE;
+	backend->api_group = RENDERAPIGROUP_NONE;
+	backend->vtable = render_backend_vtable_software;
+	return backend;
+}
+
+void
+render_backend_software_shader_set(render_backend_t* backend, render_shader_t* shader,
+                                   const render_software_shader_t* program) {
+	shader->backend = backend;
+	shader->backend_data[0] = (uintptr_t)program;
+}
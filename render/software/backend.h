@@ -0,0 +1,70 @@
+/* backend.h  -  Render library  -  Public Domain  -  2014 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file software/backend.h
+    Software rasterizer render backend */
+
+#include <foundation/platform.h>
+#include <render/types.h>
+
+//! Maximum number of varyings interpolated from vertex to fragment function
+#define RENDER_SOFTWARE_VARYING_MAX 8
+
+//! Size in pixels of the square tiles triangles are binned to
+#define RENDER_SOFTWARE_TILE_SIZE 64
+
+//! Minimum number of triangles set up by a single task, draws are not split across tasks
+#define RENDER_SOFTWARE_SETUP_TRIANGLES 1024
+
+typedef struct render_software_shader_t render_software_shader_t;
+
+/*! Software vertex function standing in for a vertex shader
+    \param descriptor CPU store of the bound descriptor buffers
+    \param vertex Vertex index, including the vertex base
+    \param instance Instance index, including the instance base
+    \param position Output clip space position (x, y, z, w)
+    \param varying Output varyings interpolated to the fragment function */
+typedef void (*render_software_vertex_fn)(const void* const* descriptor, uint vertex, uint instance, float* position,
+                                          float* varying);
+
+/*! Software fragment function standing in for a fragment shader
+    \param descriptor CPU store of the bound descriptor buffers
+    \param varying Perspective correct interpolated varyings
+    \return Fragment color packed as 8-bit RGBA, red in the least significant byte */
+typedef uint32_t (*render_software_fragment_fn)(const void* const* descriptor, const float* varying);
+
+//! CPU callable shader program of the software backend
+struct render_software_shader_t {
+	render_software_vertex_fn vertex;
+	render_software_fragment_fn fragment;
+	//! Number of varyings output by the vertex function, at most RENDER_SOFTWARE_VARYING_MAX
+	uint varying_count;
+};
+
+RENDER_API render_backend_t*
+render_backend_software_allocate(void);
+
+/*! Bind a CPU shader program to a shader object, which can then be used to allocate pipeline
+    states on the software backend. The program must outlive the shader
+    \param backend Software backend
+    \param shader Shader
+    \param program Shader program */
+RENDER_API void
+render_backend_software_shader_set(render_backend_t* backend, render_shader_t* shader,
+                                   const render_software_shader_t* program);
@@ -0,0 +1,131 @@
+/* table.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+#define RENDER_INDEX_TABLE_SEGMENT_MASK (RENDER_INDEX_TABLE_SEGMENT_SIZE - 1)
+
+// Free list head packs the index in the low bits and a generation tag in the high bits
+#define RENDER_INDEX_TABLE_HEAD(index, tag) ((int64_t)(((uint64_t)(tag) << 32) | (uint64_t)(index)))
+#define RENDER_INDEX_TABLE_HEAD_INDEX(head) ((uint)((uint64_t)(head) & 0xFFFFFFFFULL))
+#define RENDER_INDEX_TABLE_HEAD_TAG(head) ((uint)((uint64_t)(head) >> 32))
+
+void
+render_index_table_initialize(render_index_table_t* table, uint capacity) {
+	const uint max_capacity = RENDER_INDEX_TABLE_SEGMENT_SIZE * RENDER_INDEX_TABLE_SEGMENT_COUNT;
+	memset(table, 0, sizeof(render_index_table_t));
+	table->capacity = (capacity && (capacity < max_capacity)) ? capacity : max_capacity;
+	table->lock = mutex_allocate(STRING_CONST("Render index table"));
+	// Index 0 is reserved as invalid
+	atomic_store32(&table->count, 1, memory_order_relaxed);
+	atomic_store64(&table->free, 0, memory_order_release);
+}
+
+void
+render_index_table_finalize(render_index_table_t* table) {
+	for (uint isegment = 0; isegment < RENDER_INDEX_TABLE_SEGMENT_COUNT; ++isegment) {
+		memory_deallocate(atomic_load_ptr(&table->segment[isegment], memory_order_acquire));
+		atomic_store_ptr(&table->segment[isegment], nullptr, memory_order_relaxed);
+	}
+	mutex_deallocate(table->lock);
+	table->lock = nullptr;
+}
+
+static render_index_table_entry_t*
+render_index_table_entry(render_index_table_t* table, uint index) {
+	render_index_table_entry_t* segment =
+	    atomic_load_ptr(&table->segment[index / RENDER_INDEX_TABLE_SEGMENT_SIZE], memory_order_acquire);
+	return segment ? segment + (index & RENDER_INDEX_TABLE_SEGMENT_MASK) : nullptr;
+}
+
+static render_index_table_entry_t*
+render_index_table_entry_grow(render_index_table_t* table, uint index) {
+	render_index_table_entry_t* entry = render_index_table_entry(table, index);
+	if (entry)
+		return entry;
+	atomicptr_t* slot = &table->segment[index / RENDER_INDEX_TABLE_SEGMENT_SIZE];
+	mutex_lock(table->lock);
+	render_index_table_entry_t* segment = atomic_load_ptr(slot, memory_order_acquire);
+	if (!segment) {
+		segment = memory_allocate(HASH_RENDER, sizeof(render_index_table_entry_t) * RENDER_INDEX_TABLE_SEGMENT_SIZE,
+		                          0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		atomic_store_ptr(slot, segment, memory_order_release);
+	}
+	mutex_unlock(table->lock);
+	return segment + (index & RENDER_INDEX_TABLE_SEGMENT_MASK);
+}
+
+uint
+render_index_table_allocate(render_index_table_t* table, void* object) {
+	// Pop a recycled index, the tag makes the exchange fail if the head was popped and pushed back
+	// in between loading the head and the next link
+	int64_t head = atomic_load64(&table->free, memory_order_acquire);
+	while (RENDER_INDEX_TABLE_HEAD_INDEX(head)) {
+		uint index = RENDER_INDEX_TABLE_HEAD_INDEX(head);
+		render_index_table_entry_t* entry = render_index_table_entry(table, index);
+		uint next = (uint)atomic_load32(&entry->next_free, memory_order_relaxed);
+		int64_t next_head = RENDER_INDEX_TABLE_HEAD(next, RENDER_INDEX_TABLE_HEAD_TAG(head) + 1);
+		if (atomic_cas64(&table->free, next_head, head, memory_order_acquire, memory_order_relaxed)) {
+			atomic_store_ptr(&entry->object, object, memory_order_release);
+			return index;
+		}
+		head = atomic_load64(&table->free, memory_order_acquire);
+	}
+
+	uint index = (uint)atomic_incr32(&table->count, memory_order_relaxed) - 1;
+	if (index >= table->capacity) {
+		atomic_decr32(&table->count, memory_order_relaxed);
+		log_errorf(HASH_RENDER, ERROR_OUT_OF_MEMORY, STRING_CONST("Render index table exhausted at %u entries"),
+		           table->capacity);
+		return 0;
+	}
+	render_index_table_entry_t* entry = render_index_table_entry_grow(table, index);
+	atomic_store_ptr(&entry->object, object, memory_order_release);
+	return index;
+}
+
+void
+render_index_table_free(render_index_table_t* table, uint index) {
+	render_index_table_entry_t* entry = index ? render_index_table_entry(table, index) : nullptr;
+	if (!entry)
+		return;
+	atomic_store_ptr(&entry->object, nullptr, memory_order_relaxed);
+	int64_t head, next_head;
+	do {
+		head = atomic_load64(&table->free, memory_order_relaxed);
+		atomic_store32(&entry->next_free, (int32_t)RENDER_INDEX_TABLE_HEAD_INDEX(head), memory_order_relaxed);
+		next_head = RENDER_INDEX_TABLE_HEAD(index, RENDER_INDEX_TABLE_HEAD_TAG(head) + 1);
+	} while (!atomic_cas64(&table->free, next_head, head, memory_order_release, memory_order_relaxed));
+}
+
+void*
+render_index_table_lookup(render_index_table_t* table, uint index) {
+	if (!index || (index >= table->capacity))
+		return nullptr;
+	render_index_table_entry_t* entry = render_index_table_entry(table, index);
+	return entry ? atomic_load_ptr(&entry->object, memory_order_acquire) : nullptr;
+}
+
+uint
+render_index_table_count(render_index_table_t* table) {
+	uint count = (uint)atomic_load32(&table->count, memory_order_acquire);
+	return (count < table->capacity) ? count : table->capacity;
+}
@@ -0,0 +1,66 @@
+/* table.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file table.h
+    Growable table mapping render indices to objects. Entries are stored in fixed size segments
+    allocated on demand, so existing entries never move. Freed indices are recycled through a
+    lock-free stack tagged with a generation counter to avoid ABA issues, allocation only takes
+    a lock when a new segment is needed. Index 0 is reserved as invalid */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Initialize a render index table
+    \param table Table
+    \param capacity Maximum number of indices, 0 for the maximum capacity of the table */
+RENDER_API void
+render_index_table_initialize(render_index_table_t* table, uint capacity);
+
+/*! Finalize a render index table and release all segments
+    \param table Table */
+RENDER_API void
+render_index_table_finalize(render_index_table_t* table);
+
+/*! Allocate an index mapped to the given object. Thread safe
+    \param table Table
+    \param object Object
+    \return Index, 0 if the table is at capacity */
+RENDER_API uint
+render_index_table_allocate(render_index_table_t* table, void* object);
+
+/*! Release an index for reuse. Thread safe and lock-free
+    \param table Table
+    \param index Index */
+RENDER_API void
+render_index_table_free(render_index_table_t* table, uint index);
+
+/*! Lookup the object mapped to an index. Thread safe and lock-free
+    \param table Table
+    \param index Index
+    \return Object, null if index is not allocated */
+RENDER_API void*
+render_index_table_lookup(render_index_table_t* table, uint index);
+
+/*! Query the upper bound of allocated indices, for iterating the table
+    \param table Table
+    \return One past the highest index handed out */
+RENDER_API uint
+render_index_table_count(render_index_table_t* table);
@@ -22,18 +22,111 @@
 #include <render/internal.h>
 
 
+static size_t
+render_target_size(render_target_t* target) {
+	return (size_t)target->width * target->height * render_pixelformat_size(target->pixelformat);
+}
+
 render_target_t*
 render_target_window_allocate(render_backend_t* backend, window_t* window, uint tag) {
-	return backend->vtable.target_window_allocate(backend, window, tag);
+	render_target_t* target = backend->vtable.target_window_allocate(backend, window, tag);
+	if (target)
+		render_backend_statistics_allocate(backend, RENDERRESOURCE_TARGET, RENDERUSAGE_TARGET,
+		                                   render_target_size(target));
+	return target;
 }
 
 render_target_t*
 render_target_texture_allocate(render_backend_t* backend, uint width, uint height, render_pixelformat_t format) {
-    return backend->vtable.target_texture_allocate(backend, width, height, format);
+	render_target_t* target = backend->vtable.target_texture_allocate(backend, width, height, format);
+	if (target)
+		render_backend_statistics_allocate(backend, RENDERRESOURCE_TARGET, RENDERUSAGE_TARGET,
+		                                   render_target_size(target));
+	return target;
 }
 
 void
 render_target_deallocate(render_target_t* target) {
-	if (target && target->backend)
+	if (target && target->backend) {
+		render_backend_statistics_deallocate(target->backend, RENDERRESOURCE_TARGET, RENDERUSAGE_TARGET,
+		                                     render_target_size(target));
 		target->backend->vtable.target_deallocate(target->backend, target);
+	}
+}
+
+bool
+render_target_read_pixels(render_target_t* target, const render_rect_t* rect, void* dst, render_target_read_fn callback,
+                          void* context) {
+	if (!target || !target->backend || !callback)
+		return false;
+	render_rect_t full = {0, 0, target->width, target->height};
+	if (!rect)
+		rect = &full;
+	if (!rect->width || !rect->height || (rect->x + rect->width > target->width) ||
+	    (rect->y + rect->height > target->height)) {
+		log_warn(HASH_RENDER, WARNING_INVALID_VALUE, STRING_CONST("Read pixels rectangle outside render target"));
+		return false;
+	}
+
+	if (!target->pixels)
+		return target->backend->vtable.target_read_pixels(target->backend, target, rect, dst, callback, context);
+
+	// CPU backends have completed rendering when the pipeline flush returns
+	const void* source =
+	    pointer_offset(target->pixels, ((size_t)rect->y * target->stride) + ((size_t)rect->x * target->pixel_size));
+	if (!dst) {
+		callback(target, rect, source, target->stride, context);
+		return true;
+	}
+
+	size_t row_size = (size_t)rect->width * target->pixel_size;
+	for (uint irow = 0; irow < rect->height; ++irow)
+		memcpy(pointer_offset(dst, row_size * irow), pointer_offset_const(source, (size_t)target->stride * irow),
+		       row_size);
+	callback(target, rect, dst, row_size, context);
+	return true;
+}
+
+uint
+render_pixelformat_size(render_pixelformat_t format) {
+	switch (format) {
+		case PIXELFORMAT_R8G8B8:
+			return 3;
+		case PIXELFORMAT_R8G8B8A8:
+			return 4;
+		case PIXELFORMAT_R16G16B16:
+			return 6;
+		case PIXELFORMAT_R16G16B16A16:
+			return 8;
+		case PIXELFORMAT_R32G32B32F:
+			return 12;
+		case PIXELFORMAT_R32G32B32A32F:
+			return 16;
+		case PIXELFORMAT_A8:
+			return 1;
+		case PIXELFORMAT_DEPTH32F:
+			return 4;
+		case PIXELFORMAT_INVALID:
+		case PIXELFORMAT_COUNT:
+		case PIXELFORMAT_UNKNOWN:
+		default:
+			break;
+	}
+	return 0;
+}
+
+void
+render_target_storage_allocate(render_target_t* target) {
+	target->pixel_size = render_pixelformat_size(target->pixelformat);
+	target->stride = target->width * target->pixel_size;
+	target->pixels = nullptr;
+	if (target->stride && target->height)
+		target->pixels = memory_allocate(HASH_RENDER, (size_t)target->stride * target->height, 16,
+		                                 MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+}
+
+void
+render_target_storage_deallocate(render_target_t* target) {
+	memory_deallocate(target->pixels);
+	target->pixels = nullptr;
 }
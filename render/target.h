@@ -33,3 +33,24 @@ render_target_texture_allocate(render_backend_t* backend, uint width, uint heigh
 
 RENDER_API void
 render_target_deallocate(render_target_t* target);
+
+/*! Read back pixels of a target. The callback is called once the pixels are available, which
+    can be before this function returns on backends rendering on the CPU. If the destination is
+    null the callback is given a zero-copy mapping of the target storage, only valid for the
+    duration of the callback, with the target row stride. Otherwise the rectangle is copied to the
+    destination with tightly packed rows and the callback is given the destination
+    \param target Target
+    \param rect Rectangle to read, null for the entire target
+    \param dst Destination of at least width * height * pixel size bytes, null for zero-copy
+    \param callback Callback receiving the pixels
+    \param context Context passed to the callback
+    \return true if the read was issued, false if the backend cannot read back the target */
+RENDER_API bool
+render_target_read_pixels(render_target_t* target, const render_rect_t* rect, void* dst, render_target_read_fn callback,
+                          void* context);
+
+/*! Get size in bytes of a pixel in the given format
+    \param format Pixel format
+    \return Size of a pixel in bytes, 0 if invalid format */
+RENDER_API uint
+render_pixelformat_size(render_pixelformat_t format);
@@ -0,0 +1,144 @@
+/* trace.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+FOUNDATION_STATIC_ASSERT((RENDER_TRACE_EVENT_COUNT & (RENDER_TRACE_EVENT_COUNT - 1)) == 0,
+                         "trace event count must be a power of two");
+
+typedef struct render_trace_event_t {
+	tick_t timestamp;
+	const char* name;
+	uint32_t phase;
+	uint32_t unused;
+} render_trace_event_t;
+
+//! Ring of events recorded by a single thread, only written by the owning thread
+typedef struct render_trace_ring_t render_trace_ring_t;
+struct render_trace_ring_t {
+	render_trace_ring_t* next;
+	uint64_t thread;
+	//! Total number of events written, event index is head modulo ring size
+	atomic32_t head;
+	uint32_t unused;
+	render_trace_event_t event[RENDER_TRACE_EVENT_COUNT];
+};
+
+bool render_trace_enabled;
+
+//! Rings of all threads that recorded events, never removed until module finalization
+static atomicptr_t render_trace_ring;
+static tick_t render_trace_start;
+//! Generation of rings, changed when rings are released to invalidate thread local pointers
+static uint32_t render_trace_generation = 1;
+
+FOUNDATION_DECLARE_THREAD_LOCAL(render_trace_ring_t*, trace_ring, nullptr)
+FOUNDATION_DECLARE_THREAD_LOCAL(uint32_t, trace_generation, 0)
+
+static render_trace_ring_t*
+render_trace_thread_ring(void) {
+	render_trace_ring_t* ring = get_thread_trace_ring();
+	if (ring && (get_thread_trace_generation() == render_trace_generation))
+		return ring;
+
+	ring = memory_allocate(HASH_RENDER, sizeof(render_trace_ring_t), 0, MEMORY_PERSISTENT);
+	ring->thread = thread_id();
+	atomic_store32(&ring->head, 0, memory_order_relaxed);
+	ring->unused = 0;
+	render_trace_ring_t* next;
+	do {
+		next = atomic_load_ptr(&render_trace_ring, memory_order_acquire);
+		ring->next = next;
+	} while (!atomic_cas_ptr(&render_trace_ring, ring, next, memory_order_release, memory_order_acquire));
+
+	set_thread_trace_ring(ring);
+	set_thread_trace_generation(render_trace_generation);
+	return ring;
+}
+
+void
+render_trace_event(const char* name, char phase) {
+	render_trace_ring_t* ring = render_trace_thread_ring();
+	uint32_t head = (uint32_t)atomic_load32(&ring->head, memory_order_relaxed);
+	render_trace_event_t* event = ring->event + (head & (RENDER_TRACE_EVENT_COUNT - 1));
+	event->timestamp = time_current();
+	event->name = name;
+	event->phase = (uint32_t)phase;
+	atomic_store32(&ring->head, (int32_t)(head + 1), memory_order_release);
+}
+
+void
+render_trace_enable(bool enable) {
+	if (enable && !render_trace_start)
+		render_trace_start = time_current();
+	render_trace_enabled = enable;
+}
+
+bool
+render_trace_is_enabled(void) {
+	return render_trace_enabled;
+}
+
+void
+render_trace_clear(void) {
+	render_trace_ring_t* ring = atomic_load_ptr(&render_trace_ring, memory_order_acquire);
+	for (; ring; ring = ring->next)
+		atomic_store32(&ring->head, 0, memory_order_release);
+}
+
+size_t
+render_trace_dump(stream_t* stream) {
+	char buffer[256];
+	size_t count = 0;
+	stream_write(stream, STRING_CONST("{\"traceEvents\":["));
+	render_trace_ring_t* ring = atomic_load_ptr(&render_trace_ring, memory_order_acquire);
+	for (; ring; ring = ring->next) {
+		uint32_t head = (uint32_t)atomic_load32(&ring->head, memory_order_acquire);
+		uint32_t available = (head < RENDER_TRACE_EVENT_COUNT) ? head : RENDER_TRACE_EVENT_COUNT;
+		for (uint32_t ievent = head - available; ievent != head; ++ievent) {
+			const render_trace_event_t* event = ring->event + (ievent & (RENDER_TRACE_EVENT_COUNT - 1));
+			double timestamp = (double)time_ticks_to_seconds(event->timestamp - render_trace_start) * 1000000.0;
+			string_t line = string_format(
+			    buffer, sizeof(buffer),
+			    STRING_CONST("%s\n{\"name\":\"%s\",\"cat\":\"render\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%" PRIu64
+			                 "}"),
+			    count ? "," : "", event->name, (char)event->phase, timestamp, ring->thread);
+			stream_write(stream, line.str, line.length);
+			++count;
+		}
+	}
+	stream_write(stream, STRING_CONST("\n]}\n"));
+	return count;
+}
+
+void
+render_trace_finalize(void) {
+	render_trace_enabled = false;
+	render_trace_ring_t* ring = atomic_load_ptr(&render_trace_ring, memory_order_acquire);
+	atomic_store_ptr(&render_trace_ring, nullptr, memory_order_release);
+	while (ring) {
+		render_trace_ring_t* next = ring->next;
+		memory_deallocate(ring);
+		ring = next;
+	}
+	++render_trace_generation;
+	render_trace_start = 0;
+}
@@ -0,0 +1,49 @@
+/* trace.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file trace.h
+    Opt-in tracing of render calls, exported as Chrome trace event JSON (chrome://tracing, Perfetto).
+    Events are recorded in per-thread ring buffers of RENDER_TRACE_EVENT_COUNT events, older events
+    are overwritten when a ring wraps. A disabled trace point costs a single branch */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Enable or disable recording of trace events
+    \param enable Enable flag */
+RENDER_API void
+render_trace_enable(bool enable);
+
+/*! Query if trace events are recorded
+    \return true if enabled, false if not */
+RENDER_API bool
+render_trace_is_enabled(void);
+
+/*! Discard all recorded trace events */
+RENDER_API void
+render_trace_clear(void);
+
+/*! Write recorded trace events as Chrome trace event JSON. Events recorded concurrently with the
+    dump may or may not be included
+    \param stream Stream to write to
+    \return Number of events written */
+RENDER_API size_t
+render_trace_dump(stream_t* stream);
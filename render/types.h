@@ -39,6 +39,7 @@ typedef enum render_api_t {
 	RENDERAPI_DIRECTX12,
 	RENDERAPI_METAL,
 	RENDERAPI_VULKAN,
+	RENDERAPI_SOFTWARE,
 
 	RENDERAPI_COUNT
 } render_api_t;
@@ -111,39 +112,147 @@ typedef enum render_usage_t {
 	RENDERUSAGE_RENDER = 0x08
 } render_usage_t;
 
+//! Index of usage flags in backend resource statistics
+typedef enum render_usage_index_t {
+	RENDERUSAGEINDEX_DEFAULT = 0,
+	RENDERUSAGEINDEX_CPUONLY,
+	RENDERUSAGEINDEX_GPUONLY,
+	RENDERUSAGEINDEX_TARGET,
+	RENDERUSAGEINDEX_RENDER,
+
+	RENDERUSAGEINDEX_COUNT
+} render_usage_index_t;
+
+//! Type of resources accounted in backend resource statistics
+typedef enum render_resource_type_t {
+	RENDERRESOURCE_BUFFER = 0,
+	RENDERRESOURCE_TARGET,
+	RENDERRESOURCE_SHADER,
+	RENDERRESOURCE_PIPELINE_STATE,
+
+	RENDERRESOURCE_COUNT
+} render_resource_type_t;
+
 typedef enum render_buffer_flag_t {
 	RENDERBUFFER_DIRTY = 0x01,
 	RENDERBUFFER_LOST = 0x02,
+	//! Dirty state is limited to the tracked dirty ranges, otherwise the whole buffer is dirty
+	RENDERBUFFER_DIRTY_RANGE = 0x04,
+	//! GPU storage was released together with the CPU storage of a lost buffer
+	RENDERBUFFER_LOST_AUX = 0x08,
 
 	RENDERBUFFER_LOCK_READ = 0x10,
 	RENDERBUFFER_LOCK_WRITE = 0x20,
 	RENDERBUFFER_LOCK_DISCARD = 0x40,
 	RENDERBUFFER_LOCK_WRITE_ALL = 0x60,
+	//! Dirty ranges were marked while holding the write lock
+	RENDERBUFFER_LOCK_RANGE = 0x80,
 	RENDERBUFFER_LOCK_BITS = 0xF0
 } render_buffer_flag_t;
 
 typedef enum render_primitive_type { RENDERPRIMITIVE_TRIANGLELIST = 0 } render_primitive_type;
 
+typedef enum render_pipeline_flag_t {
+	//! Sort primitives by binding state before flushing, primitive order is not preserved
+	RENDERPIPELINE_SORT = 0x01,
+	//! Merge consecutive draws of contiguous instance ranges with identical bindings into one instanced draw
+	RENDERPIPELINE_MERGE_INSTANCES = 0x02,
+	//! Compile primitives into indirect draw records grouped in binding state buckets at flush
+	RENDERPIPELINE_INDIRECT = 0x04
+} render_pipeline_flag_t;
+
+typedef enum render_command_type_t {
+	//! Bind render pipeline state, value is the pipeline state
+	RENDERCOMMAND_BIND_STATE = 0,
+	//! Bind argument buffer for following draws, value is the buffer render index
+	RENDERCOMMAND_BIND_ARGUMENT,
+	//! Bind descriptor buffer to a slot, value is the buffer render index
+	RENDERCOMMAND_BIND_DESCRIPTOR,
+	//! Bind index buffer, value is the buffer render index
+	RENDERCOMMAND_BIND_INDEX,
+	//! Draw, value is the offset of the arguments in the bound argument buffer
+	RENDERCOMMAND_DRAW,
+	//! Override instance count of the next draw for merged draws, value is the instance count
+	RENDERCOMMAND_INSTANCE_COUNT
+} render_command_type_t;
+
 typedef enum render_data_type { RENDERDATA_POINTER, RENDERDATA_FLOAT4, RENDERDATA_MATRIX4X4 } render_data_type;
 
+//! Alignment rules of CPU computed structured data layouts
+typedef enum render_buffer_layout_rule_t {
+	//! Uniform buffer rules, array strides and structure alignment rounded up to 16 bytes
+	RENDERLAYOUT_STD140 = 0,
+	//! Storage buffer rules, natural alignment of array elements and structures
+	RENDERLAYOUT_STD430
+} render_buffer_layout_rule_t;
+
 #define RENDER_TARGET_COLOR_ATTACHMENT_COUNT 4
 
+//! Maximum number of segments in a render index table, capacity is this times RENDER_INDEX_TABLE_SEGMENT_SIZE
+#define RENDER_INDEX_TABLE_SEGMENT_COUNT 1024
+
+//! Number of low bits of a render handle holding the slot index, the high bits hold the slot generation
+#define RENDER_HANDLE_INDEX_BITS 20
+
+//! Maximum number of slabs in a slab pool, capacity is this times RENDER_SLAB_OBJECT_COUNT
+#define RENDER_SLAB_COUNT ((1 << RENDER_HANDLE_INDEX_BITS) / RENDER_SLAB_OBJECT_COUNT)
+
+//! Number of disjoint dirty ranges tracked per buffer, closest ranges are merged when exceeded
+#define RENDER_BUFFER_DIRTY_RANGE_COUNT 4
+
+//! Number of first level (power of two) and second level (linear subdivision) size classes of a buffer pool
+#define RENDER_BUFFER_POOL_FL_COUNT 32
+#define RENDER_BUFFER_POOL_SL_LOG2 3
+#define RENDER_BUFFER_POOL_SL_COUNT (1 << RENDER_BUFFER_POOL_SL_LOG2)
+
 typedef struct render_config_t render_config_t;
 typedef struct render_backend_vtable_t render_backend_vtable_t;
 typedef struct render_backend_t render_backend_t;
+typedef struct render_resource_statistics_t render_resource_statistics_t;
+typedef struct render_backend_statistics_t render_backend_statistics_t;
 typedef struct render_resolution_t render_resolution_t;
 typedef struct render_target_t render_target_t;
+typedef struct render_rect_t render_rect_t;
 typedef struct render_pipeline_t render_pipeline_t;
+typedef struct render_pipeline_chunk_t render_pipeline_chunk_t;
+typedef struct render_pipeline_block_t render_pipeline_block_t;
+typedef struct render_pipeline_frame_t render_pipeline_frame_t;
+typedef struct render_pipeline_counters_t render_pipeline_counters_t;
+typedef struct render_pipeline_statistics_t render_pipeline_statistics_t;
 typedef struct render_shader_t render_shader_t;
 typedef struct render_buffer_t render_buffer_t;
+typedef struct render_buffer_range_t render_buffer_range_t;
+typedef struct render_index_table_entry_t render_index_table_entry_t;
+typedef struct render_index_table_t render_index_table_t;
+typedef struct render_slab_slot_t render_slab_slot_t;
+typedef struct render_slab_t render_slab_t;
 typedef struct render_primitive_t render_primitive_t;
+typedef struct render_command_t render_command_t;
+typedef struct render_command_buffer_t render_command_buffer_t;
+typedef struct render_indirect_command_t render_indirect_command_t;
+typedef struct render_indirect_bucket_t render_indirect_bucket_t;
+typedef struct render_indirect_buffer_t render_indirect_buffer_t;
 typedef struct render_buffer_data_t render_buffer_data_t;
+typedef struct render_buffer_layout_t render_buffer_layout_t;
+typedef struct render_buffer_layout_field_t render_buffer_layout_field_t;
+typedef struct render_buffer_pool_t render_buffer_pool_t;
+typedef struct render_buffer_pool_range_t render_buffer_pool_range_t;
+typedef struct render_buffer_pool_statistics_t render_buffer_pool_statistics_t;
+typedef struct render_buffer_residency_t render_buffer_residency_t;
+typedef struct render_buffer_upload_queue_t render_buffer_upload_queue_t;
+typedef struct render_buffer_residency_statistics_t render_buffer_residency_statistics_t;
+typedef struct render_ring_buffer_t render_ring_buffer_t;
+typedef struct render_ring_allocation_t render_ring_allocation_t;
 typedef struct render_argument_t render_argument_t;
 
 typedef uint32_t render_pipeline_state_t;
 typedef uint32_t render_buffer_index_t;
 typedef uint32_t render_count_t;
 typedef uint32_t render_offset_t;
+typedef uint32_t render_handle_t;
+
+typedef void (*render_pipeline_record_fn)(render_pipeline_t*, void*);
+typedef void (*render_target_read_fn)(render_target_t*, const render_rect_t*, const void*, size_t, void*);
 
 typedef bool (*render_backend_construct_fn)(render_backend_t*);
 typedef void (*render_backend_destruct_fn)(render_backend_t*);
@@ -153,6 +262,8 @@ typedef render_target_t* (*render_backend_target_window_allocate_fn)(render_back
 typedef render_target_t* (*render_backend_target_texture_allocate_fn)(render_backend_t*, uint, uint,
                                                                       render_pixelformat_t);
 typedef void (*render_backend_target_deallocate_fn)(render_backend_t*, render_target_t*);
+typedef bool (*render_backend_target_read_pixels_fn)(render_backend_t*, render_target_t*, const render_rect_t*, void*,
+                                                     render_target_read_fn, void*);
 typedef render_pipeline_t* (*render_backend_pipeline_allocate_fn)(render_backend_t*, render_indexformat_t, uint);
 typedef void (*render_backend_pipeline_deallocate_fn)(render_backend_t*, render_pipeline_t*);
 typedef void (*render_backend_pipeline_set_color_attachment_fn)(render_backend_t*, render_pipeline_t*, uint,
@@ -168,12 +279,14 @@ typedef render_pipeline_state_t (*render_backend_pipeline_state_allocate_fn)(ren
                                                                              render_shader_t*);
 typedef void (*render_backend_pipeline_state_deallocate_fn)(render_backend_t*, render_pipeline_state_t);
 typedef void (*render_backend_pipeline_flush_fn)(render_backend_t*, render_pipeline_t*);
+typedef void (*render_backend_pipeline_wait_fn)(render_backend_t*, render_pipeline_t*, uint);
 typedef void (*render_backend_pipeline_use_buffer_fn)(render_backend_t*, render_pipeline_t*, render_buffer_index_t);
 typedef bool (*render_backend_shader_upload_fn)(render_backend_t*, render_shader_t*, const void*, size_t);
 typedef void (*render_backend_shader_finalize_fn)(render_backend_t*, render_shader_t*);
 typedef void (*render_backend_buffer_allocate_fn)(render_backend_t*, render_buffer_t*, size_t, const void*, size_t);
 typedef void (*render_backend_buffer_deallocate_fn)(render_backend_t*, render_buffer_t*, bool, bool);
 typedef void (*render_backend_buffer_upload_fn)(render_backend_t*, render_buffer_t*, size_t, size_t);
+typedef render_buffer_t* (*render_backend_buffer_lookup_fn)(render_backend_t*, render_buffer_index_t);
 typedef void (*render_backend_buffer_set_label_fn)(render_backend_t*, render_buffer_t*, const char*, size_t);
 typedef void (*render_backend_buffer_data_declare_fn)(render_backend_t*, render_buffer_t*, size_t,
                                                       const render_buffer_data_t*, size_t);
@@ -183,9 +296,17 @@ typedef void (*render_backend_buffer_data_encode_matrix_fn)(render_backend_t*, r
                                                             const matrix_t*);
 typedef void (*render_backend_buffer_data_encode_constant_fn)(render_backend_t*, render_buffer_t*, uint, uint,
                                                               const void*, uint);
+typedef void (*render_backend_buffer_data_encode_matrix_array_fn)(render_backend_t*, render_buffer_t*, uint, uint,
+                                                                  uint, const matrix_t*);
+typedef void (*render_backend_buffer_data_encode_constant_array_fn)(render_backend_t*, render_buffer_t*, uint, uint,
+                                                                    uint, const void*, uint);
+
+//! Reload content of a buffer whose CPU storage was released, return false if content could not be restored
+typedef bool (*render_buffer_restore_fn)(render_buffer_t* buffer, void* store, size_t size, void* userdata);
 
 struct render_config_t {
-	uint unused;
+	//! Task scheduler for parallel pipeline recording, null to record in the calling thread
+	task_scheduler_t* task_scheduler;
 };
 
 struct render_backend_vtable_t {
@@ -196,6 +317,7 @@ struct render_backend_vtable_t {
 	render_backend_target_window_allocate_fn target_window_allocate;
 	render_backend_target_texture_allocate_fn target_texture_allocate;
 	render_backend_target_deallocate_fn target_deallocate;
+	render_backend_target_read_pixels_fn target_read_pixels;
 	render_backend_pipeline_allocate_fn pipeline_allocate;
 	render_backend_pipeline_deallocate_fn pipeline_deallocate;
 	render_backend_pipeline_set_color_attachment_fn pipeline_set_color_attachment;
@@ -204,6 +326,7 @@ struct render_backend_vtable_t {
 	render_backend_pipeline_set_depth_clear_fn pipeline_set_depth_clear;
 	render_backend_pipeline_build_fn pipeline_build;
 	render_backend_pipeline_flush_fn pipeline_flush;
+	render_backend_pipeline_wait_fn pipeline_wait;
 	render_backend_pipeline_use_buffer_fn pipeline_use_argument_buffer;
 	render_backend_pipeline_use_buffer_fn pipeline_use_render_buffer;
 	render_backend_pipeline_state_allocate_fn pipeline_state_allocate;
@@ -214,10 +337,15 @@ struct render_backend_vtable_t {
 	render_backend_buffer_deallocate_fn buffer_deallocate;
 	render_backend_buffer_upload_fn buffer_upload;
 	render_backend_buffer_set_label_fn buffer_set_label;
+	render_backend_buffer_lookup_fn buffer_lookup;
 	render_backend_buffer_data_declare_fn buffer_data_declare;
 	render_backend_buffer_data_encode_buffer_fn buffer_data_encode_buffer;
 	render_backend_buffer_data_encode_matrix_fn buffer_data_encode_matrix;
 	render_backend_buffer_data_encode_constant_fn buffer_data_encode_constant;
+	render_backend_buffer_data_encode_matrix_array_fn buffer_data_encode_matrix_array;
+	render_backend_buffer_data_encode_constant_array_fn buffer_data_encode_constant_array;
+	//! Set if the backend reads the command stream of pipelines at flush, otherwise commands are only counted
+	bool command_stream;
 };
 
 #if FOUNDATION_SIZE_POINTER == 4
@@ -228,6 +356,99 @@ struct render_backend_vtable_t {
 #define RENDER_32BIT_PADDING_ARR(...)
 #endif
 
+//! Live count and size of resources, with high-water marks
+struct render_resource_statistics_t {
+	uint64_t count;
+	uint64_t bytes;
+	uint64_t count_high_water;
+	uint64_t bytes_high_water;
+};
+
+struct render_backend_statistics_t {
+	//! Resources by usage flag, a resource with multiple usage flags is accounted in each.
+	//  Shaders and pipeline states are accounted as GPU only
+	render_resource_statistics_t usage[RENDERUSAGEINDEX_COUNT];
+	//! Resources by type
+	render_resource_statistics_t type[RENDERRESOURCE_COUNT];
+	//! All resources
+	render_resource_statistics_t total;
+	//! Number of frames, advanced once per backend frame by pipeline flushes
+	uint64_t frame_count;
+	//! Number of allocations and allocated bytes in the last completed frame
+	uint64_t frame_allocations;
+	uint64_t frame_bytes;
+	//! Average number of allocations and allocated bytes per completed frame
+	real average_allocations;
+	real average_bytes;
+};
+
+//! Residency manager of buffer CPU storage in a backend, see residency.h
+struct render_buffer_residency_t {
+	mutex_t* lock;
+	//! Tracked buffers, and scratch array of eviction candidates
+	render_buffer_t** buffer;
+	render_buffer_t** candidate;
+	//! Budget in bytes of resident CPU storage of tracked buffers, 0 to disable eviction
+	size_t budget;
+	//! Number of frames a buffer must be untouched before it can be evicted
+	uint frames;
+	size_t bytes_resident;
+	size_t bytes_snapshot;
+	uint64_t evictions;
+	uint64_t restores;
+};
+
+//! Queue of buffers with pending uploads in a backend, see upload.h
+struct render_buffer_upload_queue_t {
+	//! Head of the lock-free list of queued buffers, linked through the buffer upload link
+	atomicptr_t head;
+	//! Batch accepting new uploads, and last drained batch
+	atomic64_t batch_submit;
+	atomic64_t batch_complete;
+	//! Serializes draining of the queue
+	mutex_t* lock;
+	//! Number of buffers uploaded in the last drained batch, and in total
+	uint batch_count;
+	uint64_t total_count;
+};
+
+//! Slot of a slab pool object
+struct render_slab_slot_t {
+	//! Handle of the object in the slot, 0 if free
+	atomic32_t handle;
+	//! Generation given to the next object in the slot
+	uint generation;
+	//! Next slot in the free list plus one
+	uint next_free;
+};
+
+//! Slab pool of fixed size objects addressed by generational handles, see slab.h
+struct render_slab_t {
+	//! Slabs of RENDER_SLAB_OBJECT_COUNT slots followed by their objects, allocated on demand and never moved
+	atomicptr_t slab[RENDER_SLAB_COUNT];
+	//! Byte stride between objects in a slab, and offset of the first object
+	uint stride;
+	uint offset;
+	//! Free list head, slot index plus one, 0 if empty
+	uint free;
+	//! Number of slots handed out from the end of the pool
+	atomic32_t used;
+	//! Number of live objects
+	uint count;
+	//! Serializes allocation and release of slots
+	mutex_t* lock;
+};
+
+struct render_buffer_residency_statistics_t {
+	uint tracked_count;
+	uint evicted_count;
+	size_t bytes_resident;
+	//! Bytes held by compressed snapshots of evicted buffers
+	size_t bytes_snapshot;
+	uint64_t evictions;
+	uint64_t restores;
+};
+
 struct render_backend_t {
 	render_api_t api;
 	render_api_group_t api_group;
@@ -236,6 +457,17 @@ struct render_backend_t {
 	uint64_t platform;
 	uuidmap_fixed_t shader_table;
 	hash_t shader_type;
+	//! Resource accounting, counters of the current frame and totals of completed frames
+	mutex_t* statistics_lock;
+	render_backend_statistics_t statistics;
+	uint64_t statistics_allocations;
+	uint64_t statistics_bytes;
+	uint64_t statistics_allocations_total;
+	uint64_t statistics_bytes_total;
+	render_buffer_residency_t residency;
+	render_buffer_upload_queue_t upload;
+	//! Storage of buffer objects
+	render_slab_t buffer_slab;
 };
 
 struct render_resolution_t {
@@ -248,33 +480,210 @@ struct render_resolution_t {
 
 struct render_target_t {
 	render_backend_t* backend;
+	//! Handle of the target in the slab pool of the backend, 0 if the backend does not pool targets
+	render_handle_t handle;
 	render_target_type_t type;
 	uint width;
 	uint height;
 	render_pixelformat_t pixelformat;
 	render_colorspace_t colorspace;
+	//! Size in bytes of a pixel
+	uint pixel_size;
+	//! Size in bytes of a row of pixels in CPU storage
+	uint stride;
+	//! CPU pixel storage on backends rendering on the CPU, null otherwise
+	void* pixels;
+};
+
+//! Rectangle of pixels in a render target, origin in the top left corner
+struct render_rect_t {
+	uint x;
+	uint y;
+	uint width;
+	uint height;
+};
+
+//! Fill count of a primitive chunk reserved by a queueing thread, padded to avoid false sharing
+FOUNDATION_ALIGNED_STRUCT(render_pipeline_chunk_t, 64) {
+	atomic32_t used;
+	uint32_t padding[15];
+};
+
+//! Command in a delta command stream, binding commands are only emitted when state changes
+struct render_command_t {
+	//! Command type (render_command_type_t)
+	uint16_t type;
+	//! Descriptor slot of bind descriptor commands
+	uint16_t slot;
+	//! Command value, see render_command_type_t
+	uint32_t value;
+};
+
+//! Delta command stream encoded from a primitive buffer
+struct render_command_buffer_t {
+	render_command_t* command;
+	uint count;
+	uint capacity;
+	//! Number of redundant binding commands eliminated in last encode
+	uint eliminated;
+	//! Number of draws merged into instanced draws in last encode
+	uint merged;
+	//! Number of pipeline state, argument buffer and descriptor binds and draws in last encode
+	uint state_binds;
+	uint argument_binds;
+	uint descriptor_binds;
+	uint draws;
+};
+
+/*! Indirect indexed draw record, layout matches VkDrawIndexedIndirectCommand and
+    MTLDrawIndexedPrimitivesIndirectArguments */
+struct render_indirect_command_t {
+	uint32_t index_count;
+	uint32_t instance_count;
+	//! First index, in indices rather than bytes
+	uint32_t index_start;
+	int32_t vertex_base;
+	uint32_t instance_base;
+};
+
+//! Range of indirect draw records sharing binding state, drawn with one multi-draw-indirect
+struct render_indirect_bucket_t {
+	render_pipeline_state_t pipeline_state;
+	render_buffer_index_t index_buffer;
+	render_buffer_index_t descriptor[4];
+	uint first;
+	uint count;
+};
+
+//! Indirect draw records and buckets compiled from a primitive buffer
+struct render_indirect_buffer_t {
+	render_indirect_command_t* command;
+	uint count;
+	uint capacity;
+	render_indirect_bucket_t* bucket;
+	uint bucket_count;
+	uint bucket_capacity;
+};
+
+//! Frame slot in the ring of frames in flight of a pipeline
+struct render_pipeline_frame_t {
+	//! Primitive buffer of the frame
+	render_buffer_t* primitive_buffer;
+	//! Set when the frame is submitted, cleared when the backend has consumed the frame
+	atomic32_t fence;
+	uint32_t unused;
+	//! Timestamp of frame submission
+	tick_t submit;
+};
+
+//! Counters of a flushed pipeline frame, times are CPU time in seconds
+struct render_pipeline_counters_t {
+	//! Number of primitives queued and flushed
+	real primitives_queued;
+	//! Number of primitives dropped since all overflow blocks were in use
+	real primitives_dropped;
+	//! Number of pipeline state, argument buffer and descriptor binding changes issued by the backend
+	real state_switches;
+	real argument_switches;
+	real descriptor_rebinds;
+	//! Number of draws issued by the backend
+	real draws;
+	//! Time compacting, sorting and encoding queued primitives
+	real time_queue;
+	//! Time waiting for the pipeline barrier and recording tasks
+	real time_barrier;
+	//! Time in the backend flush
+	real time_backend;
+};
+
+struct render_pipeline_statistics_t {
+	//! Number of frames flushed
+	uint64_t frame_count;
+	//! Counters of the last flushed frame
+	render_pipeline_counters_t frame;
+	//! Average counters over the last RENDER_PIPELINE_STATISTICS_FRAMES flushed frames
+	render_pipeline_counters_t average;
 };
 
 struct render_pipeline_t {
 	render_backend_t* backend;
+	//! Handle of the pipeline in the slab pool of the backend, 0 if the backend does not pool pipelines
+	render_handle_t handle;
 	render_target_t* color_attachment[RENDER_TARGET_COLOR_ATTACHMENT_COUNT];
 	render_target_t* depth_attachment;
 	render_buffer_t* primitive_buffer;
 	render_indexformat_t index_format;
+	//! Number of primitive slots reserved by queueing threads, in chunk granularity
 	atomic32_t primitive_used;
 	atomic32_t* barrier;
+	//! Number of outstanding recording tasks, and work item storage of the current frame
+	atomic32_t record_pending;
+	void** record_block;
+	//! Primitive chunk fill counts, one per RENDER_PIPELINE_CHUNK_SIZE slots of the primitive buffer
+	render_pipeline_chunk_t* primitive_chunk;
+	uint primitive_capacity;
+	uint primitive_chunk_count;
+	//! Unique generation, changed on each flush to invalidate thread local chunks
+	uint32_t generation;
+	//! Backend frame count at the last flush, a flush in the same backend frame starts the next one
+	uint64_t backend_frame;
+	//! Overflow blocks chained this frame, and free blocks recycled at flush
+	atomicptr_t primitive_block[RENDER_PIPELINE_BLOCK_COUNT];
+	atomicptr_t primitive_block_free;
+	//! Blocks that lost the race to be chained, only pushed while recording and moved to the free list at flush
+	atomicptr_t primitive_block_spare;
+	//! Number of primitives dropped this frame since all overflow blocks were in use
+	atomic32_t primitive_dropped;
+	//! Highest number of primitives queued in a single frame
+	uint primitive_high_water;
+	//! Total number of primitives dropped
+	uint64_t primitive_dropped_total;
+	//! Ring of frames in flight, primitive_buffer is the buffer of the currently recorded frame
+	render_pipeline_frame_t frame[RENDER_PIPELINE_FRAME_MAX];
+	uint frame_count;
+	uint frame_current;
+	//! Number of flushes that waited for a frame in flight to be consumed when the ring wrapped
+	uint64_t frame_wait_count;
+	//! Delta command stream of the last flushed frame, consumed by backends
+	render_command_buffer_t command;
+	//! Indirect draw records of the last flushed frame if RENDERPIPELINE_INDIRECT is set
+	render_indirect_buffer_t indirect;
+	//! Attached transient ring buffers, regions follow the frame ring
+	render_ring_buffer_t** ring_buffer;
+	//! Pipeline flags (render_pipeline_flag_t)
+	uint flags;
+	//! Sort keys and primitive indices, double buffered, allocated when sorting is enabled
+	uint64_t* sort_key;
+	uint* sort_index;
+	render_primitive_t* sort_store;
+	//! Number of binding state changes removed by sorting in last flush
+	uint sort_changes_saved;
+	//! Total number of binding state changes removed by sorting
+	uint64_t sort_changes_saved_total;
+	//! Counters of the frame being flushed, switch and draw counters are filled by the backend flush
+	render_pipeline_counters_t statistics_frame;
+	//! Ring of counters of recently flushed frames
+	render_pipeline_counters_t statistics_history[RENDER_PIPELINE_STATISTICS_FRAMES];
+	uint64_t statistics_frame_count;
 };
 
 struct render_shader_t {
 	render_backend_t* backend;
 	RENDER_32BIT_PADDING(backendptr)
 	atomic32_t ref;
-	uint32_t unused;
+	//! Size of uploaded shader binary, accounted in backend statistics
+	uint32_t size;
 	uuid_t uuid;
 	uintptr_t backend_data[4];
 	RENDER_32BIT_PADDING_ARR(backend_data, 4)
 };
 
+//! Byte range [begin, end) of a buffer
+struct render_buffer_range_t {
+	size_t begin;
+	size_t end;
+};
+
 struct render_buffer_t {
 	render_backend_t* backend;
 	RENDER_32BIT_PADDING(backendptr)
@@ -283,13 +692,147 @@ struct render_buffer_t {
 	uint8_t buffertype;
 	uint8_t flags;
 	uint8_t unused_byte;
+	//! Depth of nested locks taken by the thread holding the write lock
 	uint32_t locks;
+	//! Handle of the buffer in the buffer slab pool of the backend
+	render_handle_t handle;
 	size_t allocated;
 	size_t used;
 	void* store;
+	//! Store pointer, valid while a lock is held
 	void* access;
 	uintptr_t backend_data[4];
+	//! Thread holding the write lock
+	atomic64_t lock_owner;
+	//! Lock state with read lock count and writer bits, updated lock-free
+	atomic32_t lock_state;
+	//! Set while the contending locker is blocked on the wake semaphore
+	atomic32_t lock_waiting;
+	//! Serializes lockers contending with a writer
 	semaphore_t lock;
+	//! Posted by the releasing thread to wake the blocked contending locker
+	semaphore_t lock_wake;
+	//! Pool and range index of a logical buffer, render index and store are those of the pool block
+	render_buffer_pool_t* pool;
+	uint pool_range;
+	//! Byte offset of a logical buffer in the pool block
+	uint offset;
+	//! Sorted, disjoint dirty ranges pending upload, valid with RENDERBUFFER_DIRTY_RANGE set
+	uint dirty_count;
+	render_buffer_range_t dirty[RENDER_BUFFER_DIRTY_RANGE_COUNT];
+	//! Backend frame the buffer was last locked in
+	uint64_t last_frame;
+	//! Slot in the residency manager plus one, 0 if not tracked
+	uint residency_index;
+	//! Compressed content of the CPU storage while lost, if there is no restore callback
+	size_t snapshot_size;
+	void* snapshot;
+	render_buffer_restore_fn restore;
+	void* restore_data;
+	//! Set while the buffer is in the upload queue of the backend, and link in the queue
+	atomic32_t upload_queued;
+	render_buffer_t* upload_next;
+	//! CPU computed structured data layout, null if not declared or encoded by the backend
+	render_buffer_layout_t* layout;
+};
+
+//! Range of a buffer pool block, linked in address order and in the free list of its size class
+struct render_buffer_pool_range_t {
+	//! Logical buffer owning the range, null if free
+	render_buffer_t* buffer;
+	uint block;
+	uint offset;
+	uint size;
+	uint prev_physical;
+	uint next_physical;
+	uint prev_free;
+	uint next_free;
+	//! Range is free and linked in a free list
+	bool free;
+};
+
+struct render_buffer_pool_t {
+	render_backend_t* backend;
+	uint usage;
+	uint alignment;
+	uint block_size;
+	uint allocation_count;
+	size_t bytes_allocated;
+	//! Backend buffers ranges are carved from, null for released blocks
+	render_buffer_t** block;
+	//! Range nodes, and indices of nodes not in use
+	render_buffer_pool_range_t* range;
+	uint* range_unused;
+	//! Free list heads and occupancy bitmaps of the size classes
+	uint32_t first_level;
+	uint32_t second_level[RENDER_BUFFER_POOL_FL_COUNT];
+	uint free_head[RENDER_BUFFER_POOL_FL_COUNT][RENDER_BUFFER_POOL_SL_COUNT];
+	mutex_t* lock;
+};
+
+//! Buffer pool usage, fragmentation is 1 - largest free range / free bytes
+struct render_buffer_pool_statistics_t {
+	uint block_count;
+	uint allocation_count;
+	uint free_range_count;
+	size_t bytes_reserved;
+	size_t bytes_allocated;
+	size_t bytes_free;
+	size_t largest_free;
+	real fragmentation;
+};
+
+//! Transient per-frame ring allocator, one region of the buffer per pipeline frame in flight
+struct render_ring_buffer_t {
+	render_pipeline_t* pipeline;
+	render_buffer_t* buffer;
+	//! Alignment of allocations in bytes
+	uint alignment;
+	//! Number of regions, matching the frame count of the pipeline, and size of each region
+	uint region_count;
+	uint region_size;
+	//! Byte offset of the region of the frame being recorded
+	uint region_offset;
+	//! Bytes allocated in the current region
+	atomic32_t used;
+	//! Allocations failed in the current region since it was exhausted
+	atomic32_t dropped;
+	//! Highest number of bytes allocated in a single frame
+	uint high_water;
+	//! Total number of failed allocations in flushed frames
+	uint64_t dropped_total;
+};
+
+//! Allocation from a ring buffer
+struct render_ring_allocation_t {
+	//! Render index of the ring buffer, usable as primitive descriptor or argument buffer
+	render_buffer_index_t render_index;
+	//! Byte offset of the allocation in the buffer
+	render_offset_t offset;
+	//! CPU pointer to the allocation, null if allocation failed
+	void* pointer;
+};
+
+//! Entry in a render index table
+struct render_index_table_entry_t {
+	//! Object mapped to the index, null if free
+	atomicptr_t object;
+	//! Next index in the free list
+	atomic32_t next_free;
+};
+
+//! Growable render index table, see table.h
+struct render_index_table_t {
+	//! Segments of RENDER_INDEX_TABLE_SEGMENT_SIZE entries, allocated on demand and never moved
+	atomicptr_t segment[RENDER_INDEX_TABLE_SEGMENT_COUNT];
+	//! Free list head, index in the low 32 bits and generation tag in the high 32 bits
+	atomic64_t free;
+	//! Number of indices handed out from the end of the table
+	atomic32_t count;
+	//! Maximum number of indices
+	uint capacity;
+	//! Serializes allocation of new segments
+	mutex_t* lock;
 };
 
 //! Buffer structured data
@@ -299,6 +842,32 @@ struct render_buffer_data_t {
 	uint array_count;
 };
 
+//! Field of a structured data layout
+struct render_buffer_layout_field_t {
+	//! Byte offset of the field in an instance
+	uint offset;
+	//! Size in bytes of the field including all array elements, 0 if the index is not declared
+	uint size;
+	//! Byte stride between array elements
+	uint array_stride;
+	//! Number of array elements, 1 for a field that is not an array
+	uint array_count;
+	render_data_type data_type;
+};
+
+//! Structured data layout with precomputed per-instance field offsets
+struct render_buffer_layout_t {
+	render_buffer_layout_rule_t rule;
+	//! Byte stride between instances
+	uint stride;
+	//! Base alignment of the instance structure
+	uint alignment;
+	//! Number of fields, one per argument index up to the highest declared index
+	uint field_count;
+	//! Fields indexed by argument index
+	render_buffer_layout_field_t* field;
+};
+
 struct render_argument_t {
 	render_count_t index_count;
 	render_count_t instance_count;
@@ -315,3 +884,10 @@ struct render_primitive_t {
 	render_buffer_index_t index_buffer;
 	render_buffer_index_t descriptor[4];
 };
+
+//! Overflow block of primitive chunks, chained to a pipeline when the primitive buffer is full
+struct render_pipeline_block_t {
+	render_pipeline_chunk_t chunk[RENDER_PIPELINE_BLOCK_CHUNK_COUNT];
+	render_primitive_t primitive[RENDER_PIPELINE_BLOCK_CHUNK_COUNT * RENDER_PIPELINE_CHUNK_SIZE];
+	render_pipeline_block_t* next;
+};
@@ -0,0 +1,122 @@
+/* upload.c  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+
+#include <render/render.h>
+#include <render/internal.h>
+
+void
+render_buffer_upload_initialize(render_backend_t* backend) {
+	render_buffer_upload_queue_t* queue = &backend->upload;
+	memset(queue, 0, sizeof(render_buffer_upload_queue_t));
+	queue->lock = mutex_allocate(STRING_CONST("Buffer upload queue"));
+	atomic_store64(&queue->batch_submit, 1, memory_order_relaxed);
+	atomic_store64(&queue->batch_complete, 0, memory_order_release);
+}
+
+void
+render_buffer_upload_finalize(render_backend_t* backend) {
+	render_buffer_upload_queue_t* queue = &backend->upload;
+	mutex_deallocate(queue->lock);
+	queue->lock = nullptr;
+}
+
+void
+render_buffer_upload_enqueue(render_buffer_t* buffer) {
+	// Only the first unlock since the last drain links the buffer, later dirty ranges are
+	// coalesced in the pending upload
+	if (!atomic_cas32(&buffer->upload_queued, 1, 0, memory_order_acquire, memory_order_relaxed))
+		return;
+	render_buffer_upload_queue_t* queue = &buffer->backend->upload;
+	render_buffer_t* head;
+	do {
+		head = atomic_load_ptr(&queue->head, memory_order_relaxed);
+		buffer->upload_next = head;
+	} while (!atomic_cas_ptr(&queue->head, buffer, head, memory_order_release, memory_order_relaxed));
+}
+
+// Drain the queue, upload lock must be held
+static uint64_t
+render_buffer_upload_drain(render_buffer_upload_queue_t* queue) {
+	// Close the current batch before detaching the list, uploads queued after this point belong
+	// to the next batch
+	uint64_t batch = (uint64_t)atomic_incr64(&queue->batch_submit, memory_order_release) - 1;
+	render_buffer_t* head = atomic_load_ptr(&queue->head, memory_order_acquire);
+	while (head && !atomic_cas_ptr(&queue->head, nullptr, head, memory_order_acquire, memory_order_relaxed))
+		head = atomic_load_ptr(&queue->head, memory_order_acquire);
+
+	// List is pushed in reverse, restore queue order
+	render_buffer_t* buffer = nullptr;
+	while (head) {
+		render_buffer_t* next = head->upload_next;
+		head->upload_next = buffer;
+		buffer = head;
+		head = next;
+	}
+
+	uint count = 0;
+	while (buffer) {
+		render_buffer_t* next = buffer->upload_next;
+		buffer->upload_next = nullptr;
+		// Clear before locking so an unlock after the upload queues the buffer again
+		atomic_store32(&buffer->upload_queued, 0, memory_order_release);
+		render_buffer_lock(buffer, RENDERBUFFER_LOCK_READ);
+		render_buffer_upload(buffer, 0, 0);
+		render_buffer_unlock(buffer);
+		buffer = next;
+		++count;
+	}
+
+	queue->batch_count = count;
+	queue->total_count += count;
+	atomic_store64(&queue->batch_complete, (int64_t)batch, memory_order_release);
+	return batch;
+}
+
+uint64_t
+render_buffer_upload_flush(render_backend_t* backend) {
+	render_buffer_upload_queue_t* queue = &backend->upload;
+	render_trace_begin("render_buffer_upload_flush");
+	mutex_lock(queue->lock);
+	uint64_t batch = render_buffer_upload_drain(queue);
+	mutex_unlock(queue->lock);
+	render_trace_end("render_buffer_upload_flush");
+	return batch;
+}
+
+void
+render_buffer_upload_discard(render_buffer_t* buffer) {
+	// The drain holds the lock while processing detached buffers, so once taken the buffer is
+	// either uploaded or still linked in the queue
+	render_buffer_upload_queue_t* queue = &buffer->backend->upload;
+	mutex_lock(queue->lock);
+	if (atomic_load32(&buffer->upload_queued, memory_order_acquire))
+		render_buffer_upload_drain(queue);
+	mutex_unlock(queue->lock);
+}
+
+uint64_t
+render_buffer_upload_fence(render_backend_t* backend) {
+	return (uint64_t)atomic_load64(&backend->upload.batch_submit, memory_order_acquire);
+}
+
+bool
+render_buffer_upload_fence_reached(render_backend_t* backend, uint64_t fence) {
+	return (uint64_t)atomic_load64(&backend->upload.batch_complete, memory_order_acquire) >= fence;
+}
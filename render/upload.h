@@ -0,0 +1,49 @@
+/* upload.h  -  Render library  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The dependent library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file upload.h
+    Batched buffer uploads. Releasing a write all lock queues the buffer in a lock-free queue of
+    the backend instead of uploading on the unlocking thread. The queue is drained when a pipeline
+    of the backend is flushed, uploading the coalesced dirty ranges of each queued buffer once.
+    Uploads are grouped in batches, a fence identifies the batch of uploads queued before it */
+
+#include <foundation/platform.h>
+
+#include <render/types.h>
+
+/*! Drain the upload queue of a backend, uploading all queued buffers. Called when a pipeline of
+    the backend is flushed
+    \param backend Backend
+    \return Fence of the batch that was completed */
+RENDER_API uint64_t
+render_buffer_upload_flush(render_backend_t* backend);
+
+/*! Get a fence for all uploads queued before this call
+    \param backend Backend
+    \return Fence */
+RENDER_API uint64_t
+render_buffer_upload_fence(render_backend_t* backend);
+
+/*! Check if the uploads queued before a fence was taken have been issued to the backend
+    \param backend Backend
+    \param fence Fence
+    \return true if completed, false if not */
+RENDER_API bool
+render_buffer_upload_fence_reached(render_backend_t* backend, uint64_t fence);
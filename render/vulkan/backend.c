@@ -610,6 +610,14 @@ rb_vulkan_target_deallocate(render_backend_t* backend, render_target_t* target)
 	memory_deallocate(target);
 }
 
+static bool
+rb_vulkan_target_read_pixels(render_backend_t* backend, render_target_t* target, const render_rect_t* rect, void* dst,
+                             render_target_read_fn callback, void* context) {
+	FOUNDATION_UNUSED(backend, target, rect, dst, callback, context);
+	log_warn(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Vulkan backend does not support reading target pixels"));
+	return false;
+}
+
 static render_pipeline_t*
 rb_vulkan_pipeline_allocate(render_backend_t* backend, render_indexformat_t index_format, uint capacity) {
 	render_pipeline_vulkan_t* pipeline_vk =
@@ -720,7 +728,14 @@ rb_vulkan_pipeline_build(render_backend_t* backend, render_pipeline_t* pipeline)
 
 static void
 rb_vulkan_pipeline_flush(render_backend_t* backend, render_pipeline_t* pipeline) {
-	FOUNDATION_UNUSED(backend, pipeline);
+	FOUNDATION_UNUSED(backend);
+	render_pipeline_statistics_encoded(pipeline);
+	render_pipeline_frame_signal(pipeline, pipeline->frame_current);
+}
+
+static void
+rb_vulkan_pipeline_wait(render_backend_t* backend, render_pipeline_t* pipeline, uint frame) {
+	FOUNDATION_UNUSED(backend, pipeline, frame);
 }
 
 static void
@@ -788,25 +803,45 @@ rb_vulkan_buffer_upload(render_backend_t* backend, render_buffer_t* buffer, size
 static void
 rb_vulkan_buffer_data_declare(render_backend_t* backend, render_buffer_t* buffer, size_t instance_count,
                               const render_buffer_data_t* data, size_t data_count) {
-	FOUNDATION_UNUSED(backend, buffer, data, data_count, instance_count);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_declare(buffer, instance_count, data, data_count, RENDERLAYOUT_STD140);
 }
 
 static void
 rb_vulkan_buffer_data_encode_buffer(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                     render_buffer_t* source, uint offset) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, source, offset);
+	FOUNDATION_UNUSED(backend);
+	// Buffer device addresses are not available without device buffers, encode the render index
+	// and offset of the source buffer
+	render_buffer_layout_encode_pointer(buffer, instance, index, ((uint64_t)source->render_index << 32) | offset);
 }
 
 static void
 rb_vulkan_buffer_data_encode_constant(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                       const void* data, uint size) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, data, size);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_constant(buffer, instance, 1, index, data, size);
 }
 
 static void
 rb_vulkan_buffer_data_encode_matrix(render_backend_t* backend, render_buffer_t* buffer, uint instance, uint index,
                                     const matrix_t* matrix) {
-	FOUNDATION_UNUSED(backend, buffer, instance, index, matrix);
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_matrix(buffer, instance, 1, index, matrix);
+}
+
+static void
+rb_vulkan_buffer_data_encode_matrix_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                          uint count, uint index, const matrix_t* matrices) {
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_matrix(buffer, first_instance, count, index, matrices);
+}
+
+static void
+rb_vulkan_buffer_data_encode_constant_array(render_backend_t* backend, render_buffer_t* buffer, uint first_instance,
+                                            uint count, uint index, const void* data, uint size) {
+	FOUNDATION_UNUSED(backend);
+	render_buffer_layout_encode_constant(buffer, first_instance, count, index, data, size);
 }
 
 static void
@@ -814,6 +849,12 @@ rb_vulkan_buffer_set_label(render_backend_t* backend, render_buffer_t* buffer, c
 	FOUNDATION_UNUSED(backend, buffer, name, length);
 }
 
+static render_buffer_t*
+rb_vulkan_buffer_lookup(render_backend_t* backend, render_buffer_index_t index) {
+	FOUNDATION_UNUSED(backend, index);
+	return nullptr;
+}
+
 static render_backend_vtable_t render_backend_vtable_null = {
     .construct = rb_vulkan_construct,
     .destruct = rb_vulkan_destruct,
@@ -822,6 +863,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .target_window_allocate = rb_vulkan_target_window_allocate,
     .target_texture_allocate = rb_vulkan_target_texture_allocate,
     .target_deallocate = rb_vulkan_target_deallocate,
+    .target_read_pixels = rb_vulkan_target_read_pixels,
     .pipeline_allocate = rb_vulkan_pipeline_allocate,
     .pipeline_deallocate = rb_vulkan_pipeline_deallocate,
     .pipeline_set_color_attachment = rb_vulkan_pipeline_set_color_attachment,
@@ -830,6 +872,7 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .pipeline_set_depth_clear = rb_vulkan_pipeline_set_depth_clear,
     .pipeline_build = rb_vulkan_pipeline_build,
     .pipeline_flush = rb_vulkan_pipeline_flush,
+    .pipeline_wait = rb_vulkan_pipeline_wait,
     .pipeline_use_argument_buffer = rb_vulkan_pipeline_use_argument_buffer,
     .pipeline_use_render_buffer = rb_vulkan_pipeline_use_render_buffer,
     .pipeline_state_allocate = rb_vulkan_pipeline_state_allocate,
@@ -840,10 +883,13 @@ static render_backend_vtable_t render_backend_vtable_null = {
     .buffer_deallocate = rb_vulkan_buffer_deallocate,
     .buffer_upload = rb_vulkan_buffer_upload,
     .buffer_set_label = rb_vulkan_buffer_set_label,
+    .buffer_lookup = rb_vulkan_buffer_lookup,
     .buffer_data_declare = rb_vulkan_buffer_data_declare,
     .buffer_data_encode_buffer = rb_vulkan_buffer_data_encode_buffer,
     .buffer_data_encode_matrix = rb_vulkan_buffer_data_encode_matrix,
-    .buffer_data_encode_constant = rb_vulkan_buffer_data_encode_constant};
+    .buffer_data_encode_constant = rb_vulkan_buffer_data_encode_constant,
+    .buffer_data_encode_matrix_array = rb_vulkan_buffer_data_encode_matrix_array,
+    .buffer_data_encode_constant_array = rb_vulkan_buffer_data_encode_constant_array};
 
 render_backend_t*
 render_backend_vulkan_allocate(void) {
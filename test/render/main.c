@@ -20,8 +20,11 @@
 #include <window/window.h>
 #include <resource/resource.h>
 #include <render/render.h>
+#include <render/null/backend.h>
+#include <render/software/backend.h>
 #include <vector/vector.h>
 #include <network/network.h>
+#include <task/task.h>
 #include <test/test.h>
 
 #if FOUNDATION_COMPILER_CLANG
@@ -86,6 +89,11 @@ test_render_initialize(void) {
 	if (vector_module_initialize(vector_config))
 		return -1;
 
+	task_config_t task_config;
+	memset(&task_config, 0, sizeof(task_config));
+	if (task_module_initialize(task_config))
+		return -1;
+
 	render_config_t render_config;
 	memset(&render_config, 0, sizeof(render_config));
 	if (render_module_initialize(render_config))
@@ -100,6 +108,7 @@ test_render_initialize(void) {
 static void
 test_render_finalize(void) {
 	render_module_finalize();
+	task_module_finalize();
 	vector_module_finalize();
 	resource_module_finalize();
 	network_module_finalize();
@@ -399,6 +408,1441 @@ ignore_test:
 	return 0;
 }
 
+typedef struct test_render_queue_arg_t {
+	render_pipeline_t* pipeline;
+	uint thread_index;
+	uint count;
+} test_render_queue_arg_t;
+
+static void*
+test_render_queue_thread(void* arg) {
+	test_render_queue_arg_t* queue_arg = arg;
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.descriptor[0] = queue_arg->thread_index;
+	for (uint iprim = 0; iprim < queue_arg->count; ++iprim) {
+		primitive.argument_offset = iprim;
+		render_pipeline_queue(queue_arg->pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	return 0;
+}
+
+DECLARE_TEST(render, null_queue) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	const uint primitive_count = 1024 * 1024;
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, primitive_count);
+	EXPECT_NE(pipeline, nullptr);
+	// Single frame in flight so the flushed primitive buffer remains current
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	thread_t thread[32];
+	test_render_queue_arg_t queue_arg[32];
+	uint next_offset[32];
+	uint thread_max = (uint)system_hardware_threads();
+	if (thread_max > 32)
+		thread_max = 32;
+	if (thread_max < 1)
+		thread_max = 1;
+
+	for (uint thread_count = 1; thread_count <= thread_max; ++thread_count) {
+		uint count = primitive_count / thread_count;
+		for (uint ithread = 0; ithread < thread_count; ++ithread) {
+			queue_arg[ithread].pipeline = pipeline;
+			queue_arg[ithread].thread_index = ithread;
+			queue_arg[ithread].count = count;
+			thread_initialize(&thread[ithread], test_render_queue_thread, &queue_arg[ithread],
+			                  STRING_CONST("render_queue"), THREAD_PRIORITY_NORMAL, 0);
+		}
+
+		for (uint ithread = 0; ithread < thread_count; ++ithread)
+			thread_start(&thread[ithread]);
+		for (uint ithread = 0; ithread < thread_count; ++ithread)
+			thread_join(&thread[ithread]);
+
+		for (uint ithread = 0; ithread < thread_count; ++ithread)
+			thread_finalize(&thread[ithread]);
+
+		render_pipeline_flush(pipeline);
+
+		// Primitives must be contiguous after flush, and keep the queue order of each thread
+		EXPECT_SIZEEQ(pipeline->primitive_buffer->used, (size_t)count * thread_count);
+		memset(next_offset, 0, sizeof(next_offset));
+		const render_primitive_t* primitive = pipeline->primitive_buffer->store;
+		for (size_t iprim = 0; iprim < pipeline->primitive_buffer->used; ++iprim, ++primitive) {
+			uint ithread = primitive->descriptor[0];
+			EXPECT_TRUE(ithread < thread_count);
+			EXPECT_UINTEQ(primitive->argument_offset, next_offset[ithread]);
+			++next_offset[ithread];
+		}
+	}
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_queue_batch) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	const uint capacity = 1000;
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, capacity);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	render_primitive_t primitives[600];
+	memset(primitives, 0, sizeof(primitives));
+	for (uint iprim = 0; iprim < 600; ++iprim)
+		primitives[iprim].argument_offset = iprim;
+
+	// Single primitive queue calls continue in the partially filled chunk of the batch
+	EXPECT_UINTEQ(render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives, 100), 100);
+	render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives + 100);
+	EXPECT_UINTEQ(render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives + 101, 499), 499);
+
+	// Batch overflowing capacity is chained in overflow blocks and the buffer grows at flush
+	EXPECT_UINTEQ(render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives, 600), 600);
+	EXPECT_UINTEQ(render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives, 1), 1);
+
+	render_pipeline_flush(pipeline);
+	EXPECT_SIZEEQ(pipeline->primitive_buffer->used, 1201);
+	EXPECT_TRUE(pipeline->primitive_capacity >= 1201);
+	EXPECT_UINTEQ(render_pipeline_primitive_high_water(pipeline), 1201);
+	EXPECT_UINTEQ((uint)render_pipeline_primitive_dropped(pipeline), 0);
+
+	const render_primitive_t* primitive = pipeline->primitive_buffer->store;
+	for (uint iprim = 0; iprim < 1200; ++iprim)
+		EXPECT_UINTEQ(primitive[iprim].argument_offset, iprim % 600);
+	EXPECT_UINTEQ(primitive[1200].argument_offset, 0);
+
+	// Next frame fits the grown buffer without overflow blocks
+	for (uint iprim = 0; iprim < 600; ++iprim)
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitives + iprim);
+	render_pipeline_flush(pipeline);
+	EXPECT_SIZEEQ(pipeline->primitive_buffer->used, 600);
+	EXPECT_UINTEQ(render_pipeline_primitive_high_water(pipeline), 1201);
+	EXPECT_EQ(atomic_load_ptr(&pipeline->primitive_block[0], memory_order_acquire), nullptr);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_queue_overflow) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	const uint capacity = 1000;
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, capacity);
+	EXPECT_NE(pipeline, nullptr);
+
+	thread_t thread[8];
+	test_render_queue_arg_t queue_arg[8];
+	uint next_offset[8];
+	uint thread_count = (uint)system_hardware_threads();
+	if (thread_count > 8)
+		thread_count = 8;
+	if (thread_count < 1)
+		thread_count = 1;
+
+	// Every thread alone overflows the capacity, spilling into overflow blocks
+	const uint count = capacity * 3;
+	for (uint ithread = 0; ithread < thread_count; ++ithread) {
+		queue_arg[ithread].pipeline = pipeline;
+		queue_arg[ithread].thread_index = ithread;
+		queue_arg[ithread].count = count;
+		thread_initialize(&thread[ithread], test_render_queue_thread, &queue_arg[ithread],
+		                  STRING_CONST("render_queue"), THREAD_PRIORITY_NORMAL, 0);
+	}
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_start(&thread[ithread]);
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_join(&thread[ithread]);
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_finalize(&thread[ithread]);
+
+	render_pipeline_flush(pipeline);
+
+	// Count is stored in the grown buffer, which holds all primitives in per thread queue order
+	EXPECT_SIZEEQ(pipeline->primitive_buffer->used, (size_t)count * thread_count);
+	EXPECT_TRUE(pipeline->primitive_capacity >= count * thread_count);
+	EXPECT_UINTEQ((uint)render_pipeline_primitive_dropped(pipeline), 0);
+	memset(next_offset, 0, sizeof(next_offset));
+	const render_primitive_t* primitive = pipeline->primitive_buffer->store;
+	for (size_t iprim = 0; iprim < pipeline->primitive_buffer->used; ++iprim, ++primitive) {
+		uint ithread = primitive->descriptor[0];
+		EXPECT_TRUE(ithread < thread_count);
+		EXPECT_UINTEQ(primitive->argument_offset, next_offset[ithread]);
+		++next_offset[ithread];
+	}
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		EXPECT_UINTEQ(next_offset[ithread], count);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_queue_sort) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 4096);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+	render_pipeline_enable(pipeline, RENDERPIPELINE_SORT);
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	for (uint iprim = 0; iprim < 4096; ++iprim) {
+		primitive.pipeline_state = 1 + (iprim % 3);
+		primitive.argument_buffer = 1 + (iprim % 5);
+		primitive.descriptor[0] = 1 + (iprim % 2);
+		primitive.argument_offset = iprim;
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+
+	render_pipeline_flush(pipeline);
+	EXPECT_SIZEEQ(pipeline->primitive_buffer->used, 4096);
+	EXPECT_UINTNE(pipeline->sort_changes_saved, 0);
+
+	// Pipeline states are grouped, and primitives with equal state keep their queue order
+	uint state_changes = 0;
+	const render_primitive_t* sorted = pipeline->primitive_buffer->store;
+	for (uint iprim = 1; iprim < 4096; ++iprim) {
+		if (sorted[iprim].pipeline_state != sorted[iprim - 1].pipeline_state)
+			++state_changes;
+		else if ((sorted[iprim].argument_buffer == sorted[iprim - 1].argument_buffer) &&
+		         (sorted[iprim].descriptor[0] == sorted[iprim - 1].descriptor[0]))
+			EXPECT_TRUE(sorted[iprim].argument_offset > sorted[iprim - 1].argument_offset);
+	}
+	EXPECT_UINTEQ(state_changes, 2);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_command) {
+	render_primitive_t primitive[3];
+	memset(primitive, 0, sizeof(primitive));
+	for (uint iprim = 0; iprim < 3; ++iprim) {
+		primitive[iprim].pipeline_state = 1;
+		primitive[iprim].argument_buffer = 2;
+		primitive[iprim].argument_offset = iprim * sizeof(render_argument_t);
+		primitive[iprim].index_buffer = 3;
+		primitive[iprim].descriptor[0] = 4;
+		primitive[iprim].descriptor[1] = 5;
+	}
+	primitive[2].descriptor[1] = 6;
+
+	render_command_buffer_t buffer;
+	render_command_buffer_initialize(&buffer);
+	EXPECT_UINTEQ(render_command_encode(&buffer, nullptr, primitive, 3, 0), 9);
+
+	// First draw binds everything non-zero, following draws only changed bindings
+	const render_command_t expected[] = {{RENDERCOMMAND_BIND_STATE, 0, 1},
+	                                     {RENDERCOMMAND_BIND_ARGUMENT, 0, 2},
+	                                     {RENDERCOMMAND_BIND_DESCRIPTOR, 0, 4},
+	                                     {RENDERCOMMAND_BIND_DESCRIPTOR, 1, 5},
+	                                     {RENDERCOMMAND_BIND_INDEX, 0, 3},
+	                                     {RENDERCOMMAND_DRAW, 0, 0},
+	                                     {RENDERCOMMAND_DRAW, 0, sizeof(render_argument_t)},
+	                                     {RENDERCOMMAND_BIND_DESCRIPTOR, 1, 6},
+	                                     {RENDERCOMMAND_DRAW, 0, 2 * sizeof(render_argument_t)}};
+	for (uint icmd = 0; icmd < 9; ++icmd) {
+		EXPECT_UINTEQ(buffer.command[icmd].type, expected[icmd].type);
+		EXPECT_UINTEQ(buffer.command[icmd].slot, expected[icmd].slot);
+		EXPECT_UINTEQ(buffer.command[icmd].value, expected[icmd].value);
+	}
+	EXPECT_UINTEQ(buffer.eliminated, (3 * RENDER_COMMAND_BIND_MAX) - 6);
+
+	render_command_buffer_finalize(&buffer);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_statistics) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+
+	render_pipeline_statistics_t statistics;
+	render_pipeline_statistics(pipeline, &statistics);
+	EXPECT_UINTEQ((uint)statistics.frame_count, 0);
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.argument_buffer = 1;
+	for (uint iframe = 0; iframe < 2; ++iframe) {
+		// Four primitives in two pipeline states in the first frame, two in one state in the second
+		uint count = iframe ? 2 : 4;
+		for (uint iprim = 0; iprim < count; ++iprim) {
+			primitive.pipeline_state = 1 + (iframe ? 0 : (iprim / 2));
+			primitive.descriptor[0] = 1 + iprim;
+			render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+		}
+		render_pipeline_flush(pipeline);
+	}
+
+	render_pipeline_statistics(pipeline, &statistics);
+	EXPECT_UINTEQ((uint)statistics.frame_count, 2);
+	EXPECT_REALEQ(statistics.frame.primitives_queued, 2);
+	EXPECT_REALEQ(statistics.frame.draws, 2);
+	EXPECT_REALEQ(statistics.frame.state_switches, 1);
+	EXPECT_REALEQ(statistics.frame.descriptor_rebinds, 2);
+	EXPECT_REALEQ(statistics.average.primitives_queued, 3);
+	EXPECT_REALEQ(statistics.average.state_switches, REAL_C(1.5));
+	EXPECT_REALEQ(statistics.average.argument_switches, 1);
+	EXPECT_TRUE(statistics.frame.time_backend >= 0);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_merge_instances) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_enable(pipeline, RENDERPIPELINE_MERGE_INSTANCES);
+
+	// Three draws of contiguous instance ranges followed by a draw of a different index range
+	render_argument_t argument[4] = {{36, 2, 0, 0, 0}, {36, 1, 0, 0, 2}, {36, 2, 0, 0, 3}, {12, 1, 36, 0, 5}};
+	render_buffer_t* argument_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(argument), argument, sizeof(argument));
+	EXPECT_NE(argument_buffer->render_index, 0);
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.pipeline_state = 1;
+	primitive.argument_buffer = argument_buffer->render_index;
+	for (uint iprim = 0; iprim < 4; ++iprim) {
+		primitive.argument_offset = iprim * sizeof(render_argument_t);
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	render_pipeline_flush(pipeline);
+
+	EXPECT_UINTEQ(pipeline->command.merged, 2);
+	EXPECT_UINTEQ(pipeline->command.count, 5);
+	const render_command_t* command = pipeline->command.command;
+	EXPECT_UINTEQ(command[2].type, RENDERCOMMAND_INSTANCE_COUNT);
+	EXPECT_UINTEQ(command[2].value, 5);
+	EXPECT_UINTEQ(command[3].type, RENDERCOMMAND_DRAW);
+	EXPECT_UINTEQ(command[3].value, 0);
+	EXPECT_UINTEQ(command[4].type, RENDERCOMMAND_DRAW);
+	EXPECT_UINTEQ(command[4].value, 3 * sizeof(render_argument_t));
+
+	render_buffer_deallocate(argument_buffer);
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_indirect) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_enable(pipeline, RENDERPIPELINE_INDIRECT);
+
+	render_argument_t argument[3] = {{36, 1, 0, 0, 0}, {12, 4, 72, 24, 1}, {6, 2, 96, 8, 5}};
+	render_buffer_t* argument_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(argument), argument, sizeof(argument));
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.argument_buffer = argument_buffer->render_index;
+	for (uint iprim = 0; iprim < 3; ++iprim) {
+		primitive.pipeline_state = (iprim < 2) ? 1 : 2;
+		primitive.argument_offset = iprim * sizeof(render_argument_t);
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	render_pipeline_flush(pipeline);
+
+	EXPECT_UINTEQ(pipeline->indirect.count, 3);
+	EXPECT_UINTEQ(pipeline->indirect.bucket_count, 2);
+	EXPECT_UINTEQ(pipeline->indirect.bucket[0].count, 2);
+	EXPECT_UINTEQ(pipeline->indirect.bucket[1].first, 2);
+
+	// Records are the arguments with the byte index offset converted to 16-bit indices
+	const render_indirect_command_t expected[3] = {{36, 1, 0, 0, 0}, {12, 4, 36, 24, 1}, {6, 2, 48, 8, 5}};
+	EXPECT_EQ(memcmp(pipeline->indirect.command, expected, sizeof(expected)), 0);
+
+	render_buffer_deallocate(argument_buffer);
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+static void
+test_render_record(render_pipeline_t* pipeline, void* context) {
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.descriptor[0] = (render_buffer_index_t)(uintptr_t)context;
+	for (uint iprim = 0; iprim < 1000; ++iprim) {
+		primitive.argument_offset = iprim;
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+}
+
+DECLARE_TEST(render, null_record_parallel) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 16 * 1000);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	void* context[16];
+	for (uint iitem = 0; iitem < 16; ++iitem)
+		context[iitem] = (void*)(uintptr_t)iitem;
+
+	tick_t start = time_current();
+	render_pipeline_record_parallel(pipeline, test_render_record, context, 16);
+	render_pipeline_flush(pipeline);
+	tick_t elapsed = time_elapsed_ticks(start);
+	EXPECT_SIZEEQ(pipeline->primitive_buffer->used, 16 * 1000);
+	EXPECT_INTEQ(atomic_load32(&pipeline->record_pending, memory_order_acquire), 0);
+
+	// Each work item queues its primitives in order
+	uint next[16] = {0};
+	const render_primitive_t* primitive = pipeline->primitive_buffer->store;
+	for (size_t iprim = 0; iprim < pipeline->primitive_buffer->used; ++iprim, ++primitive) {
+		uint item = primitive->descriptor[0];
+		EXPECT_UINTEQ(primitive->argument_offset, next[item]);
+		++next[item];
+	}
+	log_infof(HASH_TEST, STRING_CONST("Recorded 16 work items in %.3fms"),
+	          (double)time_ticks_to_seconds(elapsed) * 1000.0);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_record_parallel_scheduler) {
+	// Recording runs on tasks when the module is configured with a scheduler
+	task_scheduler_t* scheduler = task_scheduler_allocate(4, 32);
+	EXPECT_NE(scheduler, nullptr);
+	render_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.task_scheduler = scheduler;
+	render_module_finalize();
+	render_module_initialize(config);
+
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 16 * 1000);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	void* context[16];
+	for (uint iitem = 0; iitem < 16; ++iitem)
+		context[iitem] = (void*)(uintptr_t)iitem;
+
+	// Several frames to recycle work item storage and overflow blocks between flushes
+	for (uint iframe = 0; iframe < 4; ++iframe) {
+		render_pipeline_record_parallel(pipeline, test_render_record, context, 8);
+		render_pipeline_record_parallel(pipeline, test_render_record, context + 8, 8);
+		EXPECT_EQ(pipeline->barrier, &pipeline->record_pending);
+		render_pipeline_flush(pipeline);
+		EXPECT_INTEQ(atomic_load32(&pipeline->record_pending, memory_order_acquire), 0);
+		EXPECT_SIZEEQ(pipeline->primitive_buffer->used, 16 * 1000);
+
+		uint next[16] = {0};
+		const render_primitive_t* primitive = pipeline->primitive_buffer->store;
+		for (size_t iprim = 0; iprim < pipeline->primitive_buffer->used; ++iprim, ++primitive) {
+			uint item = primitive->descriptor[0];
+			EXPECT_UINTEQ(primitive->argument_offset, next[item]);
+			++next[item];
+		}
+		for (uint iitem = 0; iitem < 16; ++iitem)
+			EXPECT_UINTEQ(next[iitem], 1000);
+	}
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	memset(&config, 0, sizeof(config));
+	render_module_finalize();
+	render_module_initialize(config);
+	task_scheduler_deallocate(scheduler);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_frames) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+	render_backend_null_set_latency(backend, 10);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 1024);
+	EXPECT_NE(pipeline, nullptr);
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+
+	const uint frame_count[] = {1, 3};
+	tick_t frame_time[2];
+	for (uint iconfig = 0; iconfig < 2; ++iconfig) {
+		render_pipeline_set_frame_count(pipeline, frame_count[iconfig]);
+		pipeline->frame_wait_count = 0;
+
+		tick_t start = time_current();
+		for (uint iframe = 0; iframe < 6; ++iframe) {
+			primitive.argument_offset = iframe;
+			render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+			render_buffer_t* flushed = pipeline->primitive_buffer;
+			render_pipeline_flush(pipeline);
+			// Recording continues in the primitive buffer of the next frame in the ring
+			if (frame_count[iconfig] > 1)
+				EXPECT_NE(pipeline->primitive_buffer, flushed);
+			EXPECT_SIZEEQ(flushed->used, 1);
+			EXPECT_UINTEQ(((render_primitive_t*)flushed->store)->argument_offset, iframe);
+		}
+		frame_time[iconfig] = time_elapsed_ticks(start);
+
+		// Flushes only wait for the device when the ring wraps
+		EXPECT_UINTEQ((uint)pipeline->frame_wait_count, 6 - (frame_count[iconfig] - 1));
+	}
+	log_infof(HASH_TEST, STRING_CONST("Null backend 6 frames, 1 in flight: %.2fms, 3 in flight: %.2fms"),
+	          (double)time_ticks_to_seconds(frame_time[0]) * 1000.0,
+	          (double)time_ticks_to_seconds(frame_time[1]) * 1000.0);
+
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_pool) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_buffer_pool_t* pool = render_buffer_pool_allocate(backend, RENDERUSAGE_RENDER, 1024, 16);
+	uint8_t data[100];
+	for (uint ibyte = 0; ibyte < sizeof(data); ++ibyte)
+		data[ibyte] = (uint8_t)ibyte;
+
+	render_buffer_t* first = render_buffer_pool_buffer_allocate(pool, 100, data, sizeof(data));
+	render_buffer_t* second = render_buffer_pool_buffer_allocate(pool, 200, nullptr, 0);
+	render_buffer_t* third = render_buffer_pool_buffer_allocate(pool, 100, data, sizeof(data));
+	EXPECT_UINTEQ(second->render_index, first->render_index);
+	EXPECT_UINTEQ(third->render_index, first->render_index);
+	EXPECT_UINTEQ(first->offset, 0);
+	EXPECT_UINTEQ(second->offset, 112);
+	EXPECT_UINTEQ(third->offset, 320);
+
+	render_buffer_pool_statistics_t statistics;
+	render_buffer_pool_statistics(pool, &statistics);
+	EXPECT_UINTEQ(statistics.block_count, 1);
+	EXPECT_UINTEQ(statistics.allocation_count, 3);
+	EXPECT_SIZEEQ(statistics.bytes_allocated, 432);
+	EXPECT_SIZEEQ(statistics.bytes_free, 592);
+	EXPECT_REALEQ(statistics.fragmentation, 0);
+
+	render_buffer_deallocate(second);
+	render_buffer_pool_statistics(pool, &statistics);
+	EXPECT_UINTEQ(statistics.free_range_count, 2);
+	EXPECT_REALEQ(statistics.fragmentation, REAL_C(1.0) - (REAL_C(592.0) / REAL_C(800.0)));
+
+	// Compaction packs the third buffer after the first, keeping content
+	EXPECT_SIZEEQ(render_buffer_pool_compact(pool), 100);
+	EXPECT_UINTEQ(third->offset, 112);
+	EXPECT_EQ(memcmp(third->store, data, sizeof(data)), 0);
+	render_buffer_pool_statistics(pool, &statistics);
+	EXPECT_UINTEQ(statistics.free_range_count, 1);
+	EXPECT_REALEQ(statistics.fragmentation, 0);
+
+	// Buffers larger than the block size get a dedicated block
+	render_buffer_t* large = render_buffer_pool_buffer_allocate(pool, 2000, nullptr, 0);
+	EXPECT_NE(large->render_index, first->render_index);
+	render_buffer_pool_statistics(pool, &statistics);
+	EXPECT_UINTEQ(statistics.block_count, 2);
+
+	// Buffers moved to another block change render index, which queued primitives and descriptors do not follow
+	render_buffer_deallocate(large);
+	render_buffer_t* moved = render_buffer_pool_buffer_allocate(pool, 900, data, sizeof(data));
+	render_buffer_index_t first_index = first->render_index;
+	EXPECT_NE(moved->render_index, first_index);
+	render_buffer_deallocate(third);
+	render_buffer_deallocate(first);
+	EXPECT_SIZEEQ(render_buffer_pool_compact(pool), 900);
+	EXPECT_UINTEQ(moved->render_index, first_index);
+	EXPECT_UINTEQ(moved->offset, 0);
+	EXPECT_EQ(memcmp(moved->store, data, sizeof(data)), 0);
+	render_buffer_pool_statistics(pool, &statistics);
+	EXPECT_UINTEQ(statistics.block_count, 1);
+	EXPECT_UINTEQ(statistics.allocation_count, 1);
+	EXPECT_UINTEQ(statistics.free_range_count, 1);
+	EXPECT_SIZEEQ(statistics.bytes_free, 1024 - 912);
+
+	render_buffer_deallocate(moved);
+	render_buffer_pool_deallocate(pool);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_dirty) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 1024, nullptr, 0);
+
+	// Adjacent and overlapping ranges coalesce
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+	render_buffer_dirty(buffer, 16, 16);
+	render_buffer_dirty(buffer, 32, 16);
+	render_buffer_dirty(buffer, 128, 8);
+	render_buffer_dirty(buffer, 40, 8);
+	render_buffer_unlock(buffer);
+	EXPECT_TRUE(buffer->flags & RENDERBUFFER_DIRTY);
+	EXPECT_TRUE(buffer->flags & RENDERBUFFER_DIRTY_RANGE);
+	EXPECT_UINTEQ(buffer->dirty_count, 2);
+	EXPECT_SIZEEQ(buffer->dirty[0].begin, 16);
+	EXPECT_SIZEEQ(buffer->dirty[0].end, 48);
+	EXPECT_SIZEEQ(buffer->dirty[1].begin, 128);
+	EXPECT_SIZEEQ(buffer->dirty[1].end, 136);
+
+	// Partial upload keeps ranges outside the uploaded range dirty
+	render_buffer_upload(buffer, 0, 64);
+	EXPECT_TRUE(buffer->flags & RENDERBUFFER_DIRTY);
+	EXPECT_UINTEQ(buffer->dirty_count, 1);
+	render_buffer_upload(buffer, 0, 0);
+	EXPECT_FALSE(buffer->flags & RENDERBUFFER_DIRTY);
+
+	// Ranges are merged when exceeding the tracked count
+	for (uint irange = 0; irange <= RENDER_BUFFER_DIRTY_RANGE_COUNT; ++irange)
+		render_buffer_dirty(buffer, irange * 64, 8);
+	EXPECT_UINTEQ(buffer->dirty_count, RENDER_BUFFER_DIRTY_RANGE_COUNT);
+	render_buffer_upload(buffer, 0, 0);
+
+	// Write lock without marked ranges dirties the whole buffer
+	render_buffer_dirty(buffer, 16, 16);
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+	render_buffer_unlock(buffer);
+	EXPECT_TRUE(buffer->flags & RENDERBUFFER_DIRTY);
+	EXPECT_FALSE(buffer->flags & RENDERBUFFER_DIRTY_RANGE);
+	render_buffer_upload(buffer, 0, 0);
+	EXPECT_FALSE(buffer->flags & RENDERBUFFER_DIRTY);
+
+	render_buffer_deallocate(buffer);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, index_table) {
+	render_index_table_t table;
+	render_index_table_initialize(&table, 0);
+
+	// Index 0 is reserved, indices grow across segments and are recycled when freed
+	uint count = RENDER_INDEX_TABLE_SEGMENT_SIZE * 2;
+	for (uint iobj = 1; iobj <= count; ++iobj)
+		EXPECT_UINTEQ(render_index_table_allocate(&table, (void*)(uintptr_t)iobj), iobj);
+	EXPECT_EQ(render_index_table_lookup(&table, 0), nullptr);
+	EXPECT_EQ(render_index_table_lookup(&table, count), (void*)(uintptr_t)count);
+	EXPECT_UINTEQ(render_index_table_count(&table), count + 1);
+
+	render_index_table_free(&table, 42);
+	EXPECT_EQ(render_index_table_lookup(&table, 42), nullptr);
+	EXPECT_UINTEQ(render_index_table_allocate(&table, &table), 42);
+	EXPECT_EQ(render_index_table_lookup(&table, 42), &table);
+	EXPECT_UINTEQ(render_index_table_count(&table), count + 1);
+	render_index_table_finalize(&table);
+
+	// Allocation fails gracefully at capacity
+	render_index_table_initialize(&table, 3);
+	EXPECT_UINTEQ(render_index_table_allocate(&table, &table), 1);
+	EXPECT_UINTEQ(render_index_table_allocate(&table, &table), 2);
+	EXPECT_UINTEQ(render_index_table_allocate(&table, &table), 0);
+	render_index_table_finalize(&table);
+
+	return 0;
+}
+
+DECLARE_TEST(render, slab) {
+	render_slab_t slab;
+	render_slab_initialize(&slab, 40);
+
+	// Objects are laid out contiguously, handles grow across slabs
+	render_handle_t handle[RENDER_SLAB_OBJECT_COUNT + 2];
+	void* object[RENDER_SLAB_OBJECT_COUNT + 2];
+	for (uint iobj = 0; iobj < RENDER_SLAB_OBJECT_COUNT + 2; ++iobj) {
+		object[iobj] = render_slab_allocate(&slab, handle + iobj);
+		EXPECT_NE(object[iobj], nullptr);
+		EXPECT_NE(handle[iobj], 0);
+	}
+	EXPECT_EQ(object[1], pointer_offset(object[0], 48));
+	EXPECT_EQ(render_slab_lookup(&slab, handle[RENDER_SLAB_OBJECT_COUNT + 1]), object[RENDER_SLAB_OBJECT_COUNT + 1]);
+	EXPECT_EQ(render_slab_lookup(&slab, 0), nullptr);
+	EXPECT_UINTEQ(render_slab_count(&slab), RENDER_SLAB_OBJECT_COUNT + 2);
+
+	// Released slots are reused with a new generation, stale handles no longer resolve
+	EXPECT_TRUE(render_slab_free(&slab, handle[1]));
+	EXPECT_FALSE(render_slab_free(&slab, handle[1]));
+	EXPECT_EQ(render_slab_lookup(&slab, handle[1]), nullptr);
+	render_handle_t reused;
+	EXPECT_EQ(render_slab_allocate(&slab, &reused), object[1]);
+	EXPECT_NE(reused, handle[1]);
+	EXPECT_EQ(render_slab_lookup(&slab, handle[1]), nullptr);
+	EXPECT_EQ(render_slab_lookup(&slab, reused), object[1]);
+
+	EXPECT_TRUE(render_slab_free(&slab, handle[0]));
+	uint slot = 0;
+	uint live = 0;
+	EXPECT_EQ(render_slab_next(&slab, &slot), object[1]);
+	while (render_slab_next(&slab, &slot))
+		++live;
+	EXPECT_UINTEQ(live, RENDER_SLAB_OBJECT_COUNT);
+	render_slab_finalize(&slab);
+
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 64, nullptr, 0);
+	render_handle_t buffer_handle = buffer->handle;
+	EXPECT_EQ(render_buffer_lookup_handle(backend, buffer_handle), buffer);
+	render_buffer_deallocate(buffer);
+	EXPECT_EQ(render_buffer_lookup_handle(backend, buffer_handle), nullptr);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_ring_buffer) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 2);
+
+	render_ring_buffer_t* ring = render_ring_buffer_allocate(pipeline, 1024, 0);
+	EXPECT_NE(ring, nullptr);
+	EXPECT_SIZEEQ(render_ring_buffer_region_size(ring), 512);
+
+	render_ring_allocation_t allocation = render_ring_buffer_reserve(ring, 100);
+	EXPECT_EQ(allocation.pointer, ring->buffer->store);
+	EXPECT_UINTEQ(allocation.render_index, ring->buffer->render_index);
+	EXPECT_UINTEQ(allocation.offset, 0);
+	allocation = render_ring_buffer_reserve(ring, 100);
+	EXPECT_UINTEQ(allocation.offset, 112);
+	allocation = render_ring_buffer_reserve(ring, 400);
+	EXPECT_EQ(allocation.pointer, nullptr);
+	EXPECT_UINTEQ((uint)render_ring_buffer_dropped(ring), 1);
+
+	// Next frame allocates from the second region, the first is reclaimed when its frame retires
+	render_pipeline_flush(pipeline);
+	EXPECT_SIZEEQ(render_ring_buffer_high_water(ring), 224);
+	EXPECT_EQ(ring->buffer->flags & RENDERBUFFER_DIRTY, 0);
+	allocation = render_ring_buffer_reserve(ring, 400);
+	EXPECT_UINTEQ(allocation.offset, 512);
+	render_pipeline_flush(pipeline);
+	allocation = render_ring_buffer_reserve(ring, 8);
+	EXPECT_UINTEQ(allocation.offset, 0);
+
+	render_pipeline_set_frame_count(pipeline, 4);
+	EXPECT_SIZEEQ(render_ring_buffer_region_size(ring), 256);
+	EXPECT_UINTEQ(render_ring_buffer_reserve(ring, 8).offset, 0);
+
+	// Ring buffers still attached are released with the pipeline
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_residency) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	render_buffer_t* idle = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 4096, nullptr, 0);
+	render_buffer_t* used = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 4096, nullptr, 0);
+	for (uint ibyte = 0; ibyte < 4096; ++ibyte)
+		((uint8_t*)idle->store)[ibyte] = (uint8_t)(ibyte / 64);
+	render_buffer_residency_track(idle, nullptr, nullptr);
+	render_buffer_residency_track(used, nullptr, nullptr);
+	render_buffer_residency_budget(backend, 6000, 2);
+
+	// Buffer untouched for the configured frames is evicted into a snapshot at flush
+	for (uint iframe = 0; iframe < 3; ++iframe) {
+		render_buffer_lock(used, RENDERBUFFER_LOCK_READ);
+		render_buffer_unlock(used);
+		render_pipeline_flush(pipeline);
+	}
+	EXPECT_TRUE(idle->flags & RENDERBUFFER_LOST);
+	EXPECT_EQ(idle->store, nullptr);
+	EXPECT_FALSE(used->flags & RENDERBUFFER_LOST);
+
+	render_buffer_residency_statistics_t statistics;
+	render_buffer_residency_statistics(backend, &statistics);
+	EXPECT_UINTEQ(statistics.tracked_count, 2);
+	EXPECT_UINTEQ(statistics.evicted_count, 1);
+	EXPECT_SIZEEQ(statistics.bytes_resident, 4096);
+	EXPECT_SIZEEQ(statistics.bytes_snapshot, idle->snapshot_size);
+	EXPECT_TRUE(statistics.bytes_snapshot < 4096);
+
+	// Next lock restores the content transparently
+	render_buffer_lock(idle, RENDERBUFFER_LOCK_READ);
+	EXPECT_FALSE(idle->flags & RENDERBUFFER_LOST);
+	EXPECT_UINTEQ(((uint8_t*)idle->access)[4095], 63);
+	render_buffer_unlock(idle);
+
+	render_buffer_free(used, true, false);
+	EXPECT_TRUE(used->flags & RENDERBUFFER_LOST);
+	render_buffer_restore(used);
+	EXPECT_NE(used->store, nullptr);
+
+	render_buffer_residency_statistics(backend, &statistics);
+	EXPECT_UINTEQ(statistics.evicted_count, 0);
+	EXPECT_SIZEEQ(statistics.bytes_resident, 8192);
+	EXPECT_UINTEQ((uint)statistics.restores, 2);
+
+	render_buffer_deallocate(idle);
+	render_buffer_deallocate(used);
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_upload_queue) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_buffer_t* first = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 1024, nullptr, 0);
+	render_buffer_t* second = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 1024, nullptr, 0);
+
+	// Repeated unlocks before the drain queue the buffer once, with coalesced dirty ranges
+	render_buffer_lock(first, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_dirty(first, 0, 64);
+	render_buffer_unlock(first);
+	render_buffer_lock(first, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_dirty(first, 64, 64);
+	render_buffer_unlock(first);
+	render_buffer_lock(second, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_unlock(second);
+	EXPECT_TRUE(first->flags & RENDERBUFFER_DIRTY);
+	EXPECT_UINTEQ(first->dirty_count, 1);
+	EXPECT_SIZEEQ(first->dirty[0].end, 128);
+
+	uint64_t fence = render_buffer_upload_fence(backend);
+	EXPECT_FALSE(render_buffer_upload_fence_reached(backend, fence));
+	EXPECT_TRUE(render_buffer_upload_flush(backend) >= fence);
+	EXPECT_TRUE(render_buffer_upload_fence_reached(backend, fence));
+	EXPECT_UINTEQ(backend->upload.batch_count, 2);
+	EXPECT_FALSE(first->flags & RENDERBUFFER_DIRTY);
+	EXPECT_FALSE(second->flags & RENDERBUFFER_DIRTY);
+
+	// Deallocating a queued buffer drains the queue first
+	render_buffer_lock(second, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_unlock(second);
+	fence = render_buffer_upload_fence(backend);
+	render_buffer_deallocate(second);
+	EXPECT_TRUE(render_buffer_upload_fence_reached(backend, fence));
+
+	render_buffer_deallocate(first);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_layout) {
+	// Matrix, vec4 and array of three pointers
+	render_buffer_data_t data[3] = {{.index = 0, .data_type = RENDERDATA_MATRIX4X4, .array_count = 0},
+	                                {.index = 1, .data_type = RENDERDATA_FLOAT4, .array_count = 0},
+	                                {.index = 2, .data_type = RENDERDATA_POINTER, .array_count = 3}};
+	render_buffer_layout_t* layout = render_buffer_layout_allocate(data, 3, RENDERLAYOUT_STD140);
+	EXPECT_NE(layout, nullptr);
+	EXPECT_UINTEQ(render_buffer_layout_field(layout, 1)->offset, 64);
+	EXPECT_UINTEQ(render_buffer_layout_field(layout, 2)->offset, 80);
+	EXPECT_UINTEQ(render_buffer_layout_field(layout, 2)->array_stride, 16);
+	EXPECT_UINTEQ(layout->stride, 128);
+	render_buffer_layout_deallocate(layout);
+
+	// Pointer arrays are tightly packed in std430, instance stride still rounded to the vec4 alignment
+	layout = render_buffer_layout_allocate(data, 3, RENDERLAYOUT_STD430);
+	EXPECT_UINTEQ(render_buffer_layout_field(layout, 2)->array_stride, 8);
+	EXPECT_UINTEQ(layout->stride, 112);
+	EXPECT_EQ(render_buffer_layout_field(layout, 3), nullptr);
+	render_buffer_layout_deallocate(layout);
+
+	layout = render_buffer_layout_allocate(data + 2, 1, RENDERLAYOUT_STD430);
+	EXPECT_UINTEQ(layout->stride, 24);
+	EXPECT_UINTEQ(layout->alignment, 8);
+	render_buffer_layout_deallocate(layout);
+
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 0, nullptr, 0);
+	render_buffer_data_declare(buffer, 4, data, 2);
+	EXPECT_NE(buffer->layout, nullptr);
+	EXPECT_UINTEQ(buffer->layout->stride, 80);
+	EXPECT_SIZEEQ(buffer->allocated, 320);
+
+	float32_t value[4][16];
+	for (uint imat = 0; imat < 4; ++imat) {
+		for (uint ival = 0; ival < 16; ++ival)
+			value[imat][ival] = (float32_t)((imat * 16) + ival);
+	}
+	matrix_t matrix[4];
+	memcpy(matrix, value, sizeof(matrix));
+	vector_t color = vector(1, 2, 3, 4);
+
+	// Encoding marks only the encoded spans dirty
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_data_encode_matrix_array(buffer, 1, 3, 0, matrix + 1);
+	render_buffer_data_encode_constant(buffer, 2, 1, &color, sizeof(color));
+	EXPECT_UINTEQ(buffer->dirty_count, 1);
+	EXPECT_SIZEEQ(buffer->dirty[0].begin, 80);
+	EXPECT_SIZEEQ(buffer->dirty[0].end, 304);
+	render_buffer_unlock(buffer);
+
+	// Matrices are stored column major
+	const float32_t* store = buffer->store;
+	EXPECT_REALEQ(store[0], 0);
+	for (uint imat = 1; imat < 4; ++imat) {
+		for (uint icol = 0; icol < 4; ++icol) {
+			for (uint irow = 0; irow < 4; ++irow)
+				EXPECT_REALEQ(store[(imat * 20) + (icol * 4) + irow], value[imat][(irow * 4) + icol]);
+		}
+	}
+	EXPECT_REALEQ(store[(2 * 20) + 16], 1);
+	EXPECT_REALEQ(store[(2 * 20) + 19], 4);
+	EXPECT_REALEQ(store[(3 * 20) + 16], 0);
+
+	// Constants larger than the field are truncated per instance, each read at the full source size
+	float32_t wide[3][8];
+	for (uint iconst = 0; iconst < 3; ++iconst) {
+		for (uint ival = 0; ival < 8; ++ival)
+			wide[iconst][ival] = (float32_t)((iconst * 8) + ival);
+	}
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_data_encode_constant_array(buffer, 1, 3, 1, wide, sizeof(wide[0]));
+	render_buffer_unlock(buffer);
+	for (uint iconst = 0; iconst < 3; ++iconst) {
+		for (uint ival = 0; ival < 4; ++ival)
+			EXPECT_REALEQ(store[((iconst + 1) * 20) + 16 + ival], wide[iconst][ival]);
+	}
+	EXPECT_REALEQ(store[16], 0);
+
+	render_buffer_deallocate(buffer);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_data_array) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_buffer_data_t data[2] = {{.index = 0, .data_type = RENDERDATA_MATRIX4X4, .array_count = 0},
+	                                {.index = 1, .data_type = RENDERDATA_FLOAT4, .array_count = 0}};
+	const uint instance_count = (RENDER_BUFFER_DATA_STREAM_THRESHOLD * 2) + 67;
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 0, nullptr, 0);
+	render_buffer_data_declare(buffer, instance_count, data, 2);
+	EXPECT_UINTEQ(buffer->layout->stride, 80);
+
+	matrix_t* matrix = memory_allocate(HASH_TEST, sizeof(matrix_t) * instance_count, 16, MEMORY_PERSISTENT);
+	vector_t* color = memory_allocate(HASH_TEST, sizeof(vector_t) * instance_count, 16, MEMORY_PERSISTENT);
+	float32_t* value = (float32_t*)matrix;
+	for (uint ival = 0; ival < instance_count * 16; ++ival)
+		value[ival] = (float32_t)ival;
+	for (uint iinst = 0; iinst < instance_count; ++iinst)
+		color[iinst] = vector((float32_t)iinst, 1, 2, 3);
+
+	// Counts below, at and above the streaming threshold, covering all instances
+	const uint count[3] = {3, RENDER_BUFFER_DATA_STREAM_THRESHOLD, RENDER_BUFFER_DATA_STREAM_THRESHOLD + 64};
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE_ALL);
+	for (uint irange = 0, first = 0; irange < 3; first += count[irange++]) {
+		render_buffer_data_encode_matrix_array(buffer, first, count[irange], 0, matrix + first);
+		render_buffer_data_encode_constant_array(buffer, first, count[irange], 1, color + first, sizeof(vector_t));
+	}
+	render_buffer_unlock(buffer);
+
+	const float32_t* store = buffer->store;
+	for (uint iinst = 0; iinst < instance_count; ++iinst) {
+		const float32_t* instance = store + (iinst * 20);
+		const float32_t* source = value + (iinst * 16);
+		for (uint icol = 0; icol < 4; ++icol) {
+			for (uint irow = 0; irow < 4; ++irow)
+				EXPECT_REALEQ(instance[(icol * 4) + irow], source[(irow * 4) + icol]);
+		}
+		EXPECT_REALEQ(instance[16], (float32_t)iinst);
+		EXPECT_REALEQ(instance[19], 3);
+	}
+
+	memory_deallocate(color);
+	memory_deallocate(matrix);
+	render_buffer_deallocate(buffer);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+static void*
+test_render_buffer_lock_thread(void* arg) {
+	render_buffer_t* buffer = arg;
+	for (uint iloop = 0; iloop < 10000; ++iloop) {
+		if (iloop % 4) {
+			render_buffer_lock(buffer, RENDERBUFFER_LOCK_READ);
+			const uint32_t* value = buffer->access;
+			// Writer is excluded while read lock is held
+			bool consistent = (value[0] == value[1]);
+			render_buffer_unlock(buffer);
+			if (!consistent)
+				return FAILED_TEST;
+		} else {
+			render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+			uint32_t* value = buffer->access;
+			++value[0];
+			thread_yield();
+			++value[1];
+			render_buffer_unlock(buffer);
+		}
+	}
+	return 0;
+}
+
+DECLARE_TEST(render, null_buffer_lock) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	uint32_t data[2] = {0, 0};
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_CPUONLY, sizeof(data), data, sizeof(data));
+
+	// Nested locks in the writing thread, upload queued on final unlock of a write all lock
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE_ALL);
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_READ);
+	render_buffer_unlock(buffer);
+	EXPECT_NE(buffer->access, nullptr);
+	EXPECT_EQ(buffer->flags & RENDERBUFFER_DIRTY, 0);
+	render_buffer_unlock(buffer);
+	EXPECT_EQ(buffer->access, nullptr);
+	EXPECT_EQ(buffer->flags & RENDERBUFFER_LOCK_BITS, 0);
+	render_buffer_upload_flush(backend);
+	EXPECT_EQ(buffer->flags & RENDERBUFFER_DIRTY, 0);
+
+	render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+	render_buffer_unlock(buffer);
+	EXPECT_EQ(buffer->flags & RENDERBUFFER_DIRTY, RENDERBUFFER_DIRTY);
+
+	thread_t thread[8];
+	uint thread_count = (uint)system_hardware_threads();
+	if (thread_count > 8)
+		thread_count = 8;
+	if (thread_count < 2)
+		thread_count = 2;
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_initialize(&thread[ithread], test_render_buffer_lock_thread, buffer, STRING_CONST("buffer_lock"),
+		                  THREAD_PRIORITY_NORMAL, 0);
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_start(&thread[ithread]);
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_join(&thread[ithread]);
+	for (uint ithread = 0; ithread < thread_count; ++ithread) {
+		EXPECT_EQ(thread[ithread].result, 0);
+		thread_finalize(&thread[ithread]);
+	}
+
+	const uint32_t* value = buffer->store;
+	EXPECT_UINTEQ(value[0], thread_count * 2500);
+	EXPECT_UINTEQ(value[1], thread_count * 2500);
+	EXPECT_EQ(atomic_load32(&buffer->lock_state, memory_order_acquire), 0);
+
+	render_buffer_deallocate(buffer);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+static void
+test_render_software_vertex(const void* const* descriptor, uint vertex, uint instance, float* position,
+                            float* varying) {
+	FOUNDATION_UNUSED(instance);
+	const float* source = (const float*)descriptor[0] + (vertex * 6);
+	position[0] = source[0];
+	position[1] = source[1];
+	position[2] = source[2];
+	position[3] = 1.0f;
+	varying[0] = source[3];
+	varying[1] = source[4];
+	varying[2] = source[5];
+}
+
+static uint32_t
+test_render_software_fragment(const void* const* descriptor, const float* varying) {
+	FOUNDATION_UNUSED(descriptor);
+	return (uint32_t)(varying[0] * 255.0f + 0.5f) | ((uint32_t)(varying[1] * 255.0f + 0.5f) << 8) |
+	       ((uint32_t)(varying[2] * 255.0f + 0.5f) << 16) | 0xFF000000U;
+}
+
+typedef struct test_render_readback_t {
+	const void* pixels;
+	size_t stride;
+	union {
+		uint32_t color;
+		float depth;
+	} first;
+	uint count;
+} test_render_readback_t;
+
+static void
+test_render_read_pixels(render_target_t* target, const render_rect_t* rect, const void* pixels, size_t stride,
+                        void* context) {
+	FOUNDATION_UNUSED(target, rect);
+	test_render_readback_t* readback = context;
+	readback->pixels = pixels;
+	readback->stride = stride;
+	memcpy(&readback->first, pixels, sizeof(readback->first));
+	++readback->count;
+}
+
+DECLARE_TEST(render, null_read_pixels) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_target_t* target = render_target_texture_allocate(backend, 16, 8, PIXELFORMAT_R8G8B8A8);
+	EXPECT_NE(target->pixels, nullptr);
+	EXPECT_UINTEQ(target->stride, 16 * 4);
+	((uint32_t*)target->pixels)[(3 * 16) + 5] = 0x11223344U;
+
+	uint32_t pixel[4] = {0};
+	test_render_readback_t readback = {0};
+	render_rect_t rect = {4, 3, 2, 2};
+	EXPECT_TRUE(render_target_read_pixels(target, &rect, pixel, test_render_read_pixels, &readback));
+	EXPECT_UINTEQ(pixel[1], 0x11223344U);
+	EXPECT_SIZEEQ(readback.stride, 2 * 4);
+
+	rect.x = 15;
+	EXPECT_FALSE(render_target_read_pixels(target, &rect, nullptr, test_render_read_pixels, &readback));
+	EXPECT_UINTEQ(readback.count, 1);
+
+	render_target_deallocate(target);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_resource_statistics) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+	render_pipeline_flush(pipeline);
+
+	render_backend_statistics_t base;
+	render_backend_statistics(backend, &base);
+	EXPECT_UINTEQ((uint)base.type[RENDERRESOURCE_BUFFER].count, 1);
+	EXPECT_UINTEQ((uint)base.usage[RENDERUSAGEINDEX_RENDER].count, 1);
+
+	render_buffer_t* buffer[2];
+	buffer[0] = render_buffer_allocate(backend, RENDERUSAGE_CPUONLY, 1000, nullptr, 0);
+	buffer[1] = render_buffer_allocate(backend, RENDERUSAGE_RENDER | RENDERUSAGE_CPUONLY, 24, nullptr, 0);
+	render_target_t* target = render_target_texture_allocate(backend, 16, 16, PIXELFORMAT_R8G8B8A8);
+
+	render_backend_statistics_t statistics;
+	render_backend_statistics(backend, &statistics);
+	EXPECT_UINTEQ((uint)statistics.total.count, (uint)base.total.count + 3);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_CPUONLY].count, 2);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_CPUONLY].bytes, 1024);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_RENDER].count, 2);
+	EXPECT_UINTEQ((uint)statistics.type[RENDERRESOURCE_TARGET].bytes, 16 * 16 * 4);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_TARGET].count, 1);
+
+	render_buffer_deallocate(buffer[0]);
+	render_target_deallocate(target);
+	render_pipeline_flush(pipeline);
+
+	// High-water marks persist, allocations of the flushed frame are reported as the frame rate
+	render_backend_statistics(backend, &statistics);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_CPUONLY].count, 1);
+	EXPECT_UINTEQ((uint)statistics.usage[RENDERUSAGEINDEX_CPUONLY].bytes_high_water, 1024);
+	EXPECT_UINTEQ((uint)statistics.type[RENDERRESOURCE_TARGET].count, 0);
+	EXPECT_UINTEQ((uint)statistics.type[RENDERRESOURCE_TARGET].count_high_water, 1);
+	EXPECT_UINTEQ((uint)statistics.frame_count, (uint)base.frame_count + 1);
+	EXPECT_UINTEQ((uint)statistics.frame_allocations, 3);
+	EXPECT_UINTEQ((uint)statistics.frame_bytes, 1024 + (16 * 16 * 4));
+
+	// Several pipelines flushing in one backend frame advance it once
+	render_pipeline_t* second = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	render_pipeline_set_frame_count(second, 1);
+	uint64_t frame = render_backend_frame_count(backend);
+	for (uint iframe = 0; iframe < 3; ++iframe) {
+		render_pipeline_flush(pipeline);
+		render_pipeline_flush(second);
+	}
+	EXPECT_UINTEQ((uint)(render_backend_frame_count(backend) - frame), 3);
+	render_backend_statistics(backend, &statistics);
+	EXPECT_UINTEQ((uint)statistics.frame_count, (uint)base.frame_count + 4);
+	render_pipeline_deallocate(second);
+
+	render_buffer_deallocate(buffer[1]);
+	render_pipeline_deallocate(pipeline);
+
+	render_backend_statistics(backend, &statistics);
+	EXPECT_UINTEQ((uint)statistics.total.count, 0);
+	EXPECT_UINTEQ((uint)statistics.total.bytes, 0);
+
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, null_trace) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_NULL, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+
+	render_primitive_t primitive[4];
+	memset(primitive, 0, sizeof(primitive));
+
+	render_trace_clear();
+	render_trace_enable(true);
+	EXPECT_TRUE(render_trace_is_enabled());
+	render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitive, 4);
+	render_pipeline_flush(pipeline);
+	render_trace_enable(false);
+	render_pipeline_flush(pipeline);
+
+	char buffer[4096];
+	stream_t* stream = buffer_stream_allocate(buffer, STREAM_OUT, 0, sizeof(buffer), false, false);
+	EXPECT_SIZEEQ(render_trace_dump(stream), 4);
+	size_t size = (size_t)stream_tell(stream);
+	stream_deallocate(stream);
+
+	EXPECT_TRUE(string_find_string(buffer, size, STRING_CONST("{\"traceEvents\":["), 0) != STRING_NPOS);
+	EXPECT_TRUE(string_find_string(buffer, size, STRING_CONST("{\"name\":\"render_pipeline_flush\",\"cat\":\"render\""),
+	                               0) != STRING_NPOS);
+
+	render_trace_clear();
+	render_pipeline_deallocate(pipeline);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, software) {
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_SOFTWARE, false);
+	EXPECT_NE(backend, nullptr);
+
+	render_target_t* color = render_target_texture_allocate(backend, 128, 128, PIXELFORMAT_R8G8B8A8);
+	render_target_t* depth = render_target_texture_allocate(backend, 128, 128, PIXELFORMAT_DEPTH32F);
+	EXPECT_NE(color->pixels, nullptr);
+
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, 64);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_color_attachment(pipeline, 0, color);
+	render_pipeline_set_depth_attachment(pipeline, depth);
+	render_pipeline_set_color_clear(pipeline, 0, RENDERCLEAR_CLEAR, vector(0, 0, 1, 1));
+	render_pipeline_set_depth_clear(pipeline, RENDERCLEAR_CLEAR, vector(1, 0, 0, 0));
+	render_pipeline_build(pipeline);
+
+	const render_software_shader_t program = {test_render_software_vertex, test_render_software_fragment, 3};
+	render_shader_t* shader = render_shader_allocate();
+	render_backend_software_shader_set(backend, shader, &program);
+	render_pipeline_state_t state = render_pipeline_state_allocate(backend, pipeline, shader);
+	EXPECT_NE(state, 0);
+
+	// Red triangle in the lower left half in front of a green triangle in the lower right half drawn after it
+	const float vertex[6 * 6] = {-1, -1, 0.25f, 1, 0, 0, 1, -1, 0.25f, 1, 0, 0, -1, 1, 0.25f, 1, 0, 0,
+	                             -1, -1, 0.5f,  0, 1, 0, 1, -1, 0.5f,  0, 1, 0, 1,  1, 0.5f,  0, 1, 0};
+	const uint16_t index[6] = {0, 1, 2, 3, 4, 5};
+	const render_argument_t argument[2] = {{3, 1, 0, 0, 0}, {3, 1, 3 * sizeof(uint16_t), 0, 0}};
+	render_buffer_t* vertex_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(vertex), vertex, sizeof(vertex));
+	render_buffer_t* index_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(index), index, sizeof(index));
+	render_buffer_t* argument_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, sizeof(argument), argument, sizeof(argument));
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.pipeline_state = state;
+	primitive.argument_buffer = argument_buffer->render_index;
+	primitive.index_buffer = index_buffer->render_index;
+	primitive.descriptor[0] = vertex_buffer->render_index;
+	for (uint iprim = 0; iprim < 2; ++iprim) {
+		primitive.argument_offset = iprim * sizeof(render_argument_t);
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	render_pipeline_flush(pipeline);
+
+	uint32_t* pixel = memory_allocate(HASH_TEST, 128 * 128 * sizeof(uint32_t), 0, MEMORY_PERSISTENT);
+	test_render_readback_t readback = {0};
+	EXPECT_TRUE(render_target_read_pixels(color, nullptr, pixel, test_render_read_pixels, &readback));
+	EXPECT_EQ(readback.pixels, pixel);
+	EXPECT_SIZEEQ(readback.stride, 128 * sizeof(uint32_t));
+	EXPECT_UINTEQ(pixel[(120 * 128) + 40], 0xFF0000FFU);
+	EXPECT_UINTEQ(pixel[(40 * 128) + 120], 0xFF00FF00U);
+	EXPECT_UINTEQ(pixel[(8 * 128) + 8], 0xFFFF0000U);
+	memory_deallocate(pixel);
+
+	// Zero-copy read maps the target storage directly
+	render_rect_t rect = {40, 120, 8, 8};
+	EXPECT_TRUE(render_target_read_pixels(depth, &rect, nullptr, test_render_read_pixels, &readback));
+	EXPECT_SIZEEQ(readback.stride, 128 * sizeof(float));
+	EXPECT_REALEQ(readback.first.depth, 0.25f);
+	rect.x = 8;
+	rect.y = 8;
+	EXPECT_TRUE(render_target_read_pixels(depth, &rect, nullptr, test_render_read_pixels, &readback));
+	EXPECT_REALEQ(readback.first.depth, 1.0f);
+	EXPECT_UINTEQ(readback.count, 3);
+
+	render_buffer_deallocate(argument_buffer);
+	render_buffer_deallocate(index_buffer);
+	render_buffer_deallocate(vertex_buffer);
+	render_pipeline_state_deallocate(backend, state);
+	render_shader_deallocate(shader);
+	render_pipeline_deallocate(pipeline);
+	render_target_deallocate(depth);
+	render_target_deallocate(color);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+//! Render overlapping triangles from many draws with the software backend and read back the color target
+static int
+test_render_software_scene(uint32_t* pixel) {
+	const uint draw_count = 48;
+	const uint draw_triangles = 64;
+	const uint vertex_count = draw_count * draw_triangles * 3;
+
+	render_backend_t* backend = render_backend_allocate(RENDERAPI_SOFTWARE, false);
+	EXPECT_NE(backend, nullptr);
+	render_target_t* color = render_target_texture_allocate(backend, 300, 200, PIXELFORMAT_R8G8B8A8);
+	render_target_t* depth = render_target_texture_allocate(backend, 300, 200, PIXELFORMAT_DEPTH32F);
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, draw_count);
+	EXPECT_NE(pipeline, nullptr);
+	render_pipeline_set_frame_count(pipeline, 1);
+	render_pipeline_set_color_attachment(pipeline, 0, color);
+	render_pipeline_set_depth_attachment(pipeline, depth);
+	render_pipeline_set_color_clear(pipeline, 0, RENDERCLEAR_CLEAR, vector(0, 0, 0, 1));
+	render_pipeline_set_depth_clear(pipeline, RENDERCLEAR_CLEAR, vector(1, 0, 0, 0));
+	render_pipeline_build(pipeline);
+
+	const render_software_shader_t program = {test_render_software_vertex, test_render_software_fragment, 3};
+	render_shader_t* shader = render_shader_allocate();
+	render_backend_software_shader_set(backend, shader, &program);
+	render_pipeline_state_t state = render_pipeline_state_allocate(backend, pipeline, shader);
+
+	// Pseudo random triangles, identical in every call
+	float* vertex = memory_allocate(HASH_TEST, sizeof(float) * 6 * vertex_count, 0, MEMORY_PERSISTENT);
+	uint16_t* index = memory_allocate(HASH_TEST, sizeof(uint16_t) * vertex_count, 0, MEMORY_PERSISTENT);
+	render_argument_t* argument = memory_allocate(HASH_TEST, sizeof(render_argument_t) * draw_count, 0,
+	                                              MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	uint32_t seed = 1;
+	for (uint ivert = 0; ivert < vertex_count; ++ivert) {
+		for (uint ival = 0; ival < 6; ++ival) {
+			seed = (seed * 1664525U) + 1013904223U;
+			float value = (float)(seed >> 8) / (float)(1 << 24);
+			vertex[(ivert * 6) + ival] = (ival < 2) ? ((value * 2.0f) - 1.0f) : value;
+		}
+		index[ivert] = (uint16_t)ivert;
+	}
+	for (uint idraw = 0; idraw < draw_count; ++idraw) {
+		argument[idraw].index_count = draw_triangles * 3;
+		argument[idraw].instance_count = 1;
+		argument[idraw].index_offset = idraw * draw_triangles * 3 * sizeof(uint16_t);
+	}
+	const size_t vertex_size = sizeof(float) * 6 * vertex_count;
+	const size_t index_size = sizeof(uint16_t) * vertex_count;
+	const size_t argument_size = sizeof(render_argument_t) * draw_count;
+	render_buffer_t* vertex_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, vertex_size, vertex, vertex_size);
+	render_buffer_t* index_buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, index_size, index, index_size);
+	render_buffer_t* argument_buffer =
+	    render_buffer_allocate(backend, RENDERUSAGE_RENDER, argument_size, argument, argument_size);
+
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.pipeline_state = state;
+	primitive.argument_buffer = argument_buffer->render_index;
+	primitive.index_buffer = index_buffer->render_index;
+	primitive.descriptor[0] = vertex_buffer->render_index;
+	for (uint idraw = 0; idraw < draw_count; ++idraw) {
+		primitive.argument_offset = idraw * sizeof(render_argument_t);
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	render_pipeline_flush(pipeline);
+
+	test_render_readback_t readback = {0};
+	EXPECT_TRUE(render_target_read_pixels(color, nullptr, pixel, test_render_read_pixels, &readback));
+
+	memory_deallocate(argument);
+	memory_deallocate(index);
+	memory_deallocate(vertex);
+	render_buffer_deallocate(argument_buffer);
+	render_buffer_deallocate(index_buffer);
+	render_buffer_deallocate(vertex_buffer);
+	render_pipeline_state_deallocate(backend, state);
+	render_shader_deallocate(shader);
+	render_pipeline_deallocate(pipeline);
+	render_target_deallocate(depth);
+	render_target_deallocate(color);
+	render_backend_deallocate(backend);
+
+	return 0;
+}
+
+DECLARE_TEST(render, software_scheduler) {
+	const size_t pixel_count = 300 * 200;
+	uint32_t* serial = memory_allocate(HASH_TEST, sizeof(uint32_t) * pixel_count, 0, MEMORY_PERSISTENT);
+	uint32_t* parallel = memory_allocate(HASH_TEST, sizeof(uint32_t) * pixel_count, 0, MEMORY_PERSISTENT);
+	EXPECT_INTEQ(test_render_software_scene(serial), 0);
+
+	// Setup, binning and rasterization on tasks give the same image as the serial flush
+	task_scheduler_t* scheduler = task_scheduler_allocate(4, 32);
+	EXPECT_NE(scheduler, nullptr);
+	render_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.task_scheduler = scheduler;
+	render_module_finalize();
+	render_module_initialize(config);
+
+	EXPECT_INTEQ(test_render_software_scene(parallel), 0);
+	EXPECT_EQ(memcmp(serial, parallel, sizeof(uint32_t) * pixel_count), 0);
+	size_t covered = 0;
+	for (size_t ipix = 0; ipix < pixel_count; ++ipix)
+		covered += (serial[ipix] != 0xFF000000U) ? 1 : 0;
+	EXPECT_TRUE(covered > (pixel_count / 2));
+
+	memset(&config, 0, sizeof(config));
+	render_module_finalize();
+	render_module_initialize(config);
+	task_scheduler_deallocate(scheduler);
+
+	memory_deallocate(parallel);
+	memory_deallocate(serial);
+
+	return 0;
+}
+
 DECLARE_TEST(render, null) {
 	return test_render_api(RENDERAPI_NULL);
 }
@@ -462,6 +1906,32 @@ DECLARE_TEST(render, metal_box) {
 static void
 test_render_declare(void) {
 	ADD_TEST(render, initialize);
+	ADD_TEST(render, null_queue);
+	ADD_TEST(render, null_queue_batch);
+	ADD_TEST(render, null_queue_overflow);
+	ADD_TEST(render, null_queue_sort);
+	ADD_TEST(render, null_frames);
+	ADD_TEST(render, null_command);
+	ADD_TEST(render, null_merge_instances);
+	ADD_TEST(render, null_statistics);
+	ADD_TEST(render, null_indirect);
+	ADD_TEST(render, null_record_parallel);
+	ADD_TEST(render, null_record_parallel_scheduler);
+	ADD_TEST(render, null_buffer_lock);
+	ADD_TEST(render, null_buffer_upload_queue);
+	ADD_TEST(render, null_buffer_layout);
+	ADD_TEST(render, null_buffer_data_array);
+	ADD_TEST(render, null_buffer_dirty);
+	ADD_TEST(render, null_ring_buffer);
+	ADD_TEST(render, null_buffer_residency);
+	ADD_TEST(render, null_buffer_pool);
+	ADD_TEST(render, index_table);
+	ADD_TEST(render, slab);
+	ADD_TEST(render, null_read_pixels);
+	ADD_TEST(render, null_resource_statistics);
+	ADD_TEST(render, null_trace);
+	ADD_TEST(render, software);
+	ADD_TEST(render, software_scheduler);
 	// ADD_TEST(render, null);
 	// ADD_TEST(render, null_clear);
 	// ADD_TEST(render, null_box);
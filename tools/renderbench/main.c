@@ -0,0 +1,692 @@
+/* main.c  -  Render library benchmark  -  Public Domain  -  2014 Mattias Jansson
+ *
+ * This library provides a cross-platform rendering library in C11 providing
+ * basic 2D/3D rendering functionality for projects based on our foundation library.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/render_lib
+ *
+ * The foundation library source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+#include <resource/resource.h>
+#include <window/window.h>
+#include <network/network.h>
+#include <vector/vector.h>
+#include <render/render.h>
+#include <task/task.h>
+
+//! Maximum number of threads used by the contention benchmarks
+#define RENDERBENCH_THREAD_MAX 32
+
+typedef struct {
+	bool display_help;
+	uint iterations;
+	uint backends;
+	string_const_t output_file;
+	string_const_t source_path;
+	string_const_t* local_paths;
+	string_const_t* config_files;
+	uuid_t* shaders;
+} renderbench_input_t;
+
+typedef struct {
+	const char* backend;
+	const char* name;
+	uint threads;
+	uint count;
+	uint samples;
+	double time_min;
+	double time_total;
+} renderbench_result_t;
+
+typedef struct {
+	render_pipeline_t* pipeline;
+	render_buffer_t* buffer;
+	uint thread_index;
+	uint count;
+	uint lock;
+} renderbench_thread_arg_t;
+
+typedef struct {
+	render_api_t api;
+	const char* name;
+} renderbench_backend_t;
+
+static const renderbench_backend_t renderbench_backend[] = {{RENDERAPI_NULL, "null"}, {RENDERAPI_SOFTWARE, "software"}};
+
+static renderbench_result_t* renderbench_results;
+static task_scheduler_t* renderbench_scheduler;
+static uint renderbench_scheduler_threads;
+
+static void
+renderbench_parse_config(const char* path, size_t path_size, const char* buffer, size_t size,
+                         const json_token_t* tokens, size_t numtokens);
+
+static renderbench_input_t
+renderbench_parse_command_line(const string_const_t* cmdline);
+
+static uint
+renderbench_thread_counts(uint* thread_count);
+
+static void
+renderbench_print_usage(void);
+
+int
+main_initialize(void) {
+	int ret = 0;
+	application_t application;
+	foundation_config_t foundation_config;
+	resource_config_t resource_config;
+	window_config_t window_config;
+	network_config_t network_config;
+	vector_config_t vector_config;
+	task_config_t task_config;
+	render_config_t render_config;
+
+	memset(&foundation_config, 0, sizeof(foundation_config));
+	memset(&resource_config, 0, sizeof(resource_config));
+	memset(&window_config, 0, sizeof(window_config));
+	memset(&network_config, 0, sizeof(network_config));
+	memset(&vector_config, 0, sizeof(vector_config));
+	memset(&task_config, 0, sizeof(task_config));
+	memset(&render_config, 0, sizeof(render_config));
+
+	memset(&application, 0, sizeof(application));
+	application.name = string_const(STRING_CONST("renderbench"));
+	application.short_name = string_const(STRING_CONST("renderbench"));
+	application.company = string_const(STRING_CONST(""));
+	application.flags = APPLICATION_UTILITY;
+	application.version = render_module_version();
+
+	log_enable_prefix(false);
+	log_set_suppress(0, ERRORLEVEL_WARNING);
+
+	resource_config.enable_local_autoimport = true;
+	resource_config.enable_local_source = true;
+	resource_config.enable_local_cache = true;
+	resource_config.enable_remote_sourced = true;
+
+	if ((ret = foundation_initialize(memory_system_malloc(), application, foundation_config)) < 0)
+		return ret;
+	if ((ret = network_module_initialize(network_config)) < 0)
+		return ret;
+	if ((ret = resource_module_initialize(resource_config)) < 0)
+		return ret;
+	if ((ret = window_module_initialize(window_config)) < 0)
+		return ret;
+	if ((ret = vector_module_initialize(vector_config)) < 0)
+		return ret;
+	if ((ret = task_module_initialize(task_config)) < 0)
+		return ret;
+
+	// Parallel recording and software rasterization run on a scheduler with one executor per hardware thread
+	uint thread_count[RENDERBENCH_THREAD_MAX];
+	renderbench_scheduler_threads = thread_count[renderbench_thread_counts(thread_count) - 1];
+	renderbench_scheduler = task_scheduler_allocate(renderbench_scheduler_threads, 128);
+	render_config.task_scheduler = renderbench_scheduler;
+	if ((ret = render_module_initialize(render_config)) < 0)
+		return ret;
+
+	log_set_suppress(HASH_RESOURCE, ERRORLEVEL_WARNING);
+	log_set_suppress(HASH_RENDER, ERRORLEVEL_WARNING);
+
+	return 0;
+}
+
+static size_t
+renderbench_result(const char* backend, const char* name, uint threads, uint count) {
+	renderbench_result_t result;
+	memset(&result, 0, sizeof(result));
+	result.backend = backend;
+	result.name = name;
+	result.threads = threads;
+	result.count = count;
+	array_push(renderbench_results, result);
+	return array_size(renderbench_results) - 1;
+}
+
+static void
+renderbench_sample(size_t index, tick_t elapsed) {
+	renderbench_result_t* result = renderbench_results + index;
+	double seconds = time_ticks_to_seconds(elapsed);
+	if (!result->samples || (seconds < result->time_min))
+		result->time_min = seconds;
+	result->time_total += seconds;
+	++result->samples;
+}
+
+static uint
+renderbench_thread_counts(uint* thread_count) {
+	uint thread_max = (uint)system_hardware_threads();
+	if (thread_max > RENDERBENCH_THREAD_MAX)
+		thread_max = RENDERBENCH_THREAD_MAX;
+	if (thread_max < 1)
+		thread_max = 1;
+	uint count = 0;
+	for (uint threads = 1; threads < thread_max; threads *= 2)
+		thread_count[count++] = threads;
+	thread_count[count++] = thread_max;
+	return count;
+}
+
+//! Primitive keys spread over a fixed set of states and buffers, identical across runs
+static void
+renderbench_primitives(render_primitive_t* primitive, uint count) {
+	memset(primitive, 0, sizeof(render_primitive_t) * count);
+	for (uint iprim = 0; iprim < count; ++iprim) {
+		uint32_t hash = iprim * 2654435761U;
+		primitive[iprim].pipeline_state = (hash >> 28) + 1;
+		primitive[iprim].argument_buffer = ((hash >> 20) & 0x0F) + 1;
+		primitive[iprim].argument_offset = iprim;
+		primitive[iprim].descriptor[0] = (hash >> 12) & 0xFF;
+	}
+}
+
+static void*
+renderbench_queue_thread(void* arg) {
+	renderbench_thread_arg_t* queue_arg = arg;
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.descriptor[0] = queue_arg->thread_index;
+	for (uint iprim = 0; iprim < queue_arg->count; ++iprim) {
+		primitive.argument_offset = iprim;
+		render_pipeline_queue(queue_arg->pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+	return 0;
+}
+
+static void*
+renderbench_lock_thread(void* arg) {
+	renderbench_thread_arg_t* lock_arg = arg;
+	for (uint ilock = 0; ilock < lock_arg->count; ++ilock) {
+		render_buffer_lock(lock_arg->buffer, lock_arg->lock);
+		render_buffer_unlock(lock_arg->buffer);
+	}
+	return 0;
+}
+
+static tick_t
+renderbench_threads_run(thread_fn function, renderbench_thread_arg_t* arg, uint thread_count) {
+	thread_t thread[RENDERBENCH_THREAD_MAX];
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_initialize(&thread[ithread], function, &arg[ithread], STRING_CONST("renderbench"),
+		                  THREAD_PRIORITY_NORMAL, 0);
+
+	tick_t start = time_current();
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_start(&thread[ithread]);
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_join(&thread[ithread]);
+	tick_t elapsed = time_diff(start, time_current());
+
+	for (uint ithread = 0; ithread < thread_count; ++ithread)
+		thread_finalize(&thread[ithread]);
+	return elapsed;
+}
+
+static void
+renderbench_queue(render_backend_t* backend, const char* name, uint iterations) {
+	const uint primitive_count = 1024 * 1024;
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, primitive_count);
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	uint thread_count[RENDERBENCH_THREAD_MAX];
+	uint thread_steps = renderbench_thread_counts(thread_count);
+	renderbench_thread_arg_t arg[RENDERBENCH_THREAD_MAX];
+
+	for (uint istep = 0; istep < thread_steps; ++istep) {
+		uint threads = thread_count[istep];
+		uint count = primitive_count / threads;
+		size_t result = renderbench_result(name, "queue", threads, count * threads);
+		for (uint ithread = 0; ithread < threads; ++ithread) {
+			arg[ithread].pipeline = pipeline;
+			arg[ithread].buffer = nullptr;
+			arg[ithread].thread_index = ithread;
+			arg[ithread].count = count;
+			arg[ithread].lock = 0;
+		}
+		// First iteration warms up the primitive buffer and is not sampled
+		for (uint iloop = 0; iloop <= iterations; ++iloop) {
+			tick_t elapsed = renderbench_threads_run(renderbench_queue_thread, arg, threads);
+			if (iloop)
+				renderbench_sample(result, elapsed);
+			render_pipeline_flush(pipeline);
+		}
+	}
+
+	render_pipeline_deallocate(pipeline);
+}
+
+static void
+renderbench_record_item(render_pipeline_t* pipeline, void* context) {
+	renderbench_thread_arg_t* record_arg = context;
+	render_primitive_t primitive;
+	memset(&primitive, 0, sizeof(primitive));
+	primitive.descriptor[0] = record_arg->thread_index;
+	for (uint iprim = 0; iprim < record_arg->count; ++iprim) {
+		primitive.argument_offset = iprim;
+		render_pipeline_queue(pipeline, RENDERPRIMITIVE_TRIANGLELIST, &primitive);
+	}
+}
+
+static void
+renderbench_record(render_backend_t* backend, const char* name, uint iterations) {
+	const uint primitive_count = 1024 * 1024;
+	renderbench_thread_arg_t arg[64];
+	void* context[64];
+	const uint item_count = sizeof(arg) / sizeof(arg[0]);
+	render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, primitive_count);
+	render_pipeline_set_frame_count(pipeline, 1);
+
+	for (uint iitem = 0; iitem < item_count; ++iitem) {
+		arg[iitem].pipeline = pipeline;
+		arg[iitem].buffer = nullptr;
+		arg[iitem].thread_index = iitem;
+		arg[iitem].count = primitive_count / item_count;
+		arg[iitem].lock = 0;
+		context[iitem] = arg + iitem;
+	}
+
+	// Work items are recorded by the tasks of the scheduler, timed until all tasks are complete
+	size_t result = renderbench_result(name, "record_parallel", renderbench_scheduler_threads, primitive_count);
+	for (uint iloop = 0; iloop <= iterations; ++iloop) {
+		tick_t start = time_current();
+		render_pipeline_record_parallel(pipeline, renderbench_record_item, context, item_count);
+		task_yield_and_wait(&pipeline->record_pending);
+		tick_t elapsed = time_diff(start, time_current());
+		if (iloop)
+			renderbench_sample(result, elapsed);
+		render_pipeline_flush(pipeline);
+	}
+
+	render_pipeline_deallocate(pipeline);
+}
+
+static void
+renderbench_flush(render_backend_t* backend, const char* name, uint iterations) {
+	const uint primitive_count[] = {1024, 16 * 1024, 256 * 1024};
+	render_primitive_t* primitive =
+	    memory_allocate(HASH_RENDER, sizeof(render_primitive_t) * primitive_count[2], 0, MEMORY_PERSISTENT);
+	renderbench_primitives(primitive, primitive_count[2]);
+
+	for (uint istep = 0; istep < sizeof(primitive_count) / sizeof(primitive_count[0]); ++istep) {
+		uint count = primitive_count[istep];
+		render_pipeline_t* pipeline = render_pipeline_allocate(backend, RENDER_INDEXFORMAT_UINT16, count);
+		render_pipeline_set_frame_count(pipeline, 1);
+		size_t result = renderbench_result(name, "flush", 1, count);
+		for (uint iloop = 0; iloop <= iterations; ++iloop) {
+			render_pipeline_queue_batch(pipeline, RENDERPRIMITIVE_TRIANGLELIST, primitive, count);
+			tick_t start = time_current();
+			render_pipeline_flush(pipeline);
+			tick_t elapsed = time_diff(start, time_current());
+			if (iloop)
+				renderbench_sample(result, elapsed);
+		}
+		render_pipeline_deallocate(pipeline);
+	}
+
+	memory_deallocate(primitive);
+}
+
+static void
+renderbench_buffer_lock(render_backend_t* backend, const char* name, uint iterations) {
+	const uint lock_count = 64 * 1024;
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_CPUONLY, 4096, nullptr, 0);
+
+	uint thread_count[RENDERBENCH_THREAD_MAX];
+	uint thread_steps = renderbench_thread_counts(thread_count);
+	renderbench_thread_arg_t arg[RENDERBENCH_THREAD_MAX];
+
+	// Shared read locks, then exclusive write locks
+	const uint lock[2] = {RENDERBUFFER_LOCK_READ, RENDERBUFFER_LOCK_WRITE};
+	const char* lock_name[2] = {"buffer_lock_read", "buffer_lock"};
+	for (uint ilock = 0; ilock < 2; ++ilock) {
+		for (uint istep = 0; istep < thread_steps; ++istep) {
+			uint threads = thread_count[istep];
+			size_t result = renderbench_result(name, lock_name[ilock], threads, lock_count * threads);
+			for (uint ithread = 0; ithread < threads; ++ithread) {
+				arg[ithread].pipeline = nullptr;
+				arg[ithread].buffer = buffer;
+				arg[ithread].thread_index = ithread;
+				arg[ithread].count = lock_count;
+				arg[ithread].lock = lock[ilock];
+			}
+			for (uint iloop = 0; iloop < iterations; ++iloop)
+				renderbench_sample(result, renderbench_threads_run(renderbench_lock_thread, arg, threads));
+		}
+	}
+
+	render_buffer_deallocate(buffer);
+}
+
+static void
+renderbench_encode_matrix(render_backend_t* backend, const char* name, uint iterations) {
+	const uint instance_count = 1024;
+	const uint repeat_count = 64;
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 0, nullptr, 0);
+	render_buffer_data_t data[1] = {{.index = 0, .data_type = RENDERDATA_MATRIX4X4, .array_count = 0}};
+	render_buffer_data_declare(buffer, instance_count, data, 1);
+
+	matrix_t matrix = matrix_mul(matrix_scaling(vector(2, 2, 2, 1)), matrix_translation(vector(1, 2, 3, 0)));
+	size_t result = renderbench_result(name, "encode_matrix", 1, instance_count * repeat_count);
+	for (uint iloop = 0; iloop <= iterations; ++iloop) {
+		tick_t start = time_current();
+		render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+		for (uint irepeat = 0; irepeat < repeat_count; ++irepeat) {
+			for (uint iinst = 0; iinst < instance_count; ++iinst)
+				render_buffer_data_encode_matrix(buffer, iinst, 0, &matrix);
+		}
+		render_buffer_unlock(buffer);
+		tick_t elapsed = time_diff(start, time_current());
+		if (iloop)
+			renderbench_sample(result, elapsed);
+	}
+
+	render_buffer_deallocate(buffer);
+}
+
+static void
+renderbench_encode_array(render_backend_t* backend, const char* name, uint iterations) {
+	const uint instance_count = 1024;
+	const uint repeat_count = 64;
+	render_buffer_t* buffer = render_buffer_allocate(backend, RENDERUSAGE_RENDER, 0, nullptr, 0);
+	render_buffer_data_t data[2] = {{.index = 0, .data_type = RENDERDATA_MATRIX4X4, .array_count = 0},
+	                                {.index = 1, .data_type = RENDERDATA_FLOAT4, .array_count = 0}};
+	render_buffer_data_declare(buffer, instance_count, data, 2);
+
+	matrix_t* matrix = memory_allocate(HASH_RENDER, sizeof(matrix_t) * instance_count, 16, MEMORY_PERSISTENT);
+	vector_t* color = memory_allocate(HASH_RENDER, sizeof(vector_t) * instance_count, 16, MEMORY_PERSISTENT);
+	for (uint iinst = 0; iinst < instance_count; ++iinst) {
+		matrix[iinst] = matrix_translation(vector((float32_t)iinst, 2, 3, 0));
+		color[iinst] = vector((float32_t)iinst, 1, 1, 1);
+	}
+
+	// Whole range encoded in a single call, above the threshold for streaming stores
+	size_t result = renderbench_result(name, "encode_matrix_array", 1, instance_count * repeat_count);
+	for (uint iloop = 0; iloop <= iterations; ++iloop) {
+		tick_t start = time_current();
+		render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+		for (uint irepeat = 0; irepeat < repeat_count; ++irepeat)
+			render_buffer_data_encode_matrix_array(buffer, 0, instance_count, 0, matrix);
+		render_buffer_unlock(buffer);
+		tick_t elapsed = time_diff(start, time_current());
+		if (iloop)
+			renderbench_sample(result, elapsed);
+	}
+
+	result = renderbench_result(name, "encode_constant_array", 1, instance_count * repeat_count);
+	for (uint iloop = 0; iloop <= iterations; ++iloop) {
+		tick_t start = time_current();
+		render_buffer_lock(buffer, RENDERBUFFER_LOCK_WRITE);
+		for (uint irepeat = 0; irepeat < repeat_count; ++irepeat)
+			render_buffer_data_encode_constant_array(buffer, 0, instance_count, 1, color, sizeof(vector_t));
+		render_buffer_unlock(buffer);
+		tick_t elapsed = time_diff(start, time_current());
+		if (iloop)
+			renderbench_sample(result, elapsed);
+	}
+
+	memory_deallocate(color);
+	memory_deallocate(matrix);
+	render_buffer_deallocate(buffer);
+}
+
+static void
+renderbench_shader_load(render_backend_t* backend, const char* name, uint iterations, const uuid_t* shaders) {
+	for (size_t ishader = 0, ssize = array_size(shaders); ishader < ssize; ++ishader) {
+		// Cold load reads (and possibly compiles) the resource for the first time in this backend
+		tick_t start = time_current();
+		render_shader_t* shader = render_shader_load(backend, shaders[ishader]);
+		tick_t elapsed = time_diff(start, time_current());
+		if (!shader) {
+			string_const_t uuidstr = string_from_uuid_static(shaders[ishader]);
+			log_warnf(HASH_RESOURCE, WARNING_INVALID_VALUE, STRING_CONST("Failed to load shader on %s backend: %.*s"),
+			          name, STRING_FORMAT(uuidstr));
+			continue;
+		}
+		renderbench_sample(renderbench_result(name, "shader_load_cold", 1, 1), elapsed);
+
+		// Warm load hits the shader table of the backend while the shader is resident
+		size_t result = renderbench_result(name, "shader_load_warm", 1, 1);
+		for (uint iloop = 0; iloop < iterations; ++iloop) {
+			start = time_current();
+			render_shader_t* resident = render_shader_load(backend, shaders[ishader]);
+			renderbench_sample(result, time_diff(start, time_current()));
+			render_shader_unload(resident);
+		}
+
+		// Reload after unload reads the compiled resource again through the resource cache
+		render_shader_unload(shader);
+		result = renderbench_result(name, "shader_load_cached", 1, 1);
+		for (uint iloop = 0; iloop < iterations; ++iloop) {
+			start = time_current();
+			shader = render_shader_load(backend, shaders[ishader]);
+			renderbench_sample(result, time_diff(start, time_current()));
+			render_shader_unload(shader);
+		}
+	}
+}
+
+static void
+renderbench_backend_allocate(render_api_t api, const char* name, uint iterations) {
+	size_t allocate = renderbench_result(name, "backend_allocate", 1, 1);
+	size_t deallocate = renderbench_result(name, "backend_deallocate", 1, 1);
+	for (uint iloop = 0; iloop < iterations; ++iloop) {
+		tick_t start = time_current();
+		render_backend_t* backend = render_backend_allocate(api, false);
+		renderbench_sample(allocate, time_diff(start, time_current()));
+		start = time_current();
+		render_backend_deallocate(backend);
+		renderbench_sample(deallocate, time_diff(start, time_current()));
+	}
+}
+
+static void
+renderbench_write(stream_t* stream, uint iterations) {
+	string_const_t version = string_from_version_static(render_module_version());
+	const char* config = BUILD_DEBUG ? "debug" : (BUILD_RELEASE ? "release" : (BUILD_PROFILE ? "profile" : "deploy"));
+
+	stream_write_format(stream, STRING_CONST("{\"version\":\"%.*s\",\"config\":\"%s\",\"hardware_threads\":%u,"),
+	                    STRING_FORMAT(version), config, (uint)system_hardware_threads());
+	stream_write_format(stream, STRING_CONST("\"iterations\":%u,\"results\":["), iterations);
+	uint written = 0;
+	for (size_t iresult = 0, rsize = array_size(renderbench_results); iresult < rsize; ++iresult) {
+		const renderbench_result_t* result = renderbench_results + iresult;
+		if (!result->samples)
+			continue;
+		double mean = result->time_total / (double)result->samples;
+		double rate = (result->time_min > 0) ? ((double)result->count / result->time_min) : 0;
+		stream_write_format(stream,
+		                    STRING_CONST("%s\n{\"backend\":\"%s\",\"benchmark\":\"%s\",\"threads\":%u,\"count\":%u,"
+		                                 "\"samples\":%u,\"min_ms\":%.6f,\"mean_ms\":%.6f,\"rate\":%.1f}"),
+		                    written++ ? "," : "", result->backend, result->name, result->threads, result->count,
+		                    result->samples, result->time_min * 1000.0, mean * 1000.0, rate);
+	}
+	stream_write_string(stream, STRING_CONST("\n]}\n"));
+}
+
+int
+main_run(void* main_arg) {
+	int result = 0;
+	renderbench_input_t input = renderbench_parse_command_line(environment_command_line());
+
+	FOUNDATION_UNUSED(main_arg);
+
+	if (input.display_help) {
+		renderbench_print_usage();
+		goto exit;
+	}
+
+	for (size_t cfgfile = 0, fsize = array_size(input.config_files); cfgfile < fsize; ++cfgfile)
+		sjson_parse_path(STRING_ARGS(input.config_files[cfgfile]), renderbench_parse_config);
+
+	if (input.source_path.length)
+		resource_source_set_path(STRING_ARGS(input.source_path));
+	for (size_t localpath = 0, psize = array_size(input.local_paths); localpath < psize; ++localpath)
+		resource_local_add_path(STRING_ARGS(input.local_paths[localpath]));
+
+	resource_import_register(render_import);
+	resource_compile_register(render_compile);
+
+	for (size_t ibackend = 0; ibackend < sizeof(renderbench_backend) / sizeof(renderbench_backend[0]); ++ibackend) {
+		if (!(input.backends & (1U << ibackend)))
+			continue;
+		const char* name = renderbench_backend[ibackend].name;
+		render_backend_t* backend = render_backend_allocate(renderbench_backend[ibackend].api, false);
+		if (!backend) {
+			log_warnf(HASH_RENDER, WARNING_UNSUPPORTED, STRING_CONST("Unable to allocate %s backend"), name);
+			continue;
+		}
+
+		renderbench_queue(backend, name, input.iterations);
+		renderbench_record(backend, name, input.iterations);
+		renderbench_flush(backend, name, input.iterations);
+		renderbench_buffer_lock(backend, name, input.iterations);
+		renderbench_encode_matrix(backend, name, input.iterations);
+		renderbench_encode_array(backend, name, input.iterations);
+		renderbench_shader_load(backend, name, input.iterations, input.shaders);
+
+		render_backend_deallocate(backend);
+
+		renderbench_backend_allocate(renderbench_backend[ibackend].api, name, input.iterations);
+	}
+
+	stream_t* stream = input.output_file.length ?
+	                       stream_open(STRING_ARGS(input.output_file), STREAM_OUT | STREAM_CREATE | STREAM_TRUNCATE) :
+	                       stream_open_stdout();
+	if (stream) {
+		renderbench_write(stream, input.iterations);
+		stream_deallocate(stream);
+	} else {
+		log_errorf(HASH_RENDER, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Unable to open output file: %.*s"),
+		           STRING_FORMAT(input.output_file));
+		result = -1;
+	}
+
+exit:
+
+	array_deallocate(renderbench_results);
+	array_deallocate(input.local_paths);
+	array_deallocate(input.config_files);
+	array_deallocate(input.shaders);
+
+	return result;
+}
+
+void
+main_finalize(void) {
+	render_module_finalize();
+	task_scheduler_deallocate(renderbench_scheduler);
+	task_module_finalize();
+	vector_module_finalize();
+	window_module_finalize();
+	resource_module_finalize();
+	network_module_finalize();
+	foundation_finalize();
+}
+
+static void
+renderbench_parse_config(const char* path, size_t path_size, const char* buffer, size_t size,
+                         const json_token_t* tokens, size_t numtokens) {
+	resource_module_parse_config(path, path_size, buffer, size, tokens, numtokens);
+	render_module_parse_config(path, path_size, buffer, size, tokens, numtokens);
+}
+
+static renderbench_input_t
+renderbench_parse_command_line(const string_const_t* cmdline) {
+	renderbench_input_t input;
+	size_t arg, asize;
+
+	memset(&input, 0, sizeof(input));
+	input.iterations = 10;
+
+	for (arg = 1, asize = array_size(cmdline); arg < asize; ++arg) {
+		if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--help")))
+			input.display_help = true;
+		else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--source"))) {
+			if (arg < asize - 1)
+				input.source_path = cmdline[++arg];
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--local"))) {
+			if (arg < asize - 1)
+				array_push(input.local_paths, cmdline[++arg]);
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--config"))) {
+			if (arg < asize - 1)
+				array_push(input.config_files, cmdline[++arg]);
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--output"))) {
+			if (arg < asize - 1)
+				input.output_file = cmdline[++arg];
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--iterations"))) {
+			if (arg < asize - 1) {
+				++arg;
+				input.iterations = string_to_uint(STRING_ARGS(cmdline[arg]), false);
+			}
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--backend"))) {
+			if (arg < asize - 1) {
+				++arg;
+				for (uint ibackend = 0; ibackend < sizeof(renderbench_backend) / sizeof(renderbench_backend[0]);
+				     ++ibackend) {
+					if (string_equal(STRING_ARGS(cmdline[arg]), renderbench_backend[ibackend].name,
+					                 string_length(renderbench_backend[ibackend].name)))
+						input.backends |= (1U << ibackend);
+				}
+			}
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--shader"))) {
+			if (arg < asize - 1) {
+				++arg;
+				uuid_t uuid = string_to_uuid(STRING_ARGS(cmdline[arg]));
+				if (uuid_is_null(uuid))
+					log_warnf(HASH_RESOURCE, WARNING_INVALID_VALUE, STRING_CONST("Invalid UUID: %.*s"),
+					          STRING_FORMAT(cmdline[arg]));
+				else
+					array_push(input.shaders, uuid);
+			}
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--debug"))) {
+			log_set_suppress(0, ERRORLEVEL_NONE);
+			log_set_suppress(HASH_RESOURCE, ERRORLEVEL_NONE);
+			log_set_suppress(HASH_RENDER, ERRORLEVEL_NONE);
+		} else if (string_equal(STRING_ARGS(cmdline[arg]), STRING_CONST("--")))
+			break;  // Stop parsing cmdline options
+		else {
+			log_warnf(HASH_RENDER, WARNING_INVALID_VALUE, STRING_CONST("Unknown argument: %.*s"),
+			          STRING_FORMAT(cmdline[arg]));
+			input.display_help = true;
+		}
+	}
+
+	if (!input.iterations)
+		input.iterations = 1;
+	if (!input.backends)
+		input.backends = (1U << (sizeof(renderbench_backend) / sizeof(renderbench_backend[0]))) - 1;
+
+	return input;
+}
+
+static void
+renderbench_print_usage(void) {
+	const error_level_t saved_level = log_suppress(0);
+	log_set_suppress(0, ERRORLEVEL_DEBUG);
+	log_info(0, STRING_CONST("renderbench usage:\n"
+	                         "  renderbench [--source <path>] [--local <path> ...] [--config <path> ...]\n"
+	                         "              [--output <file>] [--iterations <count>] [--backend <name> ...]\n"
+	                         "              [--shader <uuid> ...] [--debug] [--help] [--]\n"
+	                         "    Optional arguments:\n"
+	                         "      --source <path>              Operate on resource file source structure given by <path>\n"
+	                         "      --local <path>               Add a local resource path given by <path>\n"
+	                         "      --config <file>              Read and parse config file given by <path>\n"
+	                         "      --output <file>              Write JSON results to <file> (default stdout)\n"
+	                         "      --iterations <count>         Number of samples per benchmark (default 10)\n"
+	                         "      --backend <name>             Run on backend null or software (default all)\n"
+	                         "      --shader <uuid>              Measure load latency of shader given by <uuid>\n"
+	                         "      --debug                      Enable debug output\n"
+	                         "      --help                       Display this help message\n"
+	                         "      --                           Stop processing command line arguments"));
+	log_set_suppress(0, saved_level);
+}